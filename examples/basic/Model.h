@@ -4,8 +4,9 @@
 #include "model/ModelVar.h"
 #include "model/types/ModelTypePrimitive.h"
 
-// Minimal test model to validate that multiple models can coexist
-// without overwriting each other's Preferences and without sharing the same WS endpoint.
+// Minimal test model to validate that multiple models can coexist without overwriting each
+// other's Preferences. The WiFiProvisioner serves it on its shared "/ws" endpoint under the
+// "user" namespace (WsHub), so it does not get a path of its own.
 class Model : public ModelBase {
 public:
   struct TestTopic {
@@ -21,12 +22,12 @@ public:
       return s;
     }
 
-    void setSaveCallback(std::function<void()> cb) {
+    void setSaveCallback(fj::Callback cb) {
       value.setOnChange(cb);
     }
   } test;
 
-  Model() : ModelBase(80, "/main", "model") {
+  Model() : ModelBase(80, "/ws", "model") {
     test.value = 1;
     registerTopic("test", test);
   }
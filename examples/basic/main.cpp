@@ -18,6 +18,9 @@ void setup()
 
   Logger::setLevel(LogLevel::INFO);
   Serial.printf("[DEBUG] Log level set to %s\n", Logger::levelToString(Logger::getLevel()));
+  // Queue log lines and write them from a background task, so logging in WebSocket
+  // callbacks does not wait for the UART.
+  Logger::beginAsync();
 
   wifi.setApSsid("ESP-Setup");
   wifi.setMdnsHost("meinesp");
@@ -27,6 +30,9 @@ void setup()
     Serial.println("[STATUS] " + status);
   });
 
+  // UI sliders can fire many updates per second: write them to NVS at most every 2 s
+  // (handleLoop() drives the write-back and flushes before restarts).
+  userModel.setPrefsWriteBackMs(2000);
   wifi.setUserModel(userModel);
   wifi.generateDefaultPage(userModel, "/", "Sensors", false, false, false);
 
@@ -7,6 +7,8 @@
 #include "model/types/ModelTypePrimitive.h"
 #include "model/types/ModelTypeList.h"
 #include "model/types/ModelTypePointRingBuffer.h"
+#include "model/types/ModelTypeWsClients.h"
+#include "model/types/ModelTypeMetrics.h"
 #include "model/ModelVar.h"
 
 #include "build_info.h"
@@ -41,7 +43,7 @@ struct BuildInfo
     return s;
   }
 
-  void setSaveCallback(std::function<void()> /*cb*/) { }
+  void setSaveCallback(fj::Callback /*cb*/) { }
 };
 
 struct WifiSettings
@@ -84,7 +86,7 @@ struct WifiSettings
     return s;
   }
 
-  void setSaveCallback(std::function<void()> cb) {
+  void setSaveCallback(fj::Callback cb) {
     ssid.setOnChange(cb);
     ap_ssid.setOnChange(cb);
     pass.setOnChange(cb);
@@ -108,7 +110,7 @@ struct MDNSSettings
       fj::FieldStr<MDNSSettings, MDNS_LEN>{"mdns_domain", &MDNSSettings::mdns_domain});
     return s;
   }
-  void setSaveCallback(std::function<void()> /*cb*/) { }
+  void setSaveCallback(fj::Callback /*cb*/) { }
 };
 
 struct OTASettings
@@ -119,7 +121,8 @@ struct OTASettings
   // OTA update window in seconds; 0 means unlimited.
   fj::VarWsPrefsRw<int> window_seconds = 600;
   // Remaining seconds in the current OTA window; -1 means unlimited, 0 means expired/not started.
-  fj::VarWsRo<int> remaining_seconds = 0;
+  // Refreshed every second; only real changes reach the patch.
+  fj::OnChange<fj::VarWsRo<int>> remaining_seconds = 0;
 
   Button generate_new_ota_pass;
   Button extend_ota_window;
@@ -142,7 +145,7 @@ struct OTASettings
         fj::Field<OTASettings, decltype(extend_ota_window)>{"extend_window_button", &OTASettings::extend_ota_window});
     return s;
   }
-  void setSaveCallback(std::function<void()> cb) {
+  void setSaveCallback(fj::Callback cb) {
     ota_pass.setOnChange(cb);
     window_seconds.setOnChange(cb);
   }
@@ -164,9 +167,9 @@ public:
     // POSIX TZ string used by TimeSync (persisted)
     fj::VarWsPrefsRw<StringBuffer<TZ_LEN>> tz;
 
-    // Display-only status (not persisted)
-    fj::VarWsRo<StringBuffer<NOW_LEN>> now;
-    fj::VarWsRo<bool> synced;
+    // Display-only status (not persisted), set every second; unchanged values are not broadcast
+    fj::OnChange<fj::VarWsRo<StringBuffer<NOW_LEN>>> now;
+    fj::OnChange<fj::VarWsRo<bool>> synced;
 
     Button sync_now;
 
@@ -186,42 +189,48 @@ public:
       return s;
     }
 
-    void setSaveCallback(std::function<void()> cb) {
+    void setSaveCallback(fj::Callback cb) {
       tz.setOnChange(cb);
     }
   };
 
   TimeSettings time;
 
+  // Per-client WebSocket counters (read-only, refreshed by WiFiProvisioner)
+  WsClientStatsTopic ws_clients;
+
+  // Hot-path counters and latency histograms (read-only, refreshed by WiFiProvisioner)
+  MetricsTopic metrics;
+
   // Callback for when WiFi settings are updated
-  std::function<void()> onWifiUpdate = nullptr;
+  fj::Callback onWifiUpdate = nullptr;
 
   // Callback for when UI requests a WiFi scan (triggered via WS action button_trigger)
-  std::function<void()> onWifiScanRequest = nullptr;
+  fj::Callback onWifiScanRequest = nullptr;
 
   // Callback for when OTA settings are changed (password/window)
-  std::function<void()> onOtaUpdate = nullptr;
+  fj::Callback onOtaUpdate = nullptr;
 
   // Callback for when UI requests OTA window extend
-  std::function<void()> onOtaExtendRequest = nullptr;
+  fj::Callback onOtaExtendRequest = nullptr;
 
   // Callback for when UI requests WiFi reset (clear credentials + restart)
-  std::function<void()> onResetRequest = nullptr;
+  fj::Callback onResetRequest = nullptr;
 
   // Callback for when UI requests a factory reset (erase all Preferences/NVS + restart)
-  std::function<void()> onFactoryResetRequest = nullptr;
+  fj::Callback onFactoryResetRequest = nullptr;
 
   // Callback for when mDNS settings are changed (hostname)
-  std::function<void()> onMdnsUpdate = nullptr;
+  fj::Callback onMdnsUpdate = nullptr;
 
   // Callback for when admin settings are changed
-  std::function<void()> onAdminUpdate = nullptr;
+  fj::Callback onAdminUpdate = nullptr;
 
   // Callback for when time settings are changed
-  std::function<void()> onTimeUpdate = nullptr;
+  fj::Callback onTimeUpdate = nullptr;
 
   // Callback for when UI requests a time resync (button)
-  std::function<void()> onTimeSyncNow = nullptr;
+  fj::Callback onTimeSyncNow = nullptr;
 
   struct AdminSettings {
     static const int PASS_LEN = 32;
@@ -256,7 +265,7 @@ public:
       );
       return s;
     }
-    void setSaveCallback(std::function<void()> cb) {
+    void setSaveCallback(fj::Callback cb) {
       pass.setOnChange(cb);
       session.setOnChange(cb);
       heap_send_time_ms.setOnChange(cb);
@@ -329,6 +338,10 @@ public:
     registerTopic("admin", admin);
     registerTopic("time", time);
     registerTopic("build", build);
+    ws_clients.model = this;
+    registerTopic("ws_clients", ws_clients, false, true);
+    metrics.model = this;
+    registerTopic("metrics", metrics, false, true);
 
     // Register button callbacks
     ota.generate_new_ota_pass.setCallback([this]() { this->onGenerateNewOtaPassword(); });
@@ -362,33 +375,44 @@ protected:
   {
     LOG_TRACE_F("[Model] Model update notified for topic: %s", topic);
     
-    if (strcmp(topic, "wifi") == 0) {
-      LOG_INFO_F("[WiFi] SSID updated to: %s", wifi.ssid.get().c_str());
-      LOG_DEBUG("[WiFi] Password field received (value not logged for security)");
-      // For troubleshooting only: the password value is logged at TRACE.
-      const char* pass = wifi.pass.get().c_str();
-      LOG_TRACE_F("[WiFi] Password value (TRACE only): '%s' (len=%d)", pass, strlen(pass));
-      LOG_TRACE("[WiFi] Triggering reconnect with new credentials");
-      if (onWifiUpdate) {
-        LOG_TRACE("[WiFi] Calling WiFi update callback");
-        onWifiUpdate();
+    // The hash only pre-filters; each case confirms the exact name before acting.
+    switch (nameHash(topic)) {
+      case nameHash("wifi"): {
+        if (strcmp(topic, "wifi") != 0) break;
+        LOG_INFO_F("[WiFi] SSID updated to: %s", wifi.ssid.get().c_str());
+        LOG_DEBUG("[WiFi] Password field received (value not logged for security)");
+        // For troubleshooting only: the password value is logged at TRACE.
+        const char* pass = wifi.pass.get().c_str();
+        LOG_TRACE_F("[WiFi] Password value (TRACE only): '%s' (len=%d)", pass, strlen(pass));
+        LOG_TRACE("[WiFi] Triggering reconnect with new credentials");
+        if (onWifiUpdate) {
+          LOG_TRACE("[WiFi] Calling WiFi update callback");
+          onWifiUpdate();
+        }
+        break;
       }
-    }
-    else if (strcmp(topic, "ota") == 0) {
-      LOG_DEBUG("[OTA] OTA settings updated");
-      if (onOtaUpdate) onOtaUpdate();
-    }
-    else if (strcmp(topic, "admin") == 0) {
-      LOG_DEBUG("[Admin] Admin settings updated");
-      if (onAdminUpdate) onAdminUpdate();
-    }
-    else if (strcmp(topic, "mdns") == 0) {
-      LOG_DEBUG("[mDNS] mDNS settings updated");
-      if (onMdnsUpdate) onMdnsUpdate();
-    }
-    else if (strcmp(topic, "time") == 0) {
-      LOG_DEBUG("[Time] Time settings updated");
-      if (onTimeUpdate) onTimeUpdate();
+      case nameHash("ota"):
+        if (strcmp(topic, "ota") != 0) break;
+        LOG_DEBUG("[OTA] OTA settings updated");
+        if (onOtaUpdate) onOtaUpdate();
+        break;
+      case nameHash("admin"):
+        if (strcmp(topic, "admin") != 0) break;
+        LOG_DEBUG("[Admin] Admin settings updated");
+        if (onAdminUpdate) onAdminUpdate();
+        break;
+      case nameHash("mdns"):
+        if (strcmp(topic, "mdns") != 0) break;
+        LOG_DEBUG("[mDNS] mDNS settings updated");
+        if (onMdnsUpdate) onMdnsUpdate();
+        break;
+      case nameHash("time"):
+        if (strcmp(topic, "time") != 0) break;
+        LOG_DEBUG("[Time] Time settings updated");
+        if (onTimeUpdate) onTimeUpdate();
+        break;
+      default:
+        break;
     }
   }
 
@@ -415,68 +439,84 @@ protected:
   }
 
   // Handle button trigger requests (override from ModelBase)
+  // "topic/button" hashed in one pass; a clash between two known buttons is a duplicate case label.
+  static constexpr uint32_t buttonKey(const char* topic, const char* button) {
+    return nameHash(button, nameHash("/", nameHash(topic)));
+  }
+
+  // The hash is only a pre-filter: FNV-1a is not collision resistant, so every case
+  // confirms the exact names before running its (possibly destructive) handler.
+  static bool isButton(const char* topic, const char* button, const char* t, const char* b) {
+    return strcmp(topic, t) == 0 && strcmp(button, b) == 0;
+  }
+
   void handleButtonTrigger(AsyncWebSocketClient* client, const char* topic, const char* button) override {
     LOG_DEBUG_F("[Model] handleButtonTrigger: topic=%s, button=%s", topic, button);
 
-    if (strcmp(topic, "wifi") == 0) {
-      if (strcmp(button, "scan_networks") == 0 || strcmp(button, "wifi_scan") == 0) {
+    bool handled = false;
+    switch (buttonKey(topic, button)) {
+      case buttonKey("wifi", "scan_networks"):
+      case buttonKey("wifi", "wifi_scan"):
+        if (!isButton(topic, button, "wifi", "scan_networks") &&
+            !isButton(topic, button, "wifi", "wifi_scan")) break;
         LOG_DEBUG("[WiFi] Button trigger: scan networks");
         if (onWifiScanRequest) onWifiScanRequest();
-        if (client) client->text(R"({\"ok\":true,\"action\":\"scan_requested\"})");
+        if (client) client->text(R"({"ok":true,"action":"scan_requested"})");
         return;
-      }
-    }
-    
-    if (strcmp(topic, "ota") == 0) {
-      if (strcmp(button, "generate_new_pass_button") == 0) {
+
+      case buttonKey("ota", "generate_new_pass_button"):
+        if (!isButton(topic, button, "ota", "generate_new_pass_button")) break;
         LOG_DEBUG("[OTA] Button trigger: generate_new_pass_button");
         onGenerateNewOtaPassword();
-        if (client) client->text(R"({"ok":true,"action":"button_triggered"})");
-        return;
-      }
+        handled = true;
+        break;
 
-      if (strcmp(button, "extend_window_button") == 0) {
+      case buttonKey("ota", "extend_window_button"):
+        if (!isButton(topic, button, "ota", "extend_window_button")) break;
         LOG_DEBUG("[OTA] Button trigger: extend_window_button");
         if (onOtaExtendRequest) onOtaExtendRequest();
-        if (client) client->text(R"({"ok":true,"action":"button_triggered"})");
-        return;
-      }
-    }
+        handled = true;
+        break;
 
-    if (strcmp(topic, "admin") == 0) {
-      if (strcmp(button, "generate_new_admin_ui_pass") == 0) {
+      case buttonKey("admin", "generate_new_admin_ui_pass"):
+        if (!isButton(topic, button, "admin", "generate_new_admin_ui_pass")) break;
         LOG_DEBUG("[Admin] Button trigger: generate_new_admin_ui_pass");
         onGenerateNewAdminUiPassword();
-        if (client) client->text(R"({"ok":true,"action":"button_triggered"})");
-        return;
-      }
+        handled = true;
+        break;
 
-      if (strcmp(button, "reset_wifi_button") == 0) {
+      case buttonKey("admin", "reset_wifi_button"):
+        if (!isButton(topic, button, "admin", "reset_wifi_button")) break;
         LOG_WARN("[Admin] Button trigger: reset_wifi_button");
         if (onResetRequest) onResetRequest();
-        if (client) client->text(R"({"ok":true,"action":"button_triggered"})");
-        return;
-      }
+        handled = true;
+        break;
 
-      if (strcmp(button, "factory_reset_button") == 0) {
+      case buttonKey("admin", "factory_reset_button"):
+        if (!isButton(topic, button, "admin", "factory_reset_button")) break;
         LOG_WARN("[Admin] Button trigger: factory_reset_button");
         if (onFactoryResetRequest) onFactoryResetRequest();
-        if (client) client->text(R"({"ok":true,"action":"button_triggered"})");
-        return;
-      }
-    }
+        handled = true;
+        break;
 
-    if (strcmp(topic, "time") == 0) {
-      if (strcmp(button, "sync_now") == 0) {
+      case buttonKey("time", "sync_now"):
+        if (!isButton(topic, button, "time", "sync_now")) break;
         LOG_DEBUG("[Time] Button trigger: sync_now");
         if (onTimeSyncNow) onTimeSyncNow();
-        if (client) client->text(R"({"ok":true,"action":"button_triggered"})");
-        return;
-      }
+        handled = true;
+        break;
+
+      default:
+        break;
     }
-    
-    LOG_WARN_F("[Model] Unknown button: topic=%s, button=%s", topic, button);
-    if (client) client->text(R"({"ok":false,"error":"unknown_button"})");
+
+    if (!handled) {
+      LOG_WARN_F("[Model] Unknown button: topic=%s, button=%s", topic, button);
+      if (client) client->text(R"({"ok":false,"error":"unknown_button"})");
+      return;
+    }
+
+    if (client) client->text(R"({"ok":true,"action":"button_triggered"})");
   }
 
 private:
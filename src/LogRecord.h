@@ -0,0 +1,289 @@
+#pragma once
+#include <Arduino.h>
+#include <cstring>
+#include <stdio.h>
+#include <type_traits>
+
+// ============================================================================
+// LogRecord: binary log records for deferred formatting
+// ============================================================================
+// encode() stores what a printf call needs - the format string pointer, a millis() timestamp and
+// the raw arguments, each behind a one-byte type code - and format() turns the record into text
+// later, when it is drained or viewed. The format string must outlive the record (the LOG_*_F
+// macros pass literals, which live in flash). String arguments are copied, so c_str() of a
+// temporary or a stack buffer is fine.
+//
+// Record: [const char* fmt][uint32 ms] then per argument [type][value], unaligned:
+//   I32 / U32 4 bytes, I64 / U64 / F64 8 bytes, PTR sizeof(void*), STR uint8 length + bytes
+// A string that does not fit is truncated; arguments that do not fit at all are dropped and their
+// conversions print as "?", as do conversions whose argument has the wrong kind.
+
+#ifndef LOG_DEFER_MAX_ARGS
+#define LOG_DEFER_MAX_ARGS 8
+#endif
+
+namespace LogRecord {
+
+enum ArgType : uint8_t { ARG_I32 = 1, ARG_U32, ARG_I64, ARG_U64, ARG_F64, ARG_STR, ARG_PTR };
+
+static const size_t HEADER = sizeof(const char*) + 4;
+
+struct Writer {
+  uint8_t* p;
+  uint8_t* end;
+
+  void put(uint8_t type, const void* value, size_t n) {
+    if ((size_t)(end - p) < 1 + n) {
+      p = end;  // full: later arguments are dropped too
+      return;
+    }
+    *p++ = type;
+    memcpy(p, value, n);
+    p += n;
+  }
+};
+
+inline void put(Writer& w, const char* s) {
+  if (!s) s = "(null)";
+  const size_t room = (size_t)(w.end - w.p);
+  if (room < 2) {
+    w.p = w.end;
+    return;
+  }
+  const size_t max = room - 2 < 255 ? room - 2 : 255;
+  size_t n = 0;
+  while (n < max && s[n]) n++;
+  *w.p++ = ARG_STR;
+  *w.p++ = (uint8_t)n;
+  memcpy(w.p, s, n);
+  w.p += n;
+}
+
+inline void put(Writer& w, char* s) { put(w, (const char*)s); }
+inline void put(Writer& w, std::nullptr_t) { put(w, (const char*)nullptr); }
+
+template <typename T>
+inline void put(Writer& w, const T* p) {
+  const uintptr_t v = (uintptr_t)p;
+  w.put(ARG_PTR, &v, sizeof(v));
+}
+
+template <typename T, bool IS_ENUM = std::is_enum<T>::value>
+struct IntegerOf {
+  typedef T type;
+};
+
+template <typename T>
+struct IntegerOf<T, true> {
+  typedef typename std::underlying_type<T>::type type;
+};
+
+// Integers keep their signedness and are widened to 32 or 64 bit, as printf promotion would.
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type put(Writer& w, T v) {
+  typedef typename IntegerOf<T>::type I;
+  if (sizeof(I) > 4) {
+    if (std::is_signed<I>::value) {
+      const int64_t x = (int64_t)v;
+      w.put(ARG_I64, &x, 8);
+    } else {
+      const uint64_t x = (uint64_t)v;
+      w.put(ARG_U64, &x, 8);
+    }
+  } else if (std::is_signed<I>::value) {
+    const int32_t x = (int32_t)v;
+    w.put(ARG_I32, &x, 4);
+  } else {
+    const uint32_t x = (uint32_t)v;
+    w.put(ARG_U32, &x, 4);
+  }
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type put(Writer& w, T v) {
+  const double x = (double)v;
+  w.put(ARG_F64, &x, 8);
+}
+
+inline void putAll(Writer&) {}
+
+template <typename A, typename... Rest>
+inline void putAll(Writer& w, A a, Rest... rest) {
+  put(w, a);
+  putAll(w, rest...);
+}
+
+// Writes the record into buf; returns its size (0 if cap cannot hold the header).
+template <typename... Args>
+inline size_t encode(uint8_t* buf, size_t cap, const char* fmt, uint32_t ms, Args... args) {
+  static_assert(sizeof...(Args) <= LOG_DEFER_MAX_ARGS, "LogRecord: more arguments than LOG_DEFER_MAX_ARGS");
+  if (cap < HEADER) return 0;
+  memcpy(buf, &fmt, sizeof(fmt));
+  memcpy(buf + sizeof(fmt), &ms, 4);
+  Writer w = {buf + HEADER, buf + cap};
+  putAll(w, args...);
+  return (size_t)(w.p - buf);
+}
+
+inline const char* formatString(const uint8_t* rec) {
+  const char* fmt;
+  memcpy(&fmt, rec, sizeof(fmt));
+  return fmt;
+}
+
+inline uint32_t timestamp(const uint8_t* rec) {
+  uint32_t ms;
+  memcpy(&ms, rec + sizeof(const char*), 4);
+  return ms;
+}
+
+struct Arg {
+  uint8_t type;
+  union {
+    int32_t i32;
+    uint32_t u32;
+    int64_t i64;
+    uint64_t u64;
+    double f64;
+    uintptr_t ptr;
+  };
+  const char* str;
+  size_t strLen;
+};
+
+struct Reader {
+  const uint8_t* p;
+  const uint8_t* end;
+
+  bool next(Arg& a) {
+    if (p >= end) return false;
+    a.type = *p++;
+    size_t n;
+    switch (a.type) {
+      case ARG_I32:
+      case ARG_U32: n = 4; break;
+      case ARG_I64:
+      case ARG_U64:
+      case ARG_F64: n = 8; break;
+      case ARG_PTR: n = sizeof(uintptr_t); break;
+      case ARG_STR:
+        if (p >= end) return false;
+        a.strLen = *p++;
+        if ((size_t)(end - p) < a.strLen) return false;
+        a.str = (const char*)p;
+        p += a.strLen;
+        return true;
+      default: p = end; return false;
+    }
+    if ((size_t)(end - p) < n) {
+      p = end;
+      return false;
+    }
+    memcpy(&a.u64, p, n);
+    p += n;
+    return true;
+  }
+
+  // '*' width or precision
+  int nextInt() {
+    Arg a;
+    a.u64 = 0;
+    if (!next(a) || (a.type != ARG_I32 && a.type != ARG_U32)) return 0;
+    return a.i32;
+  }
+};
+
+template <typename V>
+inline int formatArg(char* out, size_t cap, const char* spec, int stars, const int* star, V v) {
+  switch (stars) {
+    case 0: return snprintf(out, cap, spec, v);
+    case 1: return snprintf(out, cap, spec, star[0], v);
+    default: return snprintf(out, cap, spec, star[0], star[1], v);
+  }
+}
+
+// One conversion: spec holds "%", flags, width and precision; the length modifier follows from
+// the stored type, not from the format string. Returns the formatted length (snprintf semantics),
+// or -1 if the argument does not fit the conversion.
+inline int formatConversion(char* out, size_t cap, char* spec, size_t s, char conv, int stars, const int* star,
+                            const Arg& a) {
+  const bool isInt = strchr("diouxXc", conv) != nullptr;
+  const bool isFloat = strchr("fFeEgGaA", conv) != nullptr;
+  if (a.type == ARG_I64 || a.type == ARG_U64) {
+    spec[s++] = 'l';
+    spec[s++] = 'l';
+  }
+  spec[s++] = conv;
+  spec[s] = '\0';
+  switch (a.type) {
+    case ARG_I32: return isInt ? formatArg(out, cap, spec, stars, star, (int)a.i32) : -1;
+    case ARG_U32: return isInt ? formatArg(out, cap, spec, stars, star, (unsigned)a.u32) : -1;
+    case ARG_I64: return isInt ? formatArg(out, cap, spec, stars, star, (long long)a.i64) : -1;
+    case ARG_U64: return isInt ? formatArg(out, cap, spec, stars, star, (unsigned long long)a.u64) : -1;
+    case ARG_F64: return isFloat ? formatArg(out, cap, spec, stars, star, a.f64) : -1;
+    case ARG_PTR: return conv == 'p' ? formatArg(out, cap, spec, stars, star, (void*)a.ptr) : -1;
+    case ARG_STR: {
+      if (conv != 's') return -1;
+      char text[256];
+      memcpy(text, a.str, a.strLen);
+      text[a.strLen] = '\0';
+      return formatArg(out, cap, spec, stars, star, (const char*)text);
+    }
+    default: return -1;
+  }
+}
+
+// Formats the record into out (NUL terminated, truncated to cap - 1). Returns the length.
+inline size_t format(char* out, size_t cap, const uint8_t* rec, size_t len) {
+  if (cap == 0) return 0;
+  const char* f = len >= HEADER ? formatString(rec) : nullptr;
+  Reader r = {rec + HEADER, rec + len};
+  size_t o = 0;
+  while (f && *f && o + 1 < cap) {
+    if (*f != '%') {
+      out[o++] = *f++;
+      continue;
+    }
+    f++;
+    if (*f == '%') {
+      out[o++] = *f++;
+      continue;
+    }
+
+    char spec[24];
+    size_t s = 0;
+    int star[2];
+    int stars = 0;
+    spec[s++] = '%';
+    while (*f && strchr("-+ #0", *f) && s < 8) spec[s++] = *f++;
+    if (*f == '*') {
+      star[stars++] = r.nextInt();
+      spec[s++] = *f++;
+    }
+    while (*f >= '0' && *f <= '9' && s < 14) spec[s++] = *f++;
+    if (*f == '.') {
+      spec[s++] = *f++;
+      if (*f == '*') {
+        star[stars++] = r.nextInt();
+        spec[s++] = *f++;
+      }
+      while (*f >= '0' && *f <= '9' && s < 20) spec[s++] = *f++;
+    }
+    while (*f && strchr("hlzjtLq", *f)) f++;
+    const char conv = *f;
+    if (!conv) break;
+    f++;
+
+    Arg a;
+    int n = r.next(a) ? formatConversion(out + o, cap - o, spec, s, conv, stars, star, a) : -1;
+    if (n < 0) {
+      out[o] = '?';
+      n = 1;
+    }
+    o += (size_t)n < cap - o ? (size_t)n : cap - o - 1;
+  }
+  out[o] = '\0';
+  return o;
+}
+
+} // namespace LogRecord
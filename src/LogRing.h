@@ -0,0 +1,145 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <cstring>
+#include <new>
+
+// ============================================================================
+// LogRing: lock-free multi-producer / single-consumer byte ring for log records
+// ============================================================================
+// Producers (any task) reserve space with one compare-and-swap on the head, copy their record
+// and publish it by setting its ready byte; they never wait for the consumer. A full ring drops
+// the record and counts it. The consumer hands committed records out in order and frees them.
+//
+// Record: 4-byte header {uint16 payload length, uint8 tag, uint8 state} followed by the payload,
+// padded to a multiple of 4. A record never wraps: the end of the buffer is filled with a padding
+// record instead. The consumer zeroes what it consumed, so a reserved slot reads "not ready"
+// until its producer publishes it. Positions are free-running 32-bit counters; the capacity is a
+// power of two of at most 64 KB.
+
+class LogRing {
+public:
+  struct Stats {
+    uint32_t written;    // records pushed
+    uint32_t dropped;    // records rejected (ring full or record too large)
+    uint32_t highWater;  // most bytes in use at once
+  };
+
+  // capacity is rounded up to a power of two (64 bytes .. 64 KB). ok() is false if the
+  // allocation failed; push() then drops everything.
+  explicit LogRing(size_t capacity);
+  ~LogRing() { delete[] buf_; }
+  LogRing(const LogRing&) = delete;
+  LogRing& operator=(const LogRing&) = delete;
+
+  bool ok() const { return buf_ != nullptr; }
+  size_t capacity() const { return size_; }
+  size_t maxPayload() const { return size_ ? size_ / 2 - HEADER : 0; }
+
+  // Bytes reserved by producers and not yet consumed.
+  size_t used() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+  bool push(uint8_t tag, const void* data, size_t len);
+
+  // Single consumer: passes each committed record to fn(tag, payload, len) in order, stops at
+  // the first record still being written or after max records. Returns the records consumed.
+  template <typename Fn>
+  size_t drain(Fn fn, size_t max = (size_t)-1);
+
+  Stats stats() const {
+    Stats s;
+    s.written = written_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.highWater = highWater_.load(std::memory_order_relaxed);
+    return s;
+  }
+
+private:
+  static const size_t HEADER = 4;
+  static const uint8_t TAG_PAD = 0xFF;
+  static const uint8_t STATE_FREE = 0;
+  static const uint8_t STATE_READY = 1;
+
+  uint8_t* buf_ = nullptr;
+  size_t size_ = 0;
+  std::atomic<uint32_t> head_{0};  // next reservation
+  std::atomic<uint32_t> tail_{0};  // next record to consume
+  std::atomic<uint32_t> written_{0};
+  std::atomic<uint32_t> dropped_{0};
+  std::atomic<uint32_t> highWater_{0};
+
+  uint8_t* at(uint32_t pos) const { return buf_ + (pos & (uint32_t)(size_ - 1)); }
+
+  static uint32_t recordSize(size_t len) { return (uint32_t)((HEADER + len + 3) & ~(size_t)3); }
+
+  void writeHeader(uint8_t* p, size_t len, uint8_t tag) {
+    p[0] = (uint8_t)(len & 0xFF);
+    p[1] = (uint8_t)(len >> 8);
+    p[2] = tag;
+    __atomic_store_n(&p[3], STATE_READY, __ATOMIC_RELEASE);
+  }
+};
+
+inline LogRing::LogRing(size_t capacity) {
+  size_t n = 64;
+  while (n < capacity && n < 0x10000) n <<= 1;
+  buf_ = new (std::nothrow) uint8_t[n];
+  if (!buf_) return;
+  memset(buf_, 0, n);
+  size_ = n;
+}
+
+inline bool LogRing::push(uint8_t tag, const void* data, size_t len) {
+  if (!buf_ || len > maxPayload()) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  const uint32_t need = recordSize(len);
+
+  uint32_t head = head_.load(std::memory_order_relaxed);
+  uint32_t pad = 0;
+  for (;;) {
+    const uint32_t off = head & (uint32_t)(size_ - 1);
+    pad = off + need > size_ ? (uint32_t)size_ - off : 0;
+    const uint32_t inUse = head + pad + need - tail_.load(std::memory_order_acquire);
+    if (inUse > size_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (head_.compare_exchange_weak(head, head + pad + need, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+      uint32_t hw = highWater_.load(std::memory_order_relaxed);
+      while (inUse > hw && !highWater_.compare_exchange_weak(hw, inUse, std::memory_order_relaxed)) {
+      }
+      break;
+    }
+  }
+
+  if (pad) writeHeader(at(head), pad - HEADER, TAG_PAD);
+  uint8_t* p = at(head + pad);
+  memcpy(p + HEADER, data, len);
+  writeHeader(p, len, tag);
+  written_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+template <typename Fn>
+inline size_t LogRing::drain(Fn fn, size_t max) {
+  if (!buf_) return 0;
+  size_t n = 0;
+  uint32_t tail = tail_.load(std::memory_order_relaxed);
+  while (n < max && tail != head_.load(std::memory_order_acquire)) {
+    uint8_t* p = at(tail);
+    if (__atomic_load_n(&p[3], __ATOMIC_ACQUIRE) != STATE_READY) break;  // producer still copying
+    const size_t len = (size_t)p[0] | ((size_t)p[1] << 8);
+    const uint8_t tag = p[2];
+    if (tag != TAG_PAD) {
+      fn(tag, (const char*)(p + HEADER), len);
+      n++;
+    }
+    const uint32_t size = recordSize(len);
+    memset(p, 0, size);  // STATE_FREE for whatever header lands here next
+    tail += size;
+    tail_.store(tail, std::memory_order_release);
+  }
+  return n;
+}
@@ -0,0 +1,428 @@
+#pragma once
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "LogRing.h"
+#include "Logger.h"
+
+// ============================================================================
+// LogStream: recent log lines in RAM, streamed to subscribed WebSocket clients
+// ============================================================================
+// A Logger tap copies every emitted line (with its level and millis()) into a lock-free inbox,
+// so any task may log. loop() - on the loop task, where the socket is served - moves the inbox
+// into a history ring that overwrites its oldest lines, and sends each subscriber what it has not
+// seen yet, filtered by the subscriber's level:
+//
+//   {"topic":"log","data":{"seq":<seq of the first line>,"skipped":n,"more":true,
+//                          "lines":[[<level>,<ms>,"<text>"],..]}}
+//
+// "skipped" counts lines the subscriber lost because they left the history before they could be
+// sent; "more" is present while the subscriber is still behind. Lines below the runtime level
+// (Logger::setLevel()) are never emitted and cannot be streamed.
+//
+// Log frames never crowd out model traffic: loop() sends at most one frame per subscriber every
+// LOG_STREAM_INTERVAL_MS, each at most LOG_STREAM_BATCH_BYTES, and skips clients whose AsyncTCP
+// queue holds LOG_STREAM_QUEUE_LIMIT frames (their lines wait in the history). A burst of logging
+// costs the inbox a few dropped lines, never a blocked task.
+//
+// Clients subscribe through their model (ModelBase::setLogStream()):
+//   {"action":"log_subscribe","level":1,"backlog":true}   level: LogLevel number, default INFO
+//   {"action":"log_unsubscribe"}
+// backlog = true starts with the whole history instead of the next line.
+
+// History size in bytes (0 disables the stream: begin() allocates nothing and returns false).
+#ifndef LOG_STREAM_HISTORY
+#define LOG_STREAM_HISTORY 4096
+#endif
+
+// Inbox between the logging tasks and loop().
+#ifndef LOG_STREAM_INBOX
+#define LOG_STREAM_INBOX 2048
+#endif
+
+#ifndef LOG_STREAM_INTERVAL_MS
+#define LOG_STREAM_INTERVAL_MS 250
+#endif
+
+#ifndef LOG_STREAM_BATCH_BYTES
+#define LOG_STREAM_BATCH_BYTES 1024
+#endif
+
+#ifndef LOG_STREAM_QUEUE_LIMIT
+#define LOG_STREAM_QUEUE_LIMIT 4
+#endif
+
+#ifndef LOG_STREAM_MAX_CLIENTS
+#define LOG_STREAM_MAX_CLIENTS 4
+#endif
+
+// At most max bytes of s, shortened so the cut does not split a UTF-8 character.
+inline size_t utf8Cut_(const char* s, size_t len, size_t max) {
+  if (len <= max) return len;
+  len = max;
+  for (int i = 0; i < 3 && len > 0 && ((uint8_t)s[len] & 0xC0) == 0x80; ++i) len--;
+  return len;
+}
+
+class LogStream {
+public:
+  struct Stats {
+    uint32_t lines;     // lines added to the history
+    uint32_t dropped;   // lines lost in the inbox (loop() did not keep up)
+    uint32_t evicted;   // lines overwritten in the history
+    uint32_t skipped;   // lines subscribers missed (evicted before they were sent)
+    uint32_t frames;    // frames sent
+    uint32_t deferred;  // sends postponed because the client's queue was full
+  };
+
+  explicit LogStream(size_t historyBytes = LOG_STREAM_HISTORY, size_t inboxBytes = LOG_STREAM_INBOX)
+      : historyBytes_(historyBytes), inboxBytes_(inboxBytes) {}
+  ~LogStream() { end(); }
+  LogStream(const LogStream&) = delete;
+  LogStream& operator=(const LogStream&) = delete;
+
+  // Allocates the buffers and installs the Logger tap. false: disabled (history size 0), out of
+  // memory, or another tap is installed.
+  bool begin();
+  void end();
+  bool active() const { return inbox_ != nullptr; }
+
+  void setIntervalMs(uint32_t ms) { intervalMs_ = ms; }
+  uint32_t intervalMs() const { return intervalMs_; }
+  void setBatchBytes(size_t bytes) { batchBytes_ = bytes; }
+  size_t batchBytes() const { return batchBytes_; }
+
+  // false: not active or LOG_STREAM_MAX_CLIENTS subscribers. Subscribing again changes the level
+  // (and restarts from the backlog if requested).
+  bool subscribe(AsyncWebSocketClient* client, LogLevel minLevel, bool backlog);
+  void unsubscribe(uint32_t clientId);
+  size_t subscriberCount() const;
+
+  // Moves captured lines into the history; returns how many. Called by loop().
+  size_t pump();
+
+  // pump(), then one frame per subscriber that has lines and is due. Call from the loop task.
+  void loop(AsyncWebSocket& socket);
+
+  // Bytes of history in use and lines held.
+  size_t historyUsed() const { return head_ - tail_; }
+  uint32_t historyLines() const { return nextSeq_ - firstSeq_; }
+
+  Stats stats() const;
+
+private:
+  // History record: {uint16 text length, uint8 level, uint8 kind, uint32 ms} + text, padded to 8.
+  static const size_t HEADER = 8;
+  static const uint8_t KIND_LINE = 1;
+  static const uint8_t KIND_PAD = 2;
+
+  struct Subscriber {
+    uint32_t id;  // 0 = free slot
+    uint8_t minLevel;
+    uint32_t seq;  // next line to send
+    uint32_t pos;  // its history position (valid while seq >= firstSeq_)
+    uint32_t skipped;
+  };
+
+  size_t historyBytes_;
+  size_t inboxBytes_;
+  uint32_t intervalMs_ = LOG_STREAM_INTERVAL_MS;
+  size_t batchBytes_ = LOG_STREAM_BATCH_BYTES;
+
+  LogRing* inbox_ = nullptr;
+  uint8_t* history_ = nullptr;
+  size_t size_ = 0;  // history capacity, a power of two
+  uint32_t head_ = 0;
+  uint32_t tail_ = 0;
+  uint32_t firstSeq_ = 0;  // seq of the record at tail_
+  uint32_t nextSeq_ = 0;
+  uint32_t lastSendMs_ = 0;
+  Subscriber subs_[LOG_STREAM_MAX_CLIENTS] = {};
+  Stats stats_ = Stats();
+
+  static void tap_(void* ctx, LogLevel level, uint32_t ms, const char* line, size_t len);
+
+  uint8_t* at(uint32_t pos) const { return history_ + (pos & (uint32_t)(size_ - 1)); }
+  static uint32_t recordSize(size_t len) { return (uint32_t)((HEADER + len + 7) & ~(size_t)7); }
+  static size_t textLen(const uint8_t* rec) { return (size_t)rec[0] | ((size_t)rec[1] << 8); }
+  static uint32_t readMs(const uint8_t* rec) {
+    return (uint32_t)rec[4] | ((uint32_t)rec[5] << 8) | ((uint32_t)rec[6] << 16) | ((uint32_t)rec[7] << 24);
+  }
+
+  void append(uint8_t level, uint32_t ms, const char* text, size_t len);
+  void evictOldest();
+  uint32_t skipPad(uint32_t pos) const;
+  AsyncWebSocketSharedBuffer buildFrame(Subscriber& s);
+};
+
+inline bool LogStream::begin() {
+  if (inbox_) return true;
+  if (historyBytes_ == 0) return false;
+
+  size_t n = 256;
+  while (n < historyBytes_ && n < 0x10000) n <<= 1;
+  history_ = new (std::nothrow) uint8_t[n];
+  inbox_ = history_ ? new (std::nothrow) LogRing(inboxBytes_) : nullptr;
+  if (!inbox_ || !inbox_->ok() || !Logger::setTap(&LogStream::tap_, this)) {
+    delete inbox_;
+    delete[] history_;
+    inbox_ = nullptr;
+    history_ = nullptr;
+    return false;
+  }
+  size_ = n;
+  head_ = tail_ = 0;
+  firstSeq_ = nextSeq_ = 0;
+  return true;
+}
+
+inline void LogStream::end() {
+  if (!inbox_) return;
+  (void)Logger::setTap(nullptr, nullptr);
+  delete inbox_;
+  delete[] history_;
+  inbox_ = nullptr;
+  history_ = nullptr;
+  size_ = 0;
+  for (Subscriber& s : subs_) s.id = 0;
+}
+
+// Logging task: strip the "[LEVEL] " prefix (the level travels as a number) and queue.
+inline void LogStream::tap_(void* ctx, LogLevel level, uint32_t ms, const char* line, size_t len) {
+  LogStream* self = static_cast<LogStream*>(ctx);
+  LogRing* inbox = self->inbox_;
+  if (!inbox) return;
+  const size_t p = strlen(Logger::levelPrefix(level));
+  if (len >= p) {
+    line += p;
+    len -= p;
+  }
+  char rec[4 + LOG_LINE_LEN];
+  len = utf8Cut_(line, len, LOG_LINE_LEN);
+  memcpy(rec, &ms, 4);
+  memcpy(rec + 4, line, len);
+  (void)inbox->push((uint8_t)level, rec, 4 + len);
+}
+
+inline size_t LogStream::pump() {
+  if (!inbox_) return 0;
+  return inbox_->drain([this](uint8_t level, const char* rec, size_t len) {
+    uint32_t ms;
+    memcpy(&ms, rec, 4);
+    append(level, ms, rec + 4, len - 4);
+  });
+}
+
+inline void LogStream::append(uint8_t level, uint32_t ms, const char* text, size_t len) {
+  len = utf8Cut_(text, len, size_ / 2 - HEADER);
+  const uint32_t need = recordSize(len);
+  const uint32_t off = head_ & (uint32_t)(size_ - 1);
+  const uint32_t pad = off + need > size_ ? (uint32_t)size_ - off : 0;
+  while (head_ + pad + need - tail_ > size_) evictOldest();
+
+  if (pad) {
+    uint8_t* p = at(head_);
+    p[0] = p[1] = 0;
+    p[3] = KIND_PAD;
+    head_ += pad;
+  }
+  uint8_t* p = at(head_);
+  p[0] = (uint8_t)(len & 0xFF);
+  p[1] = (uint8_t)(len >> 8);
+  p[2] = level;
+  p[3] = KIND_LINE;
+  p[4] = (uint8_t)ms;
+  p[5] = (uint8_t)(ms >> 8);
+  p[6] = (uint8_t)(ms >> 16);
+  p[7] = (uint8_t)(ms >> 24);
+  memcpy(p + HEADER, text, len);
+  head_ += need;
+  nextSeq_++;
+  stats_.lines++;
+}
+
+// Padding fills the rest of the buffer up to the wrap; records are multiples of 8, so it always
+// has room for a header.
+inline uint32_t LogStream::skipPad(uint32_t pos) const {
+  if (pos != head_ && at(pos)[3] == KIND_PAD) pos += (uint32_t)size_ - (pos & (uint32_t)(size_ - 1));
+  return pos;
+}
+
+inline void LogStream::evictOldest() {
+  tail_ = skipPad(tail_);
+  if (tail_ == head_) return;
+  tail_ += recordSize(textLen(at(tail_)));
+  firstSeq_++;
+  stats_.evicted++;
+  tail_ = skipPad(tail_);
+}
+
+inline bool LogStream::subscribe(AsyncWebSocketClient* client, LogLevel minLevel, bool backlog) {
+  if (!inbox_ || !client) return false;
+  Subscriber* slot = nullptr;
+  for (Subscriber& s : subs_) {
+    if (s.id == client->id()) {
+      slot = &s;
+      break;
+    }
+    if (!slot && s.id == 0) slot = &s;
+  }
+  if (!slot) return false;
+  const bool known = slot->id == client->id();
+  slot->id = client->id();
+  slot->minLevel = (uint8_t)minLevel;
+  if (backlog) {
+    slot->seq = firstSeq_;
+    slot->pos = tail_;
+  } else if (!known) {
+    slot->seq = nextSeq_;
+    slot->pos = head_;
+  }
+  slot->skipped = 0;
+  return true;
+}
+
+inline void LogStream::unsubscribe(uint32_t clientId) {
+  for (Subscriber& s : subs_) {
+    if (s.id == clientId) s.id = 0;
+  }
+}
+
+inline size_t LogStream::subscriberCount() const {
+  size_t n = 0;
+  for (const Subscriber& s : subs_) n += s.id != 0 ? 1 : 0;
+  return n;
+}
+
+inline void LogStream::loop(AsyncWebSocket& socket) {
+  (void)pump();
+  if (subscriberCount() == 0) return;
+  const uint32_t now = millis();
+  if ((uint32_t)(now - lastSendMs_) < intervalMs_) return;
+  lastSendMs_ = now;
+
+  for (Subscriber& s : subs_) {
+    if (s.id == 0) continue;
+    AsyncWebSocketClient* c = socket.client(s.id);
+    if (!c || c->status() != WS_CONNECTED) {
+      s.id = 0;
+      continue;
+    }
+    if (s.seq == nextSeq_) continue;
+    if (c->queueIsFull() || c->queueLen() >= LOG_STREAM_QUEUE_LIMIT) {
+      stats_.deferred++;
+      continue;
+    }
+    AsyncWebSocketSharedBuffer buf = buildFrame(s);
+    if (buf && c->text(buf)) stats_.frames++;
+  }
+}
+
+// Length of the well-formed UTF-8 sequence at s[0..len), 0 if it is invalid or cut off.
+inline size_t utf8SequenceLen_(const uint8_t* s, size_t len) {
+  const uint8_t b = s[0];
+  size_t n;
+  uint8_t lo = 0x80, hi = 0xBF;  // allowed range of the second byte (no overlongs, surrogates, > U+10FFFF)
+  if (b >= 0xC2 && b <= 0xDF) {
+    n = 2;
+  } else if (b >= 0xE0 && b <= 0xEF) {
+    n = 3;
+    if (b == 0xE0) lo = 0xA0;
+    if (b == 0xED) hi = 0x9F;
+  } else if (b >= 0xF0 && b <= 0xF4) {
+    n = 4;
+    if (b == 0xF0) lo = 0x90;
+    if (b == 0xF4) hi = 0x8F;
+  } else {
+    return 0;
+  }
+  if (len < n || s[1] < lo || s[1] > hi) return 0;
+  for (size_t i = 2; i < n; ++i) {
+    if ((s[i] & 0xC0) != 0x80) return 0;
+  }
+  return n;
+}
+
+// Log frames are WebSocket text frames, which must be valid UTF-8 (a browser closes the
+// connection otherwise): bytes that do not form a character become \ufffd.
+inline void appendJsonString_(std::vector<uint8_t>& out, const char* s, size_t len) {
+  static const char hex[] = "0123456789abcdef";
+  static const char replacement[] = "\\ufffd";
+  out.push_back('"');
+  for (size_t i = 0; i < len; ++i) {
+    const uint8_t ch = (uint8_t)s[i];
+    if (ch >= 0x80) {
+      const size_t n = utf8SequenceLen_((const uint8_t*)s + i, len - i);
+      if (n == 0) {
+        out.insert(out.end(), replacement, replacement + 6);
+      } else {
+        out.insert(out.end(), (const uint8_t*)s + i, (const uint8_t*)s + i + n);
+        i += n - 1;
+      }
+    } else if (ch == '"' || ch == '\\') {
+      out.push_back('\\');
+      out.push_back(ch);
+    } else if (ch == '\n') {
+      out.push_back('\\');
+      out.push_back('n');
+    } else if (ch < 0x20) {
+      const uint8_t esc[6] = {'\\', 'u', '0', '0', (uint8_t)hex[ch >> 4], (uint8_t)hex[ch & 0xF]};
+      out.insert(out.end(), esc, esc + 6);
+    } else {
+      out.push_back(ch);
+    }
+  }
+  out.push_back('"');
+}
+
+// Lines from the subscriber's cursor at or above its level, up to batchBytes_ (at least one).
+// Returns an empty buffer if nothing passed the filter and nothing was skipped.
+inline AsyncWebSocketSharedBuffer LogStream::buildFrame(Subscriber& s) {
+  if (s.seq - firstSeq_ > nextSeq_ - firstSeq_) {  // cursor fell out of the history
+    s.skipped += firstSeq_ - s.seq;
+    stats_.skipped += firstSeq_ - s.seq;
+    s.seq = firstSeq_;
+  }
+  if (s.seq == firstSeq_) s.pos = tail_;  // padding in front of the oldest line may be reused
+
+  AsyncWebSocketSharedBuffer buf = std::make_shared<std::vector<uint8_t>>();
+  std::vector<uint8_t>& out = *buf;
+  out.reserve(batchBytes_ + 128);
+  uint32_t firstSent = s.seq;
+  size_t count = 0;
+  char num[24];
+  while (s.seq != nextSeq_ && out.size() < batchBytes_) {
+    s.pos = skipPad(s.pos);
+    const uint8_t* rec = at(s.pos);
+    const size_t len = textLen(rec);
+    if (rec[2] >= s.minLevel) {
+      if (count == 0) firstSent = s.seq;
+      const int n = snprintf(num, sizeof(num), "%s[%u,%u,", count ? "," : "", (unsigned)rec[2], (unsigned)readMs(rec));
+      out.insert(out.end(), num, num + n);
+      appendJsonString_(out, (const char*)(rec + HEADER), len);
+      out.push_back(']');
+      count++;
+    }
+    s.pos += recordSize(len);
+    s.seq++;
+  }
+  if (count == 0 && s.skipped == 0) return AsyncWebSocketSharedBuffer();
+
+  char head[96];
+  const int h = snprintf(head, sizeof(head), "{\"topic\":\"log\",\"data\":{\"seq\":%u,\"skipped\":%u,%s\"lines\":[",
+                         (unsigned)firstSent, (unsigned)s.skipped, s.seq != nextSeq_ ? "\"more\":true," : "");
+  s.skipped = 0;
+  out.insert(out.begin(), head, head + h);
+  static const char close[] = "]}}";
+  out.insert(out.end(), close, close + 3);
+  return buf;
+}
+
+inline LogStream::Stats LogStream::stats() const {
+  Stats s = stats_;
+  if (inbox_) s.dropped = inbox_->stats().dropped;
+  return s;
+}
@@ -1,5 +1,17 @@
 #pragma once
 #include <Arduino.h>
+#include <atomic>
+#include <new>
+#include <stdarg.h>
+
+#include "LogRecord.h"
+#include "LogRing.h"
+
+#if defined(ESP32)
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
 
 // Log levels
 enum class LogLevel {
@@ -16,6 +28,33 @@ enum class LogLevel {
 #define LOG_LEVEL LogLevel::INFO
 #endif
 
+// Compile-time floor as a number (0 = TRACE ... 5 = NONE). Call sites below it are removed
+// entirely, format strings included; setLevel() only switches between the levels above it.
+// Release builds: -DLOG_MIN_LEVEL=2 keeps INFO/WARN/ERROR.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+// Longest line that goes through the async ring or a deferred record (prefix included); longer
+// ones end in "..." there. Synchronous output (no beginAsync()) prints long lines in full, at the
+// cost of a heap buffer for that line.
+#ifndef LOG_LINE_LEN
+#define LOG_LINE_LEN 192
+#endif
+
+// Default ring size for Logger::beginAsync() and the interval of the drain task.
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 4096
+#endif
+#ifndef LOG_DRAIN_MS
+#define LOG_DRAIN_MS 20
+#endif
+
+// 1: start with deferred formatting on (see Logger::setDeferred()).
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED 0
+#endif
+
 namespace Logger {
   inline LogLevel& levelRef() {
     static LogLevel level = LOG_LEVEL;
@@ -41,21 +80,349 @@ namespace Logger {
     }
   }
   
+  // false for levels below LOG_MIN_LEVEL, so guarded code folds away at compile time.
+  inline constexpr bool compiledIn(LogLevel level) {
+    return (int)level >= LOG_MIN_LEVEL;
+  }
+
   inline bool shouldLog(LogLevel level) {
-    return level >= levelRef();
+    return compiledIn(level) && level >= levelRef();
+  }
+
+  // ---- Output ----
+  // Lines go straight to Serial until beginAsync(). After that, producers only format into a
+  // LogRing (no UART wait in the AsyncTCP task or an ISR-heavy loop); drain() writes them out,
+  // on the ESP32 from a low-priority task. A full ring drops lines and counts them; the next
+  // drain() reports how many were lost.
+
+  struct AsyncStats {
+    bool active;
+    uint32_t written;    // lines queued
+    uint32_t dropped;    // lines lost to a full ring
+    uint32_t highWater;  // most ring bytes in use
+  };
+
+  struct AsyncState {
+    std::atomic<LogRing*> ring{nullptr};
+    std::atomic<uint32_t> users{0};  // RingRef_ holders: endAsync() frees the ring only at 0
+    std::atomic_flag draining = ATOMIC_FLAG_INIT;
+    uint32_t reportedDrops = 0;
+#if defined(ESP32)
+    TaskHandle_t task = nullptr;
+    TaskHandle_t stopWaiter = nullptr;  // notified by the drain task when it exits
+    std::atomic<bool> stopTask{false};
+#endif
+  };
+
+  inline AsyncState& asyncState() {
+    static AsyncState state;
+    return state;
+  }
+
+  // Pins the ring while a task pushes to or drains it. endAsync() unpublishes the ring first and
+  // then waits for users to drop to 0, so a pinned ring is never deleted under a producer.
+  struct RingRef_ {
+    LogRing* const ring;
+    RingRef_() : ring(pin()) {}
+    ~RingRef_() { asyncState().users.fetch_sub(1); }
+    RingRef_(const RingRef_&) = delete;
+    RingRef_& operator=(const RingRef_&) = delete;
+
+  private:
+    static LogRing* pin() {
+      AsyncState& st = asyncState();
+      st.users.fetch_add(1);
+      return st.ring.load();
+    }
+  };
+
+  inline const char* levelPrefix(LogLevel level) {
+    switch(level) {
+      case LogLevel::TRACE: return "[TRACE] ";
+      case LogLevel::DEBUG: return "[DEBUG] ";
+      case LogLevel::INFO:  return "[INFO]  ";
+      case LogLevel::WARN:  return "[WARN]  ";
+      default:              return "[ERROR] ";
+    }
+  }
+
+  inline void writeLine_(const char* line, size_t len) {
+    Serial.write((const uint8_t*)line, len);
+    Serial.println();
+  }
+
+  // ---- Tap ----
+  // One extra consumer of every emitted line (LogStream installs it), called where the line is
+  // formatted: in the logging task right before the line is queued or printed, or by drain() for
+  // deferred records. ms is the millis() of the log call. It must not block and must not log.
+  // Install and remove it from setup code, not while other tasks log.
+  typedef void (*Tap)(void* ctx, LogLevel level, uint32_t ms, const char* line, size_t len);
+
+  struct TapState {
+    std::atomic<Tap> fn{nullptr};
+    void* ctx = nullptr;
+  };
+
+  inline TapState& tapState() {
+    static TapState state;
+    return state;
+  }
+
+  // false: another tap is installed (remove it first with setTap(nullptr, nullptr)).
+  inline bool setTap(Tap fn, void* ctx) {
+    TapState& t = tapState();
+    if (fn && t.fn.load(std::memory_order_acquire)) return false;
+    t.fn.store(nullptr, std::memory_order_release);
+    t.ctx = ctx;
+    t.fn.store(fn, std::memory_order_release);
+    return true;
+  }
+
+  inline void emit(LogLevel level, const char* line, size_t len) {
+    TapState& tap = tapState();
+    const Tap fn = tap.fn.load(std::memory_order_acquire);
+    if (fn) fn(tap.ctx, level, millis(), line, len);
+
+    RingRef_ ref;
+    if (ref.ring) {
+      (void)ref.ring->push((uint8_t)level, line, len);
+      return;
+    }
+    writeLine_(line, len);
+  }
+
+  inline void vlogf(LogLevel level, const char* fmt, va_list ap) {
+    char line[LOG_LINE_LEN];
+    const char* prefix = levelPrefix(level);
+    const size_t p = strlen(prefix);
+    memcpy(line, prefix, p);
+    va_list full;
+    va_copy(full, ap);
+    const int n = vsnprintf(line + p, sizeof(line) - p, fmt ? fmt : "", ap);
+    size_t len = p + (n > 0 ? (size_t)n : 0);
+    if (len >= sizeof(line)) {
+      // Printed directly: format again into a buffer that fits, like Serial.printf would.
+      char* big = asyncState().ring.load(std::memory_order_relaxed) ? nullptr : new (std::nothrow) char[len + 1];
+      if (big) {
+        memcpy(big, prefix, p);
+        vsnprintf(big + p, len + 1 - p, fmt, full);
+        va_end(full);
+        emit(level, big, len);
+        delete[] big;
+        return;
+      }
+      len = sizeof(line) - 1;
+      memcpy(line + len - 3, "...", 3);
+    }
+    va_end(full);
+    emit(level, line, len);
+  }
+
+  inline void logf(LogLevel level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  inline void logf(LogLevel level, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vlogf(level, fmt, ap);
+    va_end(ap);
+  }
+
+  // logf() without the format check, for logt(): the macros check the format at the call site.
+  inline void logfUnchecked_(LogLevel level, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vlogf(level, fmt, ap);
+    va_end(ap);
+  }
+
+  // Only ever named in unevaluated context by the macros, to get printf format checking.
+  int checkFormat_(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+  // ---- Deferred formatting ----
+  // With setDeferred(true) and beginAsync() active, the LOG_* macros do not format at all: they
+  // store a LogRecord (format string pointer, timestamp, raw arguments; strings copied) in the ring
+  // and drain() formats it, like a trace buffer. A log call then costs an argument copy and one
+  // ring reservation instead of a vsnprintf. Without the async ring lines are formatted at once.
+  static const uint8_t TAG_DEFERRED = 0x80;  // ring tag: TAG_DEFERRED | level
+
+  inline bool& deferredRef() {
+    static bool deferred = LOG_DEFERRED != 0;
+    return deferred;
+  }
+
+  inline void setDeferred(bool on) { deferredRef() = on; }
+  inline bool deferred() { return deferredRef(); }
+
+  template <typename... Args>
+  inline void logt(LogLevel level, const char* fmt, Args... args) {
+    if (deferredRef()) {
+      RingRef_ ref;
+      if (!ref.ring) {
+        logfUnchecked_(level, fmt, args...);
+        return;
+      }
+      uint8_t rec[LOG_LINE_LEN];
+      const size_t n = LogRecord::encode(rec, sizeof(rec), fmt ? fmt : "", millis(), args...);
+      (void)ref.ring->push((uint8_t)(TAG_DEFERRED | (uint8_t)level), rec, n);
+      return;
+    }
+    logfUnchecked_(level, fmt, args...);
+  }
+
+  inline void log(LogLevel level, const char* msg) { logt(level, "%s", msg ? msg : ""); }
+  inline void log(LogLevel level, const String& msg) { log(level, msg.c_str()); }
+
+  // Queued ring entry to Serial: a formatted line, or a deferred record formatted now.
+  inline void writeQueued_(uint8_t tag, const char* data, size_t len) {
+    if (!(tag & TAG_DEFERRED)) {
+      writeLine_(data, len);
+      return;
+    }
+    const LogLevel level = (LogLevel)(tag & ~TAG_DEFERRED);
+    const uint8_t* rec = (const uint8_t*)data;
+    char line[LOG_LINE_LEN];
+    const char* prefix = levelPrefix(level);
+    const size_t p = strlen(prefix);
+    memcpy(line, prefix, p);
+    const size_t n = p + LogRecord::format(line + p, sizeof(line) - p, rec, len);
+    TapState& tap = tapState();
+    const Tap fn = tap.fn.load(std::memory_order_acquire);
+    if (fn) fn(tap.ctx, level, LogRecord::timestamp(rec), line, n);
+    writeLine_(line, n);
+  }
+
+  // Caller holds the draining flag (or has stopped every other drainer).
+  inline size_t drainLocked_(AsyncState& st, LogRing* ring, size_t max) {
+    const size_t n = ring->drain(&writeQueued_, max);
+    const uint32_t dropped = ring->stats().dropped;
+    if (dropped != st.reportedDrops) {
+      char note[64];
+      const int len = snprintf(note, sizeof(note), "[WARN]  [Log] %u lines dropped (ring full)",
+                               (unsigned)(dropped - st.reportedDrops));
+      st.reportedDrops = dropped;
+      writeLine_(note, (size_t)len);
+    }
+    return n;
+  }
+
+  // Writes queued lines to Serial (at most max). Safe to call from several tasks: only one
+  // drains at a time, the others return 0.
+  inline size_t drain(size_t max = (size_t)-1) {
+    AsyncState& st = asyncState();
+    RingRef_ ref;
+    if (!ref.ring || st.draining.test_and_set(std::memory_order_acquire)) return 0;
+    const size_t n = drainLocked_(st, ref.ring, max);
+    st.draining.clear(std::memory_order_release);
+    return n;
+  }
+
+  // Last words: drains everything queued, even while another task is draining (it may never
+  // run again). Registered as shutdown handler (ESP.restart()); call it from a panic hook too.
+  inline void flushOnCrash() {
+    AsyncState& st = asyncState();
+    RingRef_ ref;
+    if (!ref.ring) return;
+    // Give a drain in progress a moment to finish, then take over regardless. A flag we took
+    // stays set until we are done; a forced one belongs to its holder.
+    bool owned = false;
+    for (uint32_t i = 0; i < 100000 && !owned; ++i) owned = !st.draining.test_and_set(std::memory_order_acquire);
+    (void)drainLocked_(st, ref.ring, (size_t)-1);
+    if (owned) st.draining.clear(std::memory_order_release);
+    Serial.flush();
+  }
+
+#if defined(ESP32)
+  // Exits on its own between two drains when endAsync() asks it to, so it never dies holding
+  // the draining flag or the UART.
+  inline void drainTask_(void*) {
+    AsyncState& st = asyncState();
+    while (!st.stopTask.load()) {
+      (void)drain();
+      vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_MS));
+    }
+    xTaskNotifyGive(st.stopWaiter);
+    vTaskDelete(nullptr);
+  }
+#endif
+
+  // Switch to queued output with a ring of `capacity` bytes. startTask = false leaves draining
+  // to the caller (drain() from loop()); off the ESP32 there is never a task. false: already
+  // active or out of memory (logging stays synchronous).
+  inline bool beginAsync(size_t capacity = LOG_RING_SIZE, bool startTask = true, unsigned priority = 1) {
+    AsyncState& st = asyncState();
+    if (st.ring.load()) return false;
+    LogRing* ring = new (std::nothrow) LogRing(capacity);
+    if (!ring || !ring->ok()) {
+      delete ring;
+      return false;
+    }
+    st.reportedDrops = 0;
+    st.ring.store(ring);
+#if defined(ESP32)
+    static bool shutdownHooked = false;
+    if (!shutdownHooked) shutdownHooked = esp_register_shutdown_handler(&flushOnCrash) == ESP_OK;
+    if (startTask) xTaskCreate(&drainTask_, "log_drain", 3072, nullptr, (UBaseType_t)priority, &st.task);
+#else
+    (void)startTask;
+    (void)priority;
+#endif
+    return true;
+  }
+
+  // Back to synchronous output; writes what is still queued first. Call it from setup code
+  // (one task), not from the drain task.
+  inline void endAsync() {
+    AsyncState& st = asyncState();
+    if (!st.ring.load()) return;
+#if defined(ESP32)
+    if (st.task) {
+      st.stopWaiter = xTaskGetCurrentTaskHandle();
+      st.stopTask.store(true);
+      (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      st.task = nullptr;
+      st.stopTask.store(false);
+    }
+#endif
+    (void)drain();
+    LogRing* ring = st.ring.exchange(nullptr);
+    if (!ring) return;
+    // New lines go to Serial now; wait for tasks still pushing to (or draining) the old ring.
+    while (st.users.load() != 0) {
+#if defined(ESP32)
+      vTaskDelay(1);
+#else
+      yield();
+#endif
+    }
+    (void)drainLocked_(st, ring, (size_t)-1);
+    delete ring;
+  }
+
+  inline AsyncStats asyncStats() {
+    AsyncStats s = AsyncStats();
+    RingRef_ ref;
+    LogRing* ring = ref.ring;
+    s.active = ring != nullptr;
+    if (ring) {
+      const LogRing::Stats r = ring->stats();
+      s.written = r.written;
+      s.dropped = r.dropped;
+      s.highWater = r.highWater;
+    }
+    return s;
   }
 }
 
-// Logging macros
-#define LOG_TRACE(msg) if(Logger::shouldLog(LogLevel::TRACE)) { Serial.print("[TRACE] "); Serial.println(msg); }
-#define LOG_DEBUG(msg) if(Logger::shouldLog(LogLevel::DEBUG)) { Serial.print("[DEBUG] "); Serial.println(msg); }
-#define LOG_INFO(msg)  if(Logger::shouldLog(LogLevel::INFO))  { Serial.print("[INFO]  "); Serial.println(msg); }
-#define LOG_WARN(msg)  if(Logger::shouldLog(LogLevel::WARN))  { Serial.print("[WARN]  "); Serial.println(msg); }
-#define LOG_ERROR(msg) if(Logger::shouldLog(LogLevel::ERROR)) { Serial.print("[ERROR] "); Serial.println(msg); }
+// Logging macros (the LOG_MIN_LEVEL test is a constant, so the compiler drops the whole
+// statement below the floor even without optimization)
+#define LOG_TRACE(msg) if(LOG_MIN_LEVEL <= 0 && Logger::shouldLog(LogLevel::TRACE)) { Logger::log(LogLevel::TRACE, msg); }
+#define LOG_DEBUG(msg) if(LOG_MIN_LEVEL <= 1 && Logger::shouldLog(LogLevel::DEBUG)) { Logger::log(LogLevel::DEBUG, msg); }
+#define LOG_INFO(msg)  if(LOG_MIN_LEVEL <= 2 && Logger::shouldLog(LogLevel::INFO))  { Logger::log(LogLevel::INFO, msg); }
+#define LOG_WARN(msg)  if(LOG_MIN_LEVEL <= 3 && Logger::shouldLog(LogLevel::WARN))  { Logger::log(LogLevel::WARN, msg); }
+#define LOG_ERROR(msg) if(LOG_MIN_LEVEL <= 4 && Logger::shouldLog(LogLevel::ERROR)) { Logger::log(LogLevel::ERROR, msg); }
 
 // Convenience macros for formatted output
-#define LOG_TRACE_F(fmt, ...) if(Logger::shouldLog(LogLevel::TRACE)) { Serial.print("[TRACE] "); Serial.printf(fmt, ##__VA_ARGS__); Serial.println(); }
-#define LOG_DEBUG_F(fmt, ...) if(Logger::shouldLog(LogLevel::DEBUG)) { Serial.print("[DEBUG] "); Serial.printf(fmt, ##__VA_ARGS__); Serial.println(); }
-#define LOG_INFO_F(fmt, ...)  if(Logger::shouldLog(LogLevel::INFO))  { Serial.print("[INFO]  "); Serial.printf(fmt, ##__VA_ARGS__); Serial.println(); }
-#define LOG_WARN_F(fmt, ...)  if(Logger::shouldLog(LogLevel::WARN))  { Serial.print("[WARN]  "); Serial.printf(fmt, ##__VA_ARGS__); Serial.println(); }
-#define LOG_ERROR_F(fmt, ...) if(Logger::shouldLog(LogLevel::ERROR)) { Serial.print("[ERROR] "); Serial.printf(fmt, ##__VA_ARGS__); Serial.println(); }
+#define LOG_TRACE_F(fmt, ...) if(LOG_MIN_LEVEL <= 0 && Logger::shouldLog(LogLevel::TRACE)) { (void)sizeof(Logger::checkFormat_(fmt, ##__VA_ARGS__)); Logger::logt(LogLevel::TRACE, fmt, ##__VA_ARGS__); }
+#define LOG_DEBUG_F(fmt, ...) if(LOG_MIN_LEVEL <= 1 && Logger::shouldLog(LogLevel::DEBUG)) { (void)sizeof(Logger::checkFormat_(fmt, ##__VA_ARGS__)); Logger::logt(LogLevel::DEBUG, fmt, ##__VA_ARGS__); }
+#define LOG_INFO_F(fmt, ...)  if(LOG_MIN_LEVEL <= 2 && Logger::shouldLog(LogLevel::INFO))  { (void)sizeof(Logger::checkFormat_(fmt, ##__VA_ARGS__)); Logger::logt(LogLevel::INFO, fmt, ##__VA_ARGS__); }
+#define LOG_WARN_F(fmt, ...)  if(LOG_MIN_LEVEL <= 3 && Logger::shouldLog(LogLevel::WARN))  { (void)sizeof(Logger::checkFormat_(fmt, ##__VA_ARGS__)); Logger::logt(LogLevel::WARN, fmt, ##__VA_ARGS__); }
+#define LOG_ERROR_F(fmt, ...) if(LOG_MIN_LEVEL <= 4 && Logger::shouldLog(LogLevel::ERROR)) { (void)sizeof(Logger::checkFormat_(fmt, ##__VA_ARGS__)); Logger::logt(LogLevel::ERROR, fmt, ##__VA_ARGS__); }
@@ -5,7 +5,8 @@
 #include "model/types/ModelTypePrimitive.h"
 
 // Minimal test model to validate that multiple models can coexist
-// without overwriting each other's Preferences and without sharing the same WS endpoint.
+// without overwriting each other's Preferences. On the WiFiProvisioner it shares the admin
+// model's WS endpoint under the "user" namespace (WsHub).
 class Model : public ModelBase {
 public:
   struct TestTopic {
@@ -21,12 +22,12 @@ public:
       return s;
     }
 
-    void setSaveCallback(std::function<void()> cb) {
+    void setSaveCallback(fj::Callback cb) {
       value.setOnChange(cb);
     }
   } test;
 
-  Model() : ModelBase(80, "/ws2", "model2") {
+  Model() : ModelBase(80, "/ws", "model2") {
     test.value = 1;
     registerTopic("test", test);
   }
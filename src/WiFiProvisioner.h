@@ -17,9 +17,11 @@
 // #include "LiveGraphManager.h"
 #include "TimeSync.h"
 #include "Logger.h"
+#include "LogStream.h"
 #include "Periodic.h"
 
 #include "AdminModel.h"
+#include "model/WsHub.h"
 
 class WiFiProvisioner
 {
@@ -33,9 +35,21 @@ public:
   // Built-in admin/settings model (always present)
   AdminModel model;
 
+  // One WebSocket endpoint ("/ws") for both models: the admin model is the hub's default model,
+  // the user model is served under its namespace (see WsHub).
+  WsHub hub;
+
+  // Recent log lines for the admin page's live log (log_subscribe on /ws, see LogStream.h).
+  // Started by begin(); LOG_STREAM_HISTORY = 0 leaves it off.
+  LogStream logStream;
+
   // Optional user model (provided by library user)
-  // Must use a different WS path + Preferences namespace than the admin model.
-  void setUserModel(ModelBase& userModel) { _userModel = &userModel; }
+  // Must use a different Preferences namespace than the admin model; its topics are sent with
+  // "ns":"<ns>" on the shared socket.
+  void setUserModel(ModelBase& userModel, const char* ns = "user") {
+    _userModel = &userModel;
+    _userNs = ns;
+  }
   void clearUserModel() { _userModel = nullptr; }
   ModelBase* userModel() const { return _userModel; }
 
@@ -97,8 +111,16 @@ public:
     t.replace("%", "%25");
     t.replace(" ", "%20");
 
+    // The models of this provisioner join the hub in begin(), possibly after this call.
+    const bool onHub = &m == &model || &m == _userModel;
+    const char* ns = &m == _userModel ? _userNs : m.wsNamespace();
+
     String url = "/model.html?ws=";
-    url += m.wsPath();
+    url += onHub ? hub.path() : m.wsPath();
+    if (ns) {
+      url += "&ns=";
+      url += ns;
+    }
     url += "&title=";
     url += t;
     // Tell the UI to keep the friendly endpoint in the address bar.
@@ -124,6 +146,7 @@ public:
 
   void begin()
   {
+    const bool logStreamOk = logStream.begin();  // first, so the boot log is in the history
     LOG_INFO("========== WiFi Provisioner BEGIN ==========");
     
     // ===== STEP 1: Mount Filesystem =====
@@ -141,7 +164,12 @@ public:
 
     // ===== STEP 2: Load Model & Preferences =====
     LOG_INFO("[INIT] STEP 2: Load model and Preferences...");
+    hub.add(model, nullptr);
+    if (_userModel) hub.add(*_userModel, _userNs);
     model.begin();  // Calls ModelBase::begin() and ensurePasswords()
+    // Coalesce auto-persist/broadcast of the admin topics: flushed once per handleLoop() tick.
+    model.setCoalesceWindowMs(0);
+    if (logStreamOk) model.setLogStream(&logStream);
 
     if (_userModel) {
       LOG_INFO("[INIT] User model registered -> begin()");
@@ -185,7 +213,7 @@ public:
       LOG_INFO_F("[INIT] mDNS hostname loaded from model: %s", _mdnsHost.c_str());
     }
     LOG_INFO_F("[INIT] Credentials loaded - SSID: '%s'", model.wifi.ssid.get().c_str());
-    LOG_INFO_F("[INIT] Admin UI password: %s", model.admin.pass);
+    LOG_INFO_F("[INIT] Admin UI password: %s", (const char*)model.admin.pass);
 
     // ===== STEP 3: Try STA Mode Connection =====
     LOG_INFO("[INIT] STEP 3: Try STA mode (WiFi connect)...");
@@ -251,6 +279,10 @@ public:
 
       // Erase the entire NVS partition (Preferences are stored in NVS).
       // This resets all persisted settings (WiFi creds, admin/OTA pass, sessions, etc.).
+      // Drop pending coalesced writes first so loop() cannot re-persist them into the erased NVS.
+      model.discardPending();
+      if (_userModel) _userModel->discardPending();
+
       esp_err_t err = nvs_flash_erase();
       if (err != ESP_OK) {
         LOG_ERROR_F("[RESET] nvs_flash_erase failed: %d", (int)err);
@@ -345,9 +377,16 @@ public:
 
   void handleLoop()
   {
+    // ===== CHECK 0: Flush coalesced model changes =====
+    hub.loop();
+    model.loop();
+    if (_userModel) _userModel->loop();
+
     // ===== CHECK 1: Pending Restart =====
     if (_pendingRestart && millis() >= _restartTime) {
       LOG_WARN("[LOOP] Pending restart triggered");
+      model.flush();
+      if (_userModel) _userModel->flush();
       LOG_WARN("[LOOP] Waiting for Preferences flush...");
       delay(RESTART_DELAY_MS);
       LOG_WARN("[LOOP] Restarting ESP...");
@@ -389,6 +428,8 @@ public:
       uint32_t freeHeap = ESP.getFreeHeap();
       LOG_DEBUG_F("[HEAP] Pushing heap data: %u bytes", freeHeap);
       model.admin.heap.get().push((float)freeHeap);
+      model.broadcastTopic("ws_clients");
+      model.broadcastTopic("metrics");
     }
 
     // ===== CHECK 6: Time status broadcast (1Hz) =====
@@ -397,7 +438,7 @@ public:
       String now = timeSync.nowLocalString();
       model.time.synced.set(ok);
       model.time.now.set(now.c_str());
-      model.broadcastTopic("time");
+      model.broadcastChanges("time");  // patch: usually just "now"
     }
 
     yield();
@@ -450,6 +491,7 @@ private:
   int _lastOtaRemaining = -9999;
 
   ModelBase* _userModel = nullptr;
+  const char* _userNs = "user";
 
   bool _requireBasicAuthOrChallenge(AsyncWebServerRequest* request)
   {
@@ -626,15 +668,22 @@ private:
       _serveFileWithFallback(request, "/wifi.html");
     });
 
-    // Attach Model WebSocket
+    // Prometheus scrape endpoint: hot-path metrics of the admin and user model (see Metrics.h)
+    server.on("/metrics", HTTP_GET, [this](AsyncWebServerRequest *request)
+              {
+      if (_requireAdmin && !_requireBasicAuthOrChallenge(request)) return;
+      ModelBase::MetricsSource sources[] = {{"admin", &model}, {_userNs, _userModel}};
+      String text;
+      text.reserve(4096);
+      ModelBase::writePrometheus(text, sources, _userModel ? 2 : 1);
+      request->send(200, "text/plain; version=0.0.4", text);
+    });
+
+    // Attach the shared Model WebSocket (admin + user model)
     LOG_DEBUG("[ROUTES] Registriere Model WebSocket");
+    hub.attachTo(server);
     model.attachTo(server);
 
-    if (_userModel) {
-      LOG_DEBUG("[ROUTES] Registriere User-Model WebSocket");
-      _userModel->attachTo(server, false);
-    }
-
     // Fallback Routes
     if (_staMode)
     {
@@ -682,7 +731,7 @@ private:
     if (!force && rem == _lastOtaRemaining) return;
     _lastOtaRemaining = rem;
     model.ota.remaining_seconds.set(rem);
-    model.broadcastTopic("ota");
+    model.broadcastChanges("ota");  // patch: remaining_seconds (+ pass/window after a button)
   }
 
   // Route handlers (extracted for clarity)
@@ -761,6 +810,7 @@ private:
     // Save into model (will be persisted via Preferences)
     model.wifi.ssid = newSsid;
     model.wifi.pass = newPass;
+    model.flush();  // restart follows below, handleLoop() will not run again
     
     LOG_INFO("[AP-SAVE] Credentials saved");
     LOG_WARN("[AP-SAVE] Sending OK response; restarting in 1 second...");
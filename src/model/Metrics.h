@@ -0,0 +1,137 @@
+#pragma once
+#include <Arduino.h>
+#include <stdio.h>
+
+// ============================================================================
+// Model metrics: counters and fixed-bucket latency histograms for the hot paths
+// ============================================================================
+// Every topic gets one TopicMetrics block (allocated by registerTopic) with histograms for the
+// parse, apply, save and broadcast durations; the model keeps WebSocket traffic counters. Recording
+// is an increment or a micros() pair plus one bucket search over 8 bounds, cheap enough to leave
+// on. Build with -DMODEL_METRICS=0 to skip the per-topic blocks and timers entirely.
+//
+// Export: ModelBase::writeMetrics() (the read-only "metrics" topic of AdminModel) and
+// ModelBase::writePrometheus() (text exposition format, e.g. served on GET /metrics).
+
+#ifndef MODEL_METRICS
+#define MODEL_METRICS 1
+#endif
+
+namespace fj {
+
+struct LatencyHistogram {
+  // Upper bounds in µs; the last bucket (+Inf) takes the rest.
+  static const size_t BUCKETS = 9;
+  static const uint32_t* boundsUs() {
+    static const uint32_t b[BUCKETS - 1] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000};
+    return b;
+  }
+
+  uint32_t counts[BUCKETS];  // per bucket, not cumulative
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t sumUs;
+
+  void observe(uint32_t us) {
+    const uint32_t* b = boundsUs();
+    size_t i = 0;
+    while (i < BUCKETS - 1 && us > b[i]) i++;
+    counts[i]++;
+    count++;
+    sumUs += us;
+    if (us > maxUs) maxUs = us;
+  }
+
+  uint32_t avgUs() const { return count ? (uint32_t)(sumUs / count) : 0; }
+};
+
+struct TopicMetrics {
+  LatencyHistogram parse;      // deserializeJson of updates for this topic (JsonDocument path only)
+  LatencyHistogram apply;      // applying an update (the scanner path parses while applying)
+  LatencyHistogram save;       // encoding + NVS write of a persisted topic
+  LatencyHistogram broadcast;  // envelope serialization + fan-out to all clients
+  uint32_t nvsWrites;          // saves that reached NVS (unchanged payloads are skipped)
+};
+
+// Times a scope into a histogram; does nothing (not even micros()) without one.
+class MetricsTimer {
+public:
+  explicit MetricsTimer(LatencyHistogram* h) : h_(h), start_(h ? (uint32_t)micros() : 0) {}
+  MetricsTimer(TopicMetrics* m, LatencyHistogram TopicMetrics::*h) : MetricsTimer(m ? &(m->*h) : nullptr) {}
+  ~MetricsTimer() {
+    if (h_) h_->observe((uint32_t)micros() - start_);
+  }
+  MetricsTimer(const MetricsTimer&) = delete;
+  MetricsTimer& operator=(const MetricsTimer&) = delete;
+
+private:
+  LatencyHistogram* h_;
+  uint32_t start_;
+};
+
+// Appends the Prometheus text exposition format to a String. Label values are written as given
+// (topic and model names are identifiers).
+class PrometheusText {
+public:
+  explicit PrometheusText(String& out) : out_(out) {}
+
+  void family(const char* name, const char* type, const char* help) {
+    out_ += "# HELP ";
+    out_ += name;
+    out_ += ' ';
+    out_ += help;
+    out_ += "\n# TYPE ";
+    out_ += name;
+    out_ += ' ';
+    out_ += type;
+    out_ += '\n';
+  }
+
+  void sample(const char* name, const char* labels, uint64_t value) {
+    char num[24];
+    snprintf(num, sizeof(num), "%llu", (unsigned long long)value);
+    line(name, "", labels, nullptr, num);
+  }
+
+  // _bucket (cumulative, le in seconds), _sum (seconds) and _count
+  void histogram(const char* name, const char* labels, const LatencyHistogram& h) {
+    static const char* const le[LatencyHistogram::BUCKETS] = {"0.0001", "0.00025", "0.0005", "0.001", "0.0025",
+                                                                "0.005",  "0.01",    "0.025",  "+Inf"};
+    char num[24];
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+      cumulative += h.counts[i];
+      snprintf(num, sizeof(num), "%llu", (unsigned long long)cumulative);
+      line(name, "_bucket", labels, le[i], num);
+    }
+    snprintf(num, sizeof(num), "%.6f", (double)h.sumUs / 1e6);
+    line(name, "_sum", labels, nullptr, num);
+    snprintf(num, sizeof(num), "%u", (unsigned)h.count);
+    line(name, "_count", labels, nullptr, num);
+  }
+
+private:
+  String& out_;
+
+  void line(const char* name, const char* suffix, const char* labels, const char* le, const char* value) {
+    out_ += name;
+    out_ += suffix;
+    const bool any = labels && labels[0];
+    if (any || le) {
+      out_ += '{';
+      if (any) out_ += labels;
+      if (le) {
+        if (any) out_ += ',';
+        out_ += "le=\"";
+        out_ += le;
+        out_ += '"';
+      }
+      out_ += '}';
+    }
+    out_ += ' ';
+    out_ += value;
+    out_ += '\n';
+  }
+};
+
+} // namespace fj
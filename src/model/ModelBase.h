@@ -7,9 +7,17 @@
 #include <cstring>
 #include <type_traits>
 #include <functional>
+#include <memory>
 
+#include "LogStream.h"
+#include "model/Metrics.h"
 #include "model/ModelSerializer.h"
 #include "model/types/ModelTypeTraits.h"
+#include "model/var/VarPatch.h"
+#include "model/serializer/BinaryLayout.h"
+#include "model/serializer/Hash.h"
+#include "model/var/VarScan.h"
+#include "model/var/VarThrottle.h"
 
 // Define MODEL_JSON_CAPACITY before including this header to customize the WebSocket JSON buffer size.
 // Default: 2048 bytes (sufficient for graph data with 16+ points)
@@ -18,15 +26,85 @@
 #define MODEL_JSON_CAPACITY 2048
 #endif
 
+// Default Preferences write-back delay in ms (0 = write-through). See setPrefsWriteBackMs().
+#ifndef MODEL_PREFS_WRITE_BACK_MS
+#define MODEL_PREFS_WRITE_BACK_MS 0
+#endif
+
+// Set to 1 to persist topics as tagged MessagePack blobs instead of JSON strings. See setPrefsFormat().
+#ifndef MODEL_PREFS_MSGPACK
+#define MODEL_PREFS_MSGPACK 0
+#endif
+
+// Set to 0 to stream graph points as JSON "graph_point" text frames instead of binary frames.
+// See setGraphBinary().
+#ifndef MODEL_GRAPH_BINARY
+#define MODEL_GRAPH_BINARY 1
+#endif
+
+// Number of graph series (graph + label) that get a binary series id; further series use JSON.
+#ifndef MODEL_MAX_GRAPH_SERIES
+#define MODEL_MAX_GRAPH_SERIES 8
+#endif
+
+// Default graph batching interval in ms (0 = send every point immediately). See setGraphFlushIntervalMs().
+#ifndef MODEL_GRAPH_FLUSH_MS
+#define MODEL_GRAPH_FLUSH_MS 0
+#endif
+
+// Points buffered per graph series between two flushes; older points are dropped beyond that.
+#ifndef MODEL_GRAPH_QUEUE_LEN
+#define MODEL_GRAPH_QUEUE_LEN 16
+#endif
+
+// WebSocket clients with their own backpressure accounting; further clients are served without it.
+#ifndef MODEL_MAX_CLIENTS
+#define MODEL_MAX_CLIENTS 4
+#endif
+
+// Frames queued in AsyncTCP for one client before it counts as congested. See setClientQueueLimit().
+#ifndef MODEL_WS_QUEUE_LIMIT
+#define MODEL_WS_QUEUE_LIMIT 8
+#endif
+
+// SlowClientPolicy::Disconnect closes a client that stayed congested this long.
+#ifndef MODEL_WS_DISCONNECT_AFTER_MS
+#define MODEL_WS_DISCONNECT_AFTER_MS 10000
+#endif
+
+// Topic slots allocated by the first registerTopic(); the registry doubles whenever it is full.
+// Must be a power of two. See reserveTopics().
+#ifndef MODEL_TOPIC_RESERVE
+#define MODEL_TOPIC_RESERVE 16
+#endif
+
+// Upper bound on topics per ModelBase; registerTopic() beyond it fails with an error log.
+#ifndef MODEL_MAX_TOPICS
+#define MODEL_MAX_TOPICS 1024
+#endif
+
+// Set to 0 to always parse incoming WS updates into a JsonDocument. See setWsScan().
+#ifndef MODEL_WS_SCAN
+#define MODEL_WS_SCAN 1
+#endif
+
+class WsHub;
+
 class ModelBase {
 public:
   static const size_t JSON_CAPACITY = MODEL_JSON_CAPACITY;  // Large enough for graph data with 16+ points (configurable via MODEL_JSON_CAPACITY)
 
+  // The model owns no web server: attachTo() an existing one, or call standalone(port).
+  // `port` is unused and only kept for source compatibility.
   ModelBase(uint16_t port, const char* wsPath);
 
   // Preferences namespace defaults to "model" if not specified.
   ModelBase(uint16_t port, const char* wsPath, const char* prefsNamespace);
 
+  virtual ~ModelBase();
+  ModelBase(const ModelBase&) = delete;
+  ModelBase& operator=(const ModelBase&) = delete;
+
   void begin();
 
   // Attach the model's WebSocket handler to an existing AsyncWebServer.
@@ -36,15 +114,251 @@ public:
   // If addRootRoute is true, also installs a simple GET "/" probe route.
   void attachTo(AsyncWebServer& server, bool addRootRoute);
 
-  const char* wsPath() const { return wsPath_; }
+  // Standalone operation without an external server: allocates a server on `port` owned by the
+  // model and attaches to it (later calls return the same server). Call begin() on the result.
+  // nullptr if the allocation failed.
+  AsyncWebServer* standalone(uint16_t port);
+
+  // Path of the socket this model is served on (the hub's path once added to a WsHub).
+  const char* wsPath() const { return hub_ ? socket_->url() : wsPath_; }
+
+  // Namespace on a shared WsHub (see WsHub::add()); nullptr = own socket or the hub's default model.
+  // Envelopes and graph announcements of a namespaced model carry "ns":"<name>".
+  const char* wsNamespace() const { return ns_; }
+  bool onHub() const { return hub_ != nullptr; }
 
   bool broadcastTopic(const char* topic);
 
   void broadcastAll();
 
+  // Topic ids: registration order (0, 1, ..). Envelopes carry them as "tid" and incoming
+  // updates may send {"tid":n,"data":{..}} instead of the topic name. -1 = unknown topic.
+  int topicId(const char* topic);
+
+  // Topic registry: one contiguous arena of entries plus the name index, allocated at registration
+  // time only (lookups never allocate). It starts at MODEL_TOPIC_RESERVE slots and doubles when
+  // full; call reserveTopics() before registering a large model to allocate once.
+  // Returns false if the allocation failed or n exceeds MODEL_MAX_TOPICS.
+  bool reserveTopics(size_t n);
+  size_t topicCount() const { return entryCount_; }
+  size_t topicCapacity() const { return entryCapacity_; }
+
+  // registerTopic() calls that failed (MODEL_MAX_TOPICS reached or out of memory).
+  uint32_t topicRegistrationErrors() const { return topicRegistrationErrors_; }
+
+  // FNV-1a (32 bit) of a name. constexpr, so names can be switch() case labels:
+  //   switch (ModelBase::nameHash(button)) { case ModelBase::nameHash("reset"): .. }
+  // h continues a previous hash (nameHash("b", nameHash("a")) == nameHash("ab")).
+  static constexpr uint32_t nameHash(const char* s, uint32_t h = fj::FNV1A_SEED) {
+    return fj::fnv1aStr(s, h);
+  }
+
+  // Broadcast only the fields changed since the topic was last broadcast, as
+  // {"topic":..,"tid":..,"patch":{..}}. Sends nothing if no tracked field changed; falls back to the
+  // full envelope for topics that cannot be patched (see fj::write_ws_patch()).
+  bool broadcastChanges(const char* topic);
+
   // Persist a topic by name (public wrapper)
   bool saveTopic(const char* topic);
 
+  // Coalescing of the auto-persist/broadcast triggered by Var changes (setSaveCallback topics):
+  //   < 0  immediate (default): every change saves + broadcasts its topic synchronously
+  //     0  mark the topic dirty, flush on the next loop()
+  //   > 0  mark dirty, flush from loop() once this many ms passed since the first pending change
+  void setCoalesceWindowMs(int32_t ms) { coalesceWindowMs_ = ms; }
+  int32_t coalesceWindowMs() const { return coalesceWindowMs_; }
+
+  // Preferences write-back: with ms > 0, saves requested by Var changes or WS updates only mark
+  // the topic; loop() writes all marked topics once ms passed since the first request.
+  // 0 = write-through (default). Explicit saveTopic() always writes immediately.
+  // Unflushed changes are lost on power loss: call flush() before a restart.
+  void setPrefsWriteBackMs(uint32_t ms) { prefsWriteBackMs_ = ms; }
+  uint32_t prefsWriteBackMs() const { return prefsWriteBackMs_; }
+
+  // Flush dirty topics and queued graph points when due. Call from the sketch loop when
+  // coalescing, write-back, graph batching or fj::Throttle<> fields are used.
+  void loop();
+
+  // Save + broadcast every dirty topic and send queued graph points now (e.g. before a restart).
+  void flush();
+
+  // Forget pending saves and broadcasts without writing them (e.g. before erasing NVS).
+  void discardPending();
+
+  bool hasPendingChanges() const { return dirtyPending_ || prefsPending_; }
+
+  // Encoding of persisted topics. All are always readable: a topic stored in another format
+  // is loaded and rewritten in the configured one (migration in any direction).
+  //   Json    - putString() with the makeDataOnlyJson() text
+  //   MsgPack - putBytes() with PREFS_MSGPACK_V1 followed by the same document as MessagePack
+  //   Binary  - putBytes() with PREFS_BINARY_V1, the fj::BinaryLayout hash (4 bytes) and the
+  //             fixed-layout payload; topics without a binary layout use MsgPack.
+  //             A schema change (hash mismatch) resets the topic to its defaults.
+  enum class PrefsFormat : uint8_t { Json, MsgPack, Binary };
+  static const uint8_t PREFS_MSGPACK_V1 = 0xB1;
+  static const uint8_t PREFS_BINARY_V1 = 0xB2;
+
+  void setPrefsFormat(PrefsFormat format) { prefsFormat_ = format; }
+  PrefsFormat prefsFormat() const { return prefsFormat_; }
+
+  struct PrefsStats {
+    uint32_t writes;            // putString calls that hit NVS
+    uint32_t bytesWritten;
+    uint32_t skippedUnchanged;  // payload identical to what is stored (hash match)
+    uint32_t merged;            // save requests folded into an already pending write-back
+  };
+
+  const PrefsStats& prefsStats() const { return prefsStats_; }
+  void resetPrefsStats() { prefsStats_ = PrefsStats(); }
+
+  // Slow WebSocket clients. A client is congested while its AsyncTCP queue holds at least
+  // clientQueueLimit() frames (or is full). Graph points to a congested client are always dropped;
+  // what happens to topic frames depends on the policy:
+  //   DropGraphs - topic frames are still queued (AsyncTCP may reject them when full)
+  //   Coalesce   - topic frames are held back; loop() sends the latest full state of every
+  //                skipped topic once the client drained (default)
+  //   Disconnect - Coalesce, and loop() closes clients congested for MODEL_WS_DISCONNECT_AFTER_MS
+  enum class SlowClientPolicy : uint8_t { DropGraphs, Coalesce, Disconnect };
+
+  void setSlowClientPolicy(SlowClientPolicy policy) { slowClientPolicy_ = policy; }
+  SlowClientPolicy slowClientPolicy() const { return slowClientPolicy_; }
+  void setClientQueueLimit(size_t frames) { clientQueueLimit_ = frames; }
+  size_t clientQueueLimit() const { return clientQueueLimit_; }
+
+  struct ClientStats {
+    bool active;
+    bool congested;
+    bool snapshotPending;       // attached, initial state not sent yet (loop())
+    uint32_t id;                // AsyncWebSocketClient::id()
+    uint32_t sent;              // frames queued for this client
+    uint32_t droppedGraph;      // graph frames skipped while congested
+    uint32_t coalesced;         // topic frames held back (replaced by a later full state)
+    uint32_t failed;            // frames AsyncTCP refused
+    uint32_t congestedSinceMs;  // 0 = not congested
+  };
+
+  // One slot per tracked client (MODEL_MAX_CLIENTS); inactive slots have active == false.
+  const ClientStats& clientStats(size_t slot) const { return clients_[slot]; }
+  uint32_t slowClientDisconnects() const { return slowClientDisconnects_; }
+
+  // {"policy","queue_limit","disconnects","sent","dropped_graph","coalesced","failed",
+  //  "clients":["#<id> q=<queued> sent=.. drop=.. coal=.. fail=..",..]}
+  void writeClientStats(JsonObject out);
+
+  // Incoming WS updates. With scanning enabled (default), {"topic","data"} messages are applied
+  // straight from the text with fj::scan_update(): no JsonDocument, no static buffer. Messages it
+  // does not handle (button triggers, field shapes outside the scanner, custom TypeAdapters,
+  // malformed JSON) take the JsonDocument path as before.
+  void setWsScan(bool enabled) { wsScan_ = enabled; }
+  bool wsScan() const { return wsScan_; }
+
+  // Live log streaming: "log_subscribe"/"log_unsubscribe" actions of this model's clients go to
+  // `stream` and loop() sends its batches on the model's socket (see LogStream.h). Attach a stream
+  // to one model per socket; nullptr detaches.
+  void setLogStream(LogStream* stream) { logStream_ = stream; }
+  LogStream* logStream() const { return logStream_; }
+
+  struct WsScanStats {
+    uint32_t scanned;   // updates applied by the scanner
+    uint32_t fallback;  // messages parsed into a JsonDocument
+  };
+
+  const WsScanStats& wsScanStats() const { return wsScanStats_; }
+  void resetWsScanStats() { wsScanStats_ = WsScanStats(); }
+
+  // Hot-path metrics (Metrics.h). WebSocket counters cover this model's messages and the frames
+  // it fans out (replies such as {"ok":true} are not counted).
+  struct WsMetrics {
+    uint32_t inMessages;
+    uint32_t inBytes;
+    uint32_t inErrors;   // rejected: empty, malformed, unknown topic, apply failed
+    uint32_t outFrames;  // frames accepted by AsyncTCP
+    uint32_t outBytes;
+    uint32_t outDrops;   // frames AsyncTCP refused + graph frames skipped for congested clients
+  };
+
+  const WsMetrics& wsMetrics() const { return wsMetrics_; }
+
+  // Per-topic histograms and counters; nullptr for unknown topics or with MODEL_METRICS=0.
+  const fj::TopicMetrics* topicMetrics(const char* topic);
+
+  // Clears the WebSocket counters and all topic histograms (not prefsStats()).
+  void resetMetrics();
+
+  // {"ws_in","ws_in_bytes","ws_in_errors","ws_out","ws_out_bytes","ws_drops","nvs_writes",
+  //  "nvs_bytes","clients","topics":["<topic> apply=<n>x<avg>/<max>us save=.. bcast=.. nvs=..",..]}
+  // Only topics with recorded activity are listed.
+  void writeMetrics(JsonObject out);
+
+  // Prometheus text exposition of several models, each sample labelled model="<name>":
+  //   ModelBase::MetricsSource src[] = {{"admin", &admin}, {"user", &user}};
+  //   String text;
+  //   ModelBase::writePrometheus(text, src, 2);
+  struct MetricsSource {
+    const char* name;
+    ModelBase* model;
+  };
+
+  static void writePrometheus(String& out, const MetricsSource* models, size_t count);
+
+  // Scope guard: changes made while a batch is alive only mark topics dirty.
+  // When the outermost batch ends, they are handled like a single change:
+  // flushed right away in immediate mode, otherwise left for loop().
+  //
+  //   { auto b = model.batch(); s.a = 1; s.b = 2; s.c = 3; }  // one save + one broadcast
+  class Batch {
+  public:
+    explicit Batch(ModelBase& model) : model_(&model) { model_->batchDepth_++; }
+    Batch(Batch&& other) : model_(other.model_) { other.model_ = nullptr; }
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
+    ~Batch() {
+      if (!model_) return;
+      if (--model_->batchDepth_ == 0 && model_->coalesceWindowMs_ < 0) model_->flushCoalesced();
+    }
+
+  private:
+    ModelBase* model_;
+  };
+
+  Batch batch() { return Batch(*this); }
+
+  // Graph point streaming. Binary mode (default) sends one WS_BINARY frame per point:
+  //   [0] GRAPH_FRAME_V1  [1] flags (bit0 = synced)  [2..3] series id (u16)
+  //   [4..11] x (u64)     [12..15] y (f32)           all little endian
+  // The series id is announced once as {"topic":"graph_series","data":{"id","graph","label"}}
+  // (and again to every client that connects). JSON mode sends the legacy
+  // {"topic":"graph_point","data":{graph,label,x,y,synced}} text frame.
+  static const uint8_t GRAPH_FRAME_V1 = 0x47;  // 'G'
+  static const size_t GRAPH_FRAME_SIZE = 16;
+
+  //
+  // With a flush interval > 0, points are queued per series (at most MODEL_GRAPH_QUEUE_LEN, the
+  // oldest are dropped) and loop() sends one message per series once the interval passed:
+  //   binary: [0] GRAPH_BATCH_V1  [1] flags  [2..3] series id  [4..5] count  [6..7] 0
+  //           followed by count x (u64 x, f32 y)
+  //   JSON:   {"topic":"graph_points","data":{graph,label,synced,"points":[{x,y},..]}}
+  static const uint8_t GRAPH_BATCH_V1 = 0x42;  // 'B'
+  static const size_t GRAPH_BATCH_HEADER = 8;
+  static const size_t GRAPH_BATCH_POINT = 12;
+
+  void setGraphBinary(bool enabled) { graphBinary_ = enabled; }
+  bool graphBinary() const { return graphBinary_; }
+
+  // The per-series point queues are allocated by the first interval > 0; if that fails, points
+  // keep going out one frame each.
+  void setGraphFlushIntervalMs(uint32_t ms);
+  uint32_t graphFlushIntervalMs() const { return graphFlushMs_; }
+
+  struct GraphStats {
+    uint32_t points;   // points handed to sendGraphPointXY() while a client was connected
+    uint32_t frames;   // WS messages sent for them
+    uint32_t dropped;  // points discarded because a series queue was full
+  };
+
+  const GraphStats& graphStats() const { return graphStats_; }
+  void resetGraphStats() { graphStats_ = GraphStats(); }
+
   void sendGraphPointXY(const char* graph, const char* label, uint64_t x, float y, bool synced);
 
   static void graphPushCbXY(const char* graph, const char* label, uint64_t x, float y, void* ctx);
@@ -53,20 +367,32 @@ public:
   // Test hook: allows exercising the WS message parsing/update path without needing a real AsyncWebSocketClient.
   // Returns true if the message was parsed and applied successfully.
   bool testHandleWsMessage(const char* msg, size_t len);
+
+  // Test/bench hooks: run the per-topic writers and update paths directly (no WS, no Prefs side effects).
+  String testMakeEnvelope(const char* topic);
+  String testMakeDataOnlyJson(const char* topic);
+  bool testApplyUpdateJson(const char* topic, JsonObject data);
+  bool testApplyUpdate(const char* topic, const String& dataJson);
+  AsyncWebSocket& testWebSocket() { return *socket_; }
 #endif
 
 protected:
   virtual void on_update(const char* topic) { (void)topic; }
 
+  // false: not registered (see topicRegistrationErrors()).
   template <typename T>
-  void registerTopic(const char* topic, T& obj);
+  bool registerTopic(const char* topic, T& obj);
 
   template <typename T>
-  void registerTopic(const char* topic, T& obj, bool persist, bool wsSend);
+  bool registerTopic(const char* topic, T& obj, bool persist, bool wsSend);
 
 private:
+  friend class WsHub;
+
   struct Entry {
     const char* topic;
+    uint32_t hash;  // nameHash(topic)
+    uint16_t tid;   // index in entries_ (registration order)
     void* objPtr;
     bool persist;
     bool ws_send;
@@ -79,39 +405,180 @@ private:
 
     // WS update path: apply already-parsed data object (avoids serializeJson + deserializeJson churn)
     bool (*applyUpdateJson)(void* objPtr, JsonObject data, bool strict);
+
+    // WS delta writer: fields changed after a change-clock tick; false = type not patchable
+    bool (*makeWsPatchJson)(void* objPtr, JsonObject out, uint32_t since);
+
+    // WS update path without a document (fj::scan_update); nullptr = type not scannable
+    fj::ScanResult (*scanUpdate)(void* objPtr, const char* json, size_t len);
+
+    // Pending auto side effects (coalesced mode / inside a batch)
+    bool dirtySave;
+    bool dirtyWs;
+
+    // Scheduled for Preferences write-back
+    bool savePending;
+
+    // Change-clock tick at the last broadcast (full or patch) of this topic
+    uint32_t wsGen;
+
+    // Client slots that still need the full state of this topic: initial snapshot not sent yet,
+    // or a frame was held back (SlowClientPolicy)
+    uint32_t staleClients;
+
+    // FNV-1a of the payload last written to / read from Preferences
+    uint32_t prefsHash;
+    bool prefsHashValid;
+
+    // fj::BinaryLayout<T> (Prefs purpose); binarySize == 0 means no binary layout
+    size_t binarySize;
+    uint32_t binaryHash;
+    size_t (*writeBinaryPrefs)(void* objPtr, uint8_t* out, size_t cap);
+    bool (*readBinaryPrefs)(void* objPtr, const uint8_t* in, size_t len);
+
+    // Trailing edge of fj::Throttle<> fields (fj::poll_throttled); nullptr = topic has none
+    size_t (*pollThrottled)(void* objPtr);
+
+    // Owned by the model (freed in ~ModelBase); nullptr with MODEL_METRICS=0 or out of memory
+    fj::TopicMetrics* metrics;
+  };
+
+  struct GraphSeries {
+    const char* graph;  // points into the PointRingBuffer, which outlives the model registration
+    const char* label;
+    bool announced;     // graph_series sent to all clients
+
+    // Pending points in graphQueues_[id] (graph flush interval > 0), oldest at head
+    bool synced;
+    uint16_t head;
+    uint16_t count;
+  };
+
+  struct GraphQueue {
+    uint64_t xs[MODEL_GRAPH_QUEUE_LEN];
+    float ys[MODEL_GRAPH_QUEUE_LEN];
   };
 
-  static const size_t MAX_TOPICS = 16;
-  Entry entries_[MAX_TOPICS];
+  static_assert(MODEL_MAX_TOPICS > 0 && MODEL_MAX_TOPICS < 0xFFFF, "Topic ids and index slots are 16 bit");
+  // The name index is masked with (size - 1), so its capacity has to stay a power of two.
+  static_assert(MODEL_TOPIC_RESERVE > 0 && (MODEL_TOPIC_RESERVE & (MODEL_TOPIC_RESERVE - 1)) == 0,
+                "MODEL_TOPIC_RESERVE must be a power of two");
+
+  // Entries live in one arena (entryCapacity_ slots, a power of two). Growing moves them, so
+  // nothing keeps an Entry* across registerTopic(); callbacks hold the topic id instead.
+  Entry* entries_ = nullptr;
   size_t entryCount_ = 0;
+  size_t entryCapacity_ = 0;
+  uint32_t topicRegistrationErrors_ = 0;
+  size_t throttledTopics_ = 0;  // entries with pollThrottled
+
+  // Open addressing (linear probing) over nameHash(topic); slots hold entry index + 1, 0 = empty.
+  // Twice entryCapacity_ slots keeps probe chains short.
+  uint16_t* topicIndex_ = nullptr;
+  size_t topicIndexSize_ = 0;
 
   const char* wsPath_ = "/ws";
   const char* prefsNamespace_ = "model";
   bool suppressAutoSideEffects_ = false;
-  AsyncWebServer server_;
+  int32_t coalesceWindowMs_ = -1;
+  uint16_t batchDepth_ = 0;
+  bool dirtyPending_ = false;
+  uint32_t firstDirtyMs_ = 0;
+  uint32_t prefsWriteBackMs_ = MODEL_PREFS_WRITE_BACK_MS;
+  bool prefsPending_ = false;
+  uint32_t firstPrefsDirtyMs_ = 0;
+  PrefsStats prefsStats_ = PrefsStats();
+  PrefsFormat prefsFormat_ = MODEL_PREFS_MSGPACK ? PrefsFormat::MsgPack : PrefsFormat::Json;
+  bool graphBinary_ = MODEL_GRAPH_BINARY != 0;
+  GraphSeries graphSeries_[MODEL_MAX_GRAPH_SERIES];
+  size_t graphSeriesCount_ = 0;
+  uint32_t graphFlushMs_ = MODEL_GRAPH_FLUSH_MS;
+  GraphQueue* graphQueues_ = nullptr;  // MODEL_MAX_GRAPH_SERIES queues, only once batching is used
+  bool graphPending_ = false;
+  uint32_t firstGraphQueuedMs_ = 0;
+  GraphStats graphStats_ = GraphStats();
+  SlowClientPolicy slowClientPolicy_ = SlowClientPolicy::Coalesce;
+  size_t clientQueueLimit_ = MODEL_WS_QUEUE_LIMIT;
+  ClientStats clients_[MODEL_MAX_CLIENTS] = {};
+  uint32_t slowClientDisconnects_ = 0;
+  bool wsScan_ = MODEL_WS_SCAN != 0;
+  WsScanStats wsScanStats_ = WsScanStats();
+  WsMetrics wsMetrics_ = WsMetrics();
+  LogStream* logStream_ = nullptr;
+  AsyncWebServer* standaloneServer_ = nullptr;  // only after standalone()
   AsyncWebSocket ws_;
+
+  // Socket all frames go out on: ws_, or the shared socket of the WsHub the model was added to.
+  AsyncWebSocket* socket_;
+  WsHub* hub_ = nullptr;
+  const char* ns_ = nullptr;
+  uint16_t graphIdBase_ = 0;  // added to graph series ids on the wire, keeps them unique per hub
   Preferences prefs_;
 
   template <typename T>
-  void addEntry(const char* topic, T& obj, bool persist, bool wsSend);
+  bool addEntry(const char* topic, T& obj, bool persist, bool wsSend);
+  bool growTopics(size_t capacity);
 
   Entry* find(const char* topic);
+  Entry* findById(int32_t tid);
+  void indexEntry(size_t idx);
 
-  // SFINAE detector: does T::setSaveCallback(std::function<void()>) exist?
+  // SFINAE detector: does T::setSaveCallback(fj::Callback) exist?
   template <typename U>
   struct has_setSaveCallback;
 
   template <typename T>
-  typename std::enable_if<has_setSaveCallback<T>::value, void>::type maybeAttachSaveCallback(T& obj, Entry* ep);
+  typename std::enable_if<has_setSaveCallback<T>::value, void>::type maybeAttachSaveCallback(T& obj, uint16_t tid);
 
   template <typename T>
-  typename std::enable_if<!has_setSaveCallback<T>::value, void>::type maybeAttachSaveCallback(T&, Entry*);
+  typename std::enable_if<!has_setSaveCallback<T>::value, void>::type maybeAttachSaveCallback(T&, uint16_t);
+
+  static JsonDocument& envelopeDoc();
+  JsonDocument& buildEnvelope(Entry& e);
+  JsonDocument* buildPatchEnvelope(Entry& e, uint32_t since);
+  void markDirty(Entry& e);
+  void flushEntry(Entry& e);
+  void flushCoalesced();
+  void pollThrottled();
+  void flushPrefs();
+  void requestSave(Entry& e);
+  bool broadcastEntry(Entry& e);
+  bool broadcastEntryChanges(Entry& e);
 
   String makeEnvelope(Entry& e);
+  JsonDocument& buildPrefsDoc(Entry& e);
   String makeDataOnlyJson(Entry& e);
+  bool textAllJson(const JsonDocument& doc, Entry* topic = nullptr);
+
+  // Per-client fan-out with backpressure (Backpressure.h)
+  enum class FrameKind : uint8_t { Control, Topic, Graph };
+  static AsyncWebSocketSharedBuffer jsonBuffer(const JsonDocument& doc);
+  bool sendAll(const AsyncWebSocketSharedBuffer& buf, bool binary, FrameKind kind, Entry* topic);
+  bool sendToClient(AsyncWebSocketClient& c, const AsyncWebSocketSharedBuffer& buf, bool binary);
+  int clientSlot(uint32_t id) const;
+  void attachClient(AsyncWebSocketClient* client);
+  void detachClient(uint32_t id);
+  bool clientCongested(AsyncWebSocketClient& c) const;
+  bool noteCongestion(int slot, AsyncWebSocketClient& c, uint32_t now);
+  void serviceClients();
+  void syncClient(size_t slot, AsyncWebSocketClient& c);
+  void sendSnapshot(size_t slot, AsyncWebSocketClient& c);
+
+  int graphSeriesId(const char* graph, const char* label, bool& added);
+  void sendGraphSeries(AsyncWebSocketClient* client, size_t id);
+  void sendGraphPointJson(const char* graph, const char* label, uint64_t x, float y, bool synced);
+  bool allocGraphQueues();
+  void queueGraphPoint(size_t id, uint64_t x, float y, bool synced);
+  void announceGraphSeries(size_t id);
+  void flushGraphs();
+  void flushGraphSeries(size_t id);
+  static void encodeGraphFrame(uint8_t* out, uint16_t id, uint64_t x, float y, bool synced);
 
   bool saveEntry(Entry& e);
+  bool storePrefsPayload(Entry& e, const uint8_t* data, size_t len, bool binary);
+  PrefsFormat entryPrefsFormat(const Entry& e) const;
   bool loadEntry(Entry& e);
+  bool loadEntryBlob(Entry& e, PrefsFormat& stored, bool& outOfMemory);
   void loadOrInitAll();
 
   // -------- Writers: now use traits dispatch --------
@@ -122,14 +589,31 @@ private:
   template <typename T>
   static void makePrefsJsonImpl(void* objPtr, JsonObject out);
 
+  template <typename T>
+  static bool makeWsPatchJsonImpl(void* objPtr, JsonObject out, uint32_t since);
+
+  template <typename T>
+  static size_t writeBinaryPrefsImpl(void* objPtr, uint8_t* out, size_t cap);
+
+  template <typename T>
+  static bool readBinaryPrefsImpl(void* objPtr, const uint8_t* in, size_t len);
+
   template <typename T>
   static bool applyUpdateImpl(void* objPtr, const String& dataJson, bool strict);
 
   template <typename T>
   static bool applyUpdateJsonImpl(void* objPtr, JsonObject data, bool strict);
 
+  template <typename T>
+  static fj::ScanResult scanUpdateImpl(void* objPtr, const char* json, size_t len);
+
+  template <typename T>
+  static size_t pollThrottledImpl(void* objPtr);
+
   void onWsEvent(AsyncWebSocket*, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
   bool handleIncoming(AsyncWebSocketClient* client, const char* msg, size_t len);
+  Entry* scanIncoming(const char* msg, size_t len);
+  bool handleLogAction(AsyncWebSocketClient* client, const char* action, int level, bool backlog);
 
   // Handle button trigger requests (override in derived classes)
   virtual void handleButtonTrigger(AsyncWebSocketClient* client, const char* topic, const char* button);
@@ -143,5 +627,8 @@ private:
 #include "base/Topics.h"
 #include "base/Envelope.h"
 #include "base/PrefsStore.h"
+#include "base/Coalesce.h"
+#include "base/Backpressure.h"
 #include "base/TopicWriters.h"
 #include "base/WsHandler.h"
+#include "base/MetricsExport.h"
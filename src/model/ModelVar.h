@@ -14,3 +14,4 @@
 #include "var/Var.h"
 #include "var/VarAliases.h"
 #include "var/VarFieldIo.h"
+#include "var/VarPatch.h"
@@ -0,0 +1,305 @@
+#pragma once
+
+#include "ModelBase.h"
+
+// Models one hub can serve.
+#ifndef MODEL_HUB_MAX_MODELS
+#define MODEL_HUB_MAX_MODELS 4
+#endif
+
+// Longest namespace name (including the terminator).
+#ifndef MODEL_HUB_NS_LEN
+#define MODEL_HUB_NS_LEN 16
+#endif
+
+// Reassembly buffer for text messages that arrive in several WS_EVT_DATA chunks (shared by all
+// clients; a message is dropped if a chunk of another client interleaves or it does not fit).
+#ifndef MODEL_HUB_RX_LEN
+#define MODEL_HUB_RX_LEN 1024
+#endif
+
+// Interval of the connection-level keepalive in WsHub::loop(): ping every client and release
+// closed ones. 0 = off.
+#ifndef MODEL_HUB_PING_MS
+#define MODEL_HUB_PING_MS 15000
+#endif
+
+// ============================================================================
+// WsHub: several ModelBase instances on one WebSocket endpoint
+// ============================================================================
+// Each browser tab holds one connection instead of one per model. The models keep their topics,
+// Preferences and client accounting; the hub owns the socket, routes incoming messages and
+// keeps the connections alive.
+//
+//   WsHub hub("/ws");
+//   hub.add(adminModel, nullptr);  // default model: frames without "ns", as on its own socket
+//   hub.add(userModel, "user");    // {"ns":"user","topic":..,"tid":..,"data":..}
+//   hub.attachTo(server);
+//   adminModel.begin(); userModel.begin();
+//   loop(): hub.loop(); adminModel.loop(); userModel.loop();
+//
+// A client picks its models with ?ns=<list> on the WebSocket URL or a {"action":"subscribe",
+// "ns":<list>} message ("action" first); <list> is comma separated, an empty name is the default
+// model ("?ns=" = default only, "?ns=,user" = both). Without either it gets every model, as pages
+// that predate namespaces expect. Models only track, snapshot and broadcast to their own clients.
+//
+// Incoming messages go to the model named by their "ns" member, messages without one to the
+// default model; models the client did not subscribe to reject them. Graph series ids are offset
+// per model (MODEL_MAX_GRAPH_SERIES each), so binary graph frames stay unambiguous. A slow client
+// closed by one model (SlowClientPolicy::Disconnect) is gone for all of them.
+
+static_assert(MODEL_HUB_MAX_MODELS * MODEL_MAX_GRAPH_SERIES <= 0x10000, "Graph series ids on the wire are 16 bit");
+static_assert(MODEL_HUB_MAX_MODELS <= 32, "Subscriptions hold one bit per model");
+
+class WsHub {
+public:
+  explicit WsHub(const char* path = "/ws");
+  WsHub(const WsHub&) = delete;
+  WsHub& operator=(const WsHub&) = delete;
+
+  // Serve `model` on this hub. ns == nullptr makes it the default model (at most one).
+  // Call before the model's begin() and attachTo(). false: hub full, namespace taken or invalid,
+  // or the model is already on a hub.
+  bool add(ModelBase& model, const char* ns);
+
+  // Register the shared socket with the server. Call once before server.begin().
+  void attachTo(AsyncWebServer& server);
+
+  // Connection-level keepalive (MODEL_HUB_PING_MS). The models still need their own loop().
+  void loop();
+
+  const char* path() const { return path_; }
+  size_t modelCount() const { return count_; }
+  AsyncWebSocket& socket() { return ws_; }
+
+  struct Stats {
+    uint32_t routed;       // messages handed to a model
+    uint32_t unknownNs;    // messages naming a namespace no model uses
+    uint32_t unsubscribed; // messages for a model the client did not subscribe to
+    uint32_t reassembled;  // messages put together from several chunks
+    uint32_t dropped;      // chunked messages that did not fit / were interleaved
+    uint32_t pings;        // keepalive rounds
+  };
+
+  const Stats& stats() const { return stats_; }
+
+#ifdef TEST_BUILD
+  // Test hook: route a text message as if `client` had sent it.
+  bool testRoute(AsyncWebSocketClient* client, const char* msg, size_t len) { return route(client, msg, len); }
+#endif
+
+private:
+  struct Slot {
+    ModelBase* model;
+    const char* ns;
+  };
+
+  const char* path_;
+  AsyncWebSocket ws_;
+  Slot slots_[MODEL_HUB_MAX_MODELS] = {};
+  size_t count_ = 0;
+  Stats stats_ = Stats();
+  uint32_t lastPingMs_ = 0;
+
+  char rx_[MODEL_HUB_RX_LEN];
+  size_t rxLen_ = 0;
+  uint32_t rxClient_ = 0;  // 0 = no message being reassembled
+
+  void onEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+  void onData(AsyncWebSocketClient* client, const AwsFrameInfo& info, const char* data, size_t len);
+  bool route(AsyncWebSocketClient* client, const char* msg, size_t len);
+  int findSlot(const char* ns) const;
+  ModelBase* findModel(const char* ns);
+  uint32_t selectModels(const char* list) const;
+  void subscribe(AsyncWebSocketClient* client, uint32_t mask);
+};
+
+inline WsHub::WsHub(const char* path) : path_(path ? path : "/ws"), ws_(path_) {
+  ws_.onEvent([this](AsyncWebSocket*, AsyncWebSocketClient* c, AwsEventType t, void* a, uint8_t* d, size_t l) {
+    this->onEvent(c, t, a, d, l);
+  });
+}
+
+inline bool WsHub::add(ModelBase& model, const char* ns) {
+  if (model.hub_ || count_ >= MODEL_HUB_MAX_MODELS) {
+    LOG_ERROR_F("[Hub] Cannot add model '%s': %s", ns ? ns : "(default)", model.hub_ ? "already on a hub" : "hub full");
+    return false;
+  }
+  if ((ns && (!ns[0] || strlen(ns) >= MODEL_HUB_NS_LEN)) || findModel(ns)) {
+    LOG_ERROR_F("[Hub] Cannot add model '%s': namespace invalid or taken", ns ? ns : "(default)");
+    return false;
+  }
+  if (strcmp(model.wsPath_, path_) != 0) {
+    LOG_WARN_F("[Hub] Model '%s' moves from %s to %s, its own path is no longer served", ns ? ns : "(default)",
+               model.wsPath_, path_);
+  }
+  model.hub_ = this;
+  model.socket_ = &ws_;
+  model.ns_ = ns;
+  model.graphIdBase_ = (uint16_t)(count_ * MODEL_MAX_GRAPH_SERIES);
+  slots_[count_].model = &model;
+  slots_[count_].ns = ns;
+  count_++;
+  LOG_DEBUG_F("[Hub] Model '%s' served on %s", ns ? ns : "(default)", path_);
+  return true;
+}
+
+inline void WsHub::attachTo(AsyncWebServer& server) {
+  server.addHandler(&ws_);
+}
+
+inline void WsHub::loop() {
+  if (MODEL_HUB_PING_MS == 0) return;
+  const uint32_t now = millis();
+  if ((uint32_t)(now - lastPingMs_) < (uint32_t)MODEL_HUB_PING_MS) return;
+  lastPingMs_ = now;
+  ws_.cleanupClients();
+  if (ws_.count() == 0) return;
+  ws_.pingAll();
+  stats_.pings++;
+}
+
+inline int WsHub::findSlot(const char* ns) const {
+  for (size_t i = 0; i < count_; ++i) {
+    const char* slotNs = slots_[i].ns;
+    if (ns ? (slotNs && strcmp(slotNs, ns) == 0) : !slotNs) return (int)i;
+  }
+  return -1;
+}
+
+inline ModelBase* WsHub::findModel(const char* ns) {
+  const int slot = findSlot(ns);
+  return slot < 0 ? nullptr : slots_[slot].model;
+}
+
+// One bit per model named in a comma separated list ("" = default model); unknown names are
+// logged and skipped.
+inline uint32_t WsHub::selectModels(const char* list) const {
+  uint32_t mask = 0;
+  for (const char* p = list;;) {
+    const char* end = strchr(p, ',');
+    const size_t n = end ? (size_t)(end - p) : strlen(p);
+    char ns[MODEL_HUB_NS_LEN];
+    int slot = -1;
+    if (n < sizeof(ns)) {
+      memcpy(ns, p, n);
+      ns[n] = '\0';
+      slot = findSlot(n ? ns : nullptr);
+    }
+    if (slot >= 0) {
+      mask |= 1u << slot;
+    } else {
+      LOG_WARN_F("[Hub] No model for namespace '%.*s'", (int)n, p);
+    }
+    if (!end) return mask;
+    p = end + 1;
+  }
+}
+
+// Attach the client to the selected models (their loop() sends the snapshot) and detach it from
+// the others, as if it had connected to / disconnected from their own sockets.
+inline void WsHub::subscribe(AsyncWebSocketClient* client, uint32_t mask) {
+  for (size_t i = 0; i < count_; ++i) {
+    ModelBase& m = *slots_[i].model;
+    const bool attached = m.clientSlot(client->id()) >= 0;
+    const bool wanted = mask & (1u << i);
+    if (wanted == attached) continue;
+    m.onWsEvent(&ws_, client, wanted ? WS_EVT_CONNECT : WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+  }
+}
+
+inline void WsHub::onEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+  if (type == WS_EVT_CONNECT) {
+    // arg is the upgrade request; its ?ns= picks the models, without it the client gets all.
+    const AsyncWebServerRequest* request = (const AsyncWebServerRequest*)arg;
+    const AsyncWebParameter* ns = request ? request->getParam("ns") : nullptr;
+    const uint32_t all = count_ >= 32 ? 0xFFFFFFFFu : (1u << count_) - 1;
+    subscribe(client, ns ? selectModels(ns->value().c_str()) : all);
+    return;
+  }
+  if (type == WS_EVT_DISCONNECT) {
+    if (rxClient_ == client->id()) rxClient_ = 0;
+    for (size_t i = 0; i < count_; ++i) slots_[i].model->onWsEvent(&ws_, client, type, arg, data, len);
+    return;
+  }
+  if (type != WS_EVT_DATA) return;
+  onData(client, *(AwsFrameInfo*)arg, (const char*)data, len);
+}
+
+inline void WsHub::onData(AsyncWebSocketClient* client, const AwsFrameInfo& info, const char* data, size_t len) {
+  // Common case: the whole message in one chunk, routed straight from the socket buffer.
+  if (info.final && info.index == 0 && info.len == len) {
+    if (info.opcode == WS_TEXT) (void)route(client, data, len);
+    return;
+  }
+
+  // Single frame split over several chunks (info.index advances); fragmented messages (several
+  // frames) are not reassembled.
+  if (info.opcode != WS_TEXT || info.num != 0) return;
+  if (info.index == 0) {
+    if (rxClient_ != 0) stats_.dropped++;  // a started message of another client is abandoned
+    rxClient_ = client->id();
+    rxLen_ = 0;
+  }
+  if (rxClient_ != client->id() || info.index != rxLen_) return;
+  if (info.len > sizeof(rx_) || rxLen_ + len > sizeof(rx_)) {
+    LOG_WARN_F("[Hub] Message of %u bytes exceeds MODEL_HUB_RX_LEN, dropped", (unsigned)info.len);
+    stats_.dropped++;
+    rxClient_ = 0;
+    return;
+  }
+  memcpy(rx_ + rxLen_, data, len);
+  rxLen_ += len;
+  if (!info.final || rxLen_ < info.len) return;
+
+  rxClient_ = 0;
+  stats_.reassembled++;
+  (void)route(client, rx_, rxLen_);
+}
+
+// Finds the "ns" member (top level only) and hands the message to that model, or takes a
+// subscribe request ("action" in front of "ns"). Malformed JSON goes to the default model, which
+// reports it to the client.
+inline bool WsHub::route(AsyncWebSocketClient* client, const char* msg, size_t len) {
+  fj::JsonScanner sc(msg, len);
+  char key[8];
+  char action[12];
+  char ns[MODEL_HUB_MAX_MODELS * MODEL_HUB_NS_LEN];  // a subscribe list names several models
+  bool haveNs = false;
+  bool subscribing = false;
+  size_t n = 0;
+  if (sc.beginObject()) {
+    while (!haveNs && sc.nextKey(key, sizeof(key), &n)) {
+      if (n == 2 && strcmp(key, "ns") == 0 && sc.peek() == fj::JsonScanner::Kind::String) {
+        haveNs = sc.readString(ns, sizeof(ns), &n);
+        if (haveNs && n >= sizeof(ns)) ns[0] = '\0';  // too long: matches no model
+      } else if (n == 6 && strcmp(key, "action") == 0 && sc.peek() == fj::JsonScanner::Kind::String) {
+        subscribing = sc.readString(action, sizeof(action), &n) && n < sizeof(action) &&
+                      strcmp(action, "subscribe") == 0;
+      } else if (!sc.skipValue()) {
+        break;
+      }
+    }
+  }
+
+  if (subscribing && haveNs && client) {
+    subscribe(client, selectModels(ns));
+    client->text(R"({"ok":true})");
+    return true;
+  }
+
+  ModelBase* model = findModel(haveNs ? ns : nullptr);
+  if (!model) {
+    LOG_WARN_F("[Hub] No model for namespace '%s'", haveNs ? ns : "(default)");
+    stats_.unknownNs++;
+    if (client) client->text(R"({"ok":false,"error":"unknown_ns"})");
+    return false;
+  }
+  if (client && model->clientSlot(client->id()) < 0) {
+    stats_.unsubscribed++;
+    client->text(R"({"ok":false,"error":"not_subscribed"})");
+    return false;
+  }
+  stats_.routed++;
+  return model->handleIncoming(client, msg, len);
+}
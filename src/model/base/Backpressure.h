@@ -0,0 +1,214 @@
+#pragma once
+
+// Included by src/model/ModelBase.h
+// Per-client fan-out of WS frames with queue accounting (see SlowClientPolicy). Every broadcast
+// is serialized once into a shared buffer and handed to each client that can take it.
+
+static_assert(MODEL_MAX_CLIENTS <= 32, "Entry::staleClients holds one bit per client slot");
+
+inline AsyncWebSocketSharedBuffer ModelBase::jsonBuffer(const JsonDocument& doc) {
+  const size_t len = measureJson(doc);
+  AsyncWebSocketSharedBuffer buf = std::make_shared<std::vector<uint8_t>>(len);
+  const size_t written = serializeJson(doc, (char*)buf->data(), len);
+  if (written != len) {
+    LOG_WARN_F("[WS] Envelope serialization mismatch (%u of %u bytes)", (unsigned)written, (unsigned)len);
+    return AsyncWebSocketSharedBuffer();
+  }
+  return buf;
+}
+
+inline bool ModelBase::sendToClient(AsyncWebSocketClient& c, const AsyncWebSocketSharedBuffer& buf, bool binary) {
+  if (!(binary ? c.binary(buf) : c.text(buf))) {
+    wsMetrics_.outDrops++;
+    return false;
+  }
+  wsMetrics_.outFrames++;
+  wsMetrics_.outBytes += buf->size();
+  return true;
+}
+
+inline bool ModelBase::sendAll(const AsyncWebSocketSharedBuffer& buf, bool binary, FrameKind kind, Entry* topic) {
+  if (!buf) return false;
+  LOG_TRACE_F("[WS] sendAll %u bytes (%s)", (unsigned)buf->size(), binary ? "binary" : "text");
+
+  const bool holdBack = slowClientPolicy_ != SlowClientPolicy::DropGraphs && kind == FrameKind::Topic && topic;
+  const uint32_t now = millis();
+  for (AsyncWebSocketClient& c : socket_->getClients()) {
+    if (c.status() != WS_CONNECTED) continue;
+
+    const int slot = clientSlot(c.id());
+    if (slot < 0) {
+      // On a hub: a client of other namespaces only (WsHub::subscribe()). Otherwise it connected
+      // before begin() and was never announced, so there is nothing to account against. Clients
+      // refused by attachClient() are already closing and fail the status check above.
+      if (!hub_) sendToClient(c, buf, binary);
+      continue;
+    }
+
+    ClientStats& st = clients_[slot];
+    if (st.snapshotPending) continue;  // the snapshot from loop() carries the latest state
+    const uint32_t bit = 1u << slot;
+    if (noteCongestion(slot, c, now)) continue;  // closed
+
+    if (kind == FrameKind::Graph && st.congested) {
+      st.droppedGraph++;
+      wsMetrics_.outDrops++;
+      continue;
+    }
+    if (holdBack && (st.congested || (topic->staleClients & bit))) {
+      // The next full state replaces this frame (and any patch it would have carried).
+      topic->staleClients |= bit;
+      st.coalesced++;
+      continue;
+    }
+
+    if (sendToClient(c, buf, binary)) {
+      st.sent++;
+      continue;
+    }
+    if (kind == FrameKind::Graph) {
+      st.droppedGraph++;
+    } else {
+      st.failed++;
+      // Whatever the policy: a lost patch would leave the client wrong until the field changes
+      // again, so serviceClients() sends the full state instead.
+      if (kind == FrameKind::Topic && topic) topic->staleClients |= bit;
+    }
+  }
+  return true;
+}
+
+inline int ModelBase::clientSlot(uint32_t id) const {
+  for (size_t i = 0; i < MODEL_MAX_CLIENTS; ++i) {
+    if (clients_[i].active && clients_[i].id == id) return (int)i;
+  }
+  return -1;
+}
+
+inline void ModelBase::attachClient(AsyncWebSocketClient* client) {
+  if (!client || clientSlot(client->id()) >= 0) return;
+  for (size_t i = 0; i < MODEL_MAX_CLIENTS; ++i) {
+    if (clients_[i].active) continue;
+    clients_[i] = ClientStats();
+    clients_[i].id = client->id();
+    clients_[i].snapshotPending = true;
+    clients_[i].active = true;  // last: loop() skips the slot until it is filled in
+    return;
+  }
+  // Without a slot there is no way to resend what AsyncTCP refuses, so the client is not served.
+  LOG_WARN_F("[WS] Refusing client %u, MODEL_MAX_CLIENTS (%u) reached", (unsigned)client->id(),
+             (unsigned)MODEL_MAX_CLIENTS);
+  client->close();
+}
+
+inline void ModelBase::detachClient(uint32_t id) {
+  const int slot = clientSlot(id);
+  if (slot < 0) return;
+  clients_[slot].active = false;
+  const uint32_t mask = ~(1u << slot);
+  for (size_t i = 0; i < entryCount_; ++i) entries_[i].staleClients &= mask;
+}
+
+inline bool ModelBase::clientCongested(AsyncWebSocketClient& c) const {
+  return c.queueIsFull() || c.queueLen() >= clientQueueLimit_;
+}
+
+// Updates the congestion state of a tracked client; returns true if the client was closed.
+inline bool ModelBase::noteCongestion(int slot, AsyncWebSocketClient& c, uint32_t now) {
+  ClientStats& st = clients_[slot];
+  st.congested = clientCongested(c);
+  if (!st.congested) {
+    st.congestedSinceMs = 0;
+    return false;
+  }
+  if (st.congestedSinceMs == 0) {
+    st.congestedSinceMs = now ? now : 1;
+    LOG_DEBUG_F("[WS] Client %u congested (%u frames queued)", (unsigned)c.id(), (unsigned)c.queueLen());
+  }
+  if (slowClientPolicy_ != SlowClientPolicy::Disconnect) return false;
+  if ((uint32_t)(now - st.congestedSinceMs) < (uint32_t)MODEL_WS_DISCONNECT_AFTER_MS) return false;
+
+  LOG_WARN_F("[WS] Closing client %u: congested for %u ms", (unsigned)c.id(), (unsigned)(now - st.congestedSinceMs));
+  c.close();
+  slowClientDisconnects_++;
+  detachClient(c.id());
+  return true;
+}
+
+// loop(): send the initial state to new clients, catch up clients that drained, close the ones
+// that did not (Disconnect policy). All serialization for tracked clients happens here, on the
+// loop task, never in the AsyncTCP event handler.
+inline void ModelBase::serviceClients() {
+  const uint32_t now = millis();
+  for (size_t slot = 0; slot < MODEL_MAX_CLIENTS; ++slot) {
+    if (!clients_[slot].active) continue;
+    AsyncWebSocketClient* c = socket_->client(clients_[slot].id);
+    if (!c) {
+      detachClient(clients_[slot].id);
+      continue;
+    }
+    if (noteCongestion((int)slot, *c, now) || clients_[slot].congested) continue;
+    if (clients_[slot].snapshotPending) sendSnapshot(slot, *c);
+    syncClient(slot, *c);
+  }
+}
+
+// Send the full state of every topic marked stale for this client, in registration order,
+// until its queue reaches the limit; the rest follows from the next loop().
+inline void ModelBase::syncClient(size_t slot, AsyncWebSocketClient& c) {
+  const uint32_t bit = 1u << slot;
+  for (size_t i = 0; i < entryCount_; ++i) {
+    Entry& e = entries_[i];
+    if (!(e.staleClients & bit)) continue;
+    if (clientCongested(c)) break;
+    AsyncWebSocketSharedBuffer buf = jsonBuffer(buildEnvelope(e));
+    if (!buf || !sendToClient(c, buf, false)) {
+      clients_[slot].failed++;
+      break;
+    }
+    e.staleClients &= ~bit;
+    clients_[slot].sent++;
+    LOG_TRACE_F("[WS] Client %u synced topic '%s'", (unsigned)c.id(), e.topic);
+  }
+}
+
+// Initial state for a newly attached client only (the other clients are not touched): its graph
+// series ids, then every topic marked stale for syncClient().
+inline void ModelBase::sendSnapshot(size_t slot, AsyncWebSocketClient& c) {
+  clients_[slot].snapshotPending = false;
+  for (size_t i = 0; i < graphSeriesCount_; ++i) sendGraphSeries(&c, i);
+
+  const uint32_t bit = 1u << slot;
+  for (size_t i = 0; i < entryCount_; ++i) {
+    if (entries_[i].ws_send) entries_[i].staleClients |= bit;
+  }
+}
+
+inline void ModelBase::writeClientStats(JsonObject out) {
+  static const char* const policyNames[] = {"drop_graphs", "coalesce", "disconnect"};
+  out["policy"] = policyNames[(uint8_t)slowClientPolicy_];
+  out["queue_limit"] = (unsigned)clientQueueLimit_;
+  out["disconnects"] = slowClientDisconnects_;
+
+  uint32_t sent = 0, droppedGraph = 0, coalesced = 0, failed = 0;
+  JsonArray list = out.createNestedArray("clients");
+  for (size_t slot = 0; slot < MODEL_MAX_CLIENTS; ++slot) {
+    const ClientStats& st = clients_[slot];
+    if (!st.active) continue;
+    sent += st.sent;
+    droppedGraph += st.droppedGraph;
+    coalesced += st.coalesced;
+    failed += st.failed;
+
+    AsyncWebSocketClient* c = socket_->client(st.id);
+    char line[96];
+    snprintf(line, sizeof(line), "#%u q=%u sent=%u drop=%u coal=%u fail=%u%s", (unsigned)st.id,
+             c ? (unsigned)c->queueLen() : 0u, (unsigned)st.sent, (unsigned)st.droppedGraph, (unsigned)st.coalesced,
+             (unsigned)st.failed, st.congested ? " congested" : "");
+    list.add(line);  // copied into the document
+  }
+  out["sent"] = sent;
+  out["dropped_graph"] = droppedGraph;
+  out["coalesced"] = coalesced;
+  out["failed"] = failed;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+// Included by src/model/ModelBase.h
+// Dirty tracking for auto-persist/broadcast: coalesces bursts of Var changes into one
+// save + one broadcast per topic. Saves then go through requestSave(), which may defer
+// them further (Preferences write-back, see PrefsStore.h). loop()/flush() also send batched
+// graph points (see GraphWs.h); loop() catches up slow WS clients (see Backpressure.h) and
+// delivers held-back changes of fj::Throttle<> fields.
+
+inline void ModelBase::markDirty(Entry& e) {
+  e.dirtySave = e.dirtySave || e.persist;
+  e.dirtyWs = e.dirtyWs || e.ws_send;
+
+  if (batchDepth_ == 0 && coalesceWindowMs_ < 0) {
+    flushEntry(e);
+    return;
+  }
+
+  if (!dirtyPending_) {
+    dirtyPending_ = true;
+    firstDirtyMs_ = millis();
+  }
+  LOG_TRACE_F("[Model] Topic '%s' marked dirty (save=%d ws=%d)", e.topic, (int)e.dirtySave, (int)e.dirtyWs);
+}
+
+inline void ModelBase::flushEntry(Entry& e) {
+  if (e.dirtySave) requestSave(e);
+  if (e.dirtyWs) (void)broadcastEntryChanges(e);
+}
+
+inline void ModelBase::flushCoalesced() {
+  if (!dirtyPending_) return;
+  dirtyPending_ = false;
+  for (size_t i = 0; i < entryCount_; ++i) {
+    flushEntry(entries_[i]);
+  }
+}
+
+inline void ModelBase::flush() {
+  flushGraphs();
+  flushCoalesced();
+  if (prefsPending_) flushPrefs();
+}
+
+inline void ModelBase::discardPending() {
+  for (size_t i = 0; i < entryCount_; ++i) {
+    entries_[i].dirtySave = false;
+    entries_[i].dirtyWs = false;
+    entries_[i].savePending = false;
+  }
+  dirtyPending_ = false;
+  prefsPending_ = false;
+}
+
+// Trailing edge of throttled fields: the notification marks the topic dirty like a set() would.
+inline void ModelBase::pollThrottled() {
+  for (size_t i = 0; i < entryCount_; ++i) {
+    Entry& e = entries_[i];
+    if (e.pollThrottled) (void)e.pollThrottled(e.objPtr);
+  }
+}
+
+inline void ModelBase::loop() {
+  const uint32_t now = millis();
+  serviceClients();
+  if (throttledTopics_ > 0) pollThrottled();
+  if (logStream_) logStream_->loop(*socket_);
+  if (graphPending_ && (uint32_t)(now - firstGraphQueuedMs_) >= graphFlushMs_) {
+    flushGraphs();
+  }
+  if (batchDepth_ > 0) return;
+  if (dirtyPending_ && (coalesceWindowMs_ <= 0 || (uint32_t)(now - firstDirtyMs_) >= (uint32_t)coalesceWindowMs_)) {
+    flushCoalesced();
+  }
+  if (prefsPending_ && (uint32_t)(now - firstPrefsDirtyMs_) >= prefsWriteBackMs_) {
+    flushPrefs();
+  }
+}
@@ -2,13 +2,41 @@
 
 // Included by src/model/ModelBase.h
 
-inline String ModelBase::makeEnvelope(Entry& e) {
-  static StaticJsonDocument<JSON_CAPACITY> doc;  // reuse to keep allocations off stack
+// Shared by full and patch envelopes: one BSS buffer, never on the stack.
+inline JsonDocument& ModelBase::envelopeDoc() {
+  static StaticJsonDocument<JSON_CAPACITY> doc;
+  return doc;
+}
+
+inline JsonDocument& ModelBase::buildEnvelope(Entry& e) {
+  JsonDocument& doc = envelopeDoc();
   doc.clear();
+  if (ns_) doc["ns"] = ns_;
   doc["topic"] = e.topic;
+  doc["tid"] = e.tid;
 
   JsonObject data = doc.createNestedObject("data");
   e.makeWsJson(e.objPtr, data);
+  return doc;
+}
+
+// {"topic":..,"tid":..,"patch":{changed fields}} ("ns" first on a namespaced hub model). Returns nullptr if nothing changed since `since`,
+// or the full envelope if the topic type cannot be patched.
+inline JsonDocument* ModelBase::buildPatchEnvelope(Entry& e, uint32_t since) {
+  JsonDocument& doc = envelopeDoc();
+  doc.clear();
+  if (ns_) doc["ns"] = ns_;
+  doc["topic"] = e.topic;
+  doc["tid"] = e.tid;
+
+  JsonObject patch = doc.createNestedObject("patch");
+  if (!e.makeWsPatchJson(e.objPtr, patch, since)) return &buildEnvelope(e);
+  if (patch.size() == 0) return nullptr;
+  return &doc;
+}
+
+inline String ModelBase::makeEnvelope(Entry& e) {
+  JsonDocument& doc = buildEnvelope(e);
 
   String out;
   out.reserve(measureJson(doc) + 1);
@@ -16,8 +44,8 @@ inline String ModelBase::makeEnvelope(Entry& e) {
   return out;
 }
 
-inline String ModelBase::makeDataOnlyJson(Entry& e) {
-  LOG_TRACE_F("[ModelBase] makeDataOnlyJson starting for topic '%s'", e.topic);
+// Prefs payload document (shared by the JSON and MessagePack encodings).
+inline JsonDocument& ModelBase::buildPrefsDoc(Entry& e) {
   static StaticJsonDocument<JSON_CAPACITY> doc;  // reuse to keep allocations off stack
   doc.clear();
   JsonObject data = doc.to<JsonObject>();
@@ -25,6 +53,12 @@ inline String ModelBase::makeDataOnlyJson(Entry& e) {
   LOG_TRACE_F("[ModelBase] Calling makePrefsJson for topic '%s'", e.topic);
   e.makePrefsJson(e.objPtr, data);
   LOG_TRACE_F("[ModelBase] makePrefsJson completed");
+  return doc;
+}
+
+inline String ModelBase::makeDataOnlyJson(Entry& e) {
+  LOG_TRACE_F("[ModelBase] makeDataOnlyJson starting for topic '%s'", e.topic);
+  JsonDocument& doc = buildPrefsDoc(e);
 
   String out;
   out.reserve(measureJson(doc) + 1);
@@ -32,3 +66,12 @@ inline String ModelBase::makeDataOnlyJson(Entry& e) {
   LOG_TRACE_F("[ModelBase] makeDataOnlyJson result: %s", out.c_str());
   return out;
 }
+
+// Serialize once into a buffer shared by all clients (no intermediate String, one allocation per
+// broadcast regardless of client count). `topic` marks topic frames for the slow-client policy.
+inline bool ModelBase::textAllJson(const JsonDocument& doc, Entry* topic) {
+  AsyncWebSocketSharedBuffer buf = jsonBuffer(doc);
+  if (!buf) return false;
+  LOG_TRACE_F("[WS] textAll %u bytes: %.*s", (unsigned)buf->size(), (int)buf->size(), (const char*)buf->data());
+  return sendAll(buf, false, topic ? FrameKind::Topic : FrameKind::Control, topic);
+}
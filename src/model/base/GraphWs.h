@@ -3,9 +3,36 @@
 // Included by src/model/ModelBase.h
 // WebSocket-side graph publishing helpers (transport/protocol), not the data container.
 
+#include <new>
+
 inline void ModelBase::sendGraphPointXY(const char* graph, const char* label, uint64_t x, float y, bool synced) {
   LOG_DEBUG_F("[WS] Sending graph_point: graph=%s, label=%s, x=%llu, y=%.2f", graph, label, x, y);
+  if (socket_->count() == 0) return;
+  graphStats_.points++;
+
+  bool added = false;
+  const int id = (graphBinary_ || graphFlushMs_ > 0) ? graphSeriesId(graph, label, added) : -1;
+  if (id < 0) {
+    // JSON mode, or series table full: this series keeps using the JSON frame.
+    sendGraphPointJson(graph, label, x, y, synced);
+    return;
+  }
+
+  if (graphFlushMs_ > 0 && allocGraphQueues()) {
+    queueGraphPoint((size_t)id, x, y, synced);
+    return;
+  }
+
+  announceGraphSeries((size_t)id);
+  AsyncWebSocketSharedBuffer frame = std::make_shared<std::vector<uint8_t>>(GRAPH_FRAME_SIZE);
+  encodeGraphFrame(frame->data(), (uint16_t)(graphIdBase_ + id), x, y, synced);
+  (void)sendAll(frame, true, FrameKind::Graph, nullptr);
+  graphStats_.frames++;
+}
+
+inline void ModelBase::sendGraphPointJson(const char* graph, const char* label, uint64_t x, float y, bool synced) {
   StaticJsonDocument<256> doc;
+  if (ns_) doc["ns"] = ns_;
   doc["topic"] = "graph_point";
   JsonObject d = doc.createNestedObject("data");
   d["graph"] = graph;
@@ -14,11 +41,183 @@ inline void ModelBase::sendGraphPointXY(const char* graph, const char* label, ui
   d["y"] = y;
   d["synced"] = synced;
 
-  String out;
-  out.reserve(measureJson(doc) + 1);
-  serializeJson(doc, out);
-  LOG_TRACE_F("[WS] Graph point JSON: %s", out.c_str());
-  ws_.textAll(out);
+  AsyncWebSocketSharedBuffer buf = jsonBuffer(doc);
+  if (buf) (void)sendAll(buf, false, FrameKind::Graph, nullptr);
+  graphStats_.frames++;
+}
+
+// Returns the series id for (graph, label), assigning the next free one if needed; -1 if the table is full.
+inline int ModelBase::graphSeriesId(const char* graph, const char* label, bool& added) {
+  added = false;
+  if (!graph) graph = "";
+  if (!label) label = "";
+  for (size_t i = 0; i < graphSeriesCount_; ++i) {
+    const GraphSeries& s = graphSeries_[i];
+    if ((s.graph == graph || strcmp(s.graph, graph) == 0) && (s.label == label || strcmp(s.label, label) == 0)) {
+      return (int)i;
+    }
+  }
+  if (graphSeriesCount_ >= MODEL_MAX_GRAPH_SERIES) {
+    LOG_WARN_F("[WS] Graph series table full (%u), sending %s/%s as JSON", (unsigned)MODEL_MAX_GRAPH_SERIES, graph,
+               label);
+    return -1;
+  }
+  GraphSeries& s = graphSeries_[graphSeriesCount_];
+  s.graph = graph;
+  s.label = label;
+  s.announced = false;
+  s.synced = false;
+  s.head = 0;
+  s.count = 0;
+  added = true;
+  return (int)graphSeriesCount_++;
+}
+
+inline void ModelBase::announceGraphSeries(size_t id) {
+  if (graphSeries_[id].announced) return;
+  graphSeries_[id].announced = true;
+  sendGraphSeries(nullptr, id);
+}
+
+// Announce a series id: to one client (on connect) or to all clients (client == nullptr).
+inline void ModelBase::sendGraphSeries(AsyncWebSocketClient* client, size_t id) {
+  if (id >= graphSeriesCount_) return;
+  StaticJsonDocument<192> doc;
+  if (ns_) doc["ns"] = ns_;
+  doc["topic"] = "graph_series";
+  JsonObject d = doc.createNestedObject("data");
+  d["id"] = (unsigned)(graphIdBase_ + id);
+  d["graph"] = graphSeries_[id].graph;
+  d["label"] = graphSeries_[id].label;
+
+  if (!client) {
+    (void)textAllJson(doc);
+    return;
+  }
+  char buf[160];
+  const size_t len = serializeJson(doc, buf, sizeof(buf));
+  if (len == 0 || len >= sizeof(buf)) {
+    LOG_WARN_F("[WS] graph_series announcement for id %u does not fit", (unsigned)id);
+    return;
+  }
+  client->text(buf, len);
+}
+
+inline void ModelBase::encodeGraphFrame(uint8_t* out, uint16_t id, uint64_t x, float y, bool synced) {
+  uint32_t ybits = 0;
+  memcpy(&ybits, &y, sizeof(ybits));
+
+  out[0] = GRAPH_FRAME_V1;
+  out[1] = synced ? 0x01 : 0x00;
+  out[2] = (uint8_t)(id & 0xFF);
+  out[3] = (uint8_t)(id >> 8);
+  for (int i = 0; i < 8; ++i) out[4 + i] = (uint8_t)(x >> (8 * i));
+  for (int i = 0; i < 4; ++i) out[12 + i] = (uint8_t)(ybits >> (8 * i));
+}
+
+// ---- Batching (graph flush interval > 0) ----
+
+inline void ModelBase::setGraphFlushIntervalMs(uint32_t ms) {
+  graphFlushMs_ = ms;
+  if (ms > 0) (void)allocGraphQueues();
+}
+
+// Queues stay unallocated while every point is sent immediately; they cost
+// MODEL_MAX_GRAPH_SERIES * MODEL_GRAPH_QUEUE_LEN * 12 bytes once batching is on.
+inline bool ModelBase::allocGraphQueues() {
+  if (graphQueues_) return true;
+  graphQueues_ = new (std::nothrow) GraphQueue[MODEL_MAX_GRAPH_SERIES];
+  if (!graphQueues_) {
+    LOG_WARN("[WS] Could not allocate graph queues, sending points unbatched");
+    return false;
+  }
+  return true;
+}
+
+inline void ModelBase::queueGraphPoint(size_t id, uint64_t x, float y, bool synced) {
+  GraphSeries& s = graphSeries_[id];
+  GraphQueue& q = graphQueues_[id];
+  if (s.count == MODEL_GRAPH_QUEUE_LEN) {
+    // Backlog full: keep the newest points, a slow flush must not grow memory.
+    s.head = (uint16_t)((s.head + 1) % MODEL_GRAPH_QUEUE_LEN);
+    s.count--;
+    graphStats_.dropped++;
+  }
+  const size_t idx = (s.head + s.count) % MODEL_GRAPH_QUEUE_LEN;
+  q.xs[idx] = x;
+  q.ys[idx] = y;
+  s.count++;
+  s.synced = synced;
+
+  if (!graphPending_) {
+    graphPending_ = true;
+    firstGraphQueuedMs_ = millis();
+  }
+}
+
+inline void ModelBase::flushGraphs() {
+  if (!graphPending_) return;
+  graphPending_ = false;
+  for (size_t i = 0; i < graphSeriesCount_; ++i) {
+    if (graphSeries_[i].count == 0) continue;
+    if (socket_->count() > 0) flushGraphSeries(i);
+    graphSeries_[i].head = 0;
+    graphSeries_[i].count = 0;
+  }
+}
+
+inline void ModelBase::flushGraphSeries(size_t id) {
+  const GraphSeries& s = graphSeries_[id];
+  const GraphQueue& q = graphQueues_[id];
+  const uint16_t wireId = (uint16_t)(graphIdBase_ + id);
+
+  if (!graphBinary_) {
+    JsonDocument& doc = envelopeDoc();
+    doc.clear();
+    if (ns_) doc["ns"] = ns_;
+    doc["topic"] = "graph_points";
+    JsonObject d = doc.createNestedObject("data");
+    d["graph"] = s.graph;
+    d["label"] = s.label;
+    d["synced"] = s.synced;
+    JsonArray points = d.createNestedArray("points");
+    for (size_t i = 0; i < s.count; ++i) {
+      const size_t idx = (s.head + i) % MODEL_GRAPH_QUEUE_LEN;
+      JsonObject p = points.createNestedObject();
+      p["x"] = q.xs[idx];
+      p["y"] = q.ys[idx];
+    }
+    if (doc.overflowed()) LOG_WARN_F("[WS] graph_points for %s/%s truncated", s.graph, s.label);
+    AsyncWebSocketSharedBuffer buf = jsonBuffer(doc);
+    if (buf) (void)sendAll(buf, false, FrameKind::Graph, nullptr);
+    graphStats_.frames++;
+    return;
+  }
+
+  announceGraphSeries(id);
+  const size_t len = GRAPH_BATCH_HEADER + (size_t)s.count * GRAPH_BATCH_POINT;
+  AsyncWebSocketSharedBuffer buffer = std::make_shared<std::vector<uint8_t>>(len);
+
+  uint8_t* out = buffer->data();
+  out[0] = GRAPH_BATCH_V1;
+  out[1] = s.synced ? 0x01 : 0x00;
+  out[2] = (uint8_t)(wireId & 0xFF);
+  out[3] = (uint8_t)(wireId >> 8);
+  out[4] = (uint8_t)(s.count & 0xFF);
+  out[5] = (uint8_t)(s.count >> 8);
+  out[6] = 0;
+  out[7] = 0;
+  out += GRAPH_BATCH_HEADER;
+  for (size_t i = 0; i < s.count; ++i, out += GRAPH_BATCH_POINT) {
+    const size_t idx = (s.head + i) % MODEL_GRAPH_QUEUE_LEN;
+    uint32_t ybits = 0;
+    memcpy(&ybits, &q.ys[idx], sizeof(ybits));
+    for (int b = 0; b < 8; ++b) out[b] = (uint8_t)(q.xs[idx] >> (8 * b));
+    for (int b = 0; b < 4; ++b) out[8 + b] = (uint8_t)(ybits >> (8 * b));
+  }
+
+  (void)sendAll(buffer, true, FrameKind::Graph, nullptr);
+  graphStats_.frames++;
 }
 
 inline void ModelBase::graphPushCbXY(const char* graph, const char* label, uint64_t x, float y, void* ctx) {
@@ -0,0 +1,127 @@
+#pragma once
+
+// Included by src/model/ModelBase.h
+// Export of the hot-path metrics (Metrics.h): JSON for the "metrics" topic, Prometheus text for
+// a scrape endpoint.
+
+inline const fj::TopicMetrics* ModelBase::topicMetrics(const char* topic) {
+  Entry* e = find(topic);
+  return e ? e->metrics : nullptr;
+}
+
+inline void ModelBase::resetMetrics() {
+  wsMetrics_ = WsMetrics();
+  for (size_t i = 0; i < entryCount_; ++i) {
+    if (entries_[i].metrics) *entries_[i].metrics = fj::TopicMetrics();
+  }
+}
+
+// " name=<count>x<avg>/<max>us", nothing for an empty histogram
+static inline size_t modelMetricsPart_(char* out, size_t cap, const char* name, const fj::LatencyHistogram& h) {
+  if (h.count == 0 || cap == 0) return 0;
+  const int n = snprintf(out, cap, " %s=%ux%u/%uus", name, (unsigned)h.count, (unsigned)h.avgUs(), (unsigned)h.maxUs);
+  if (n < 0) return 0;
+  return (size_t)n < cap ? (size_t)n : cap - 1;
+}
+
+inline void ModelBase::writeMetrics(JsonObject out) {
+  out["ws_in"] = wsMetrics_.inMessages;
+  out["ws_in_bytes"] = wsMetrics_.inBytes;
+  out["ws_in_errors"] = wsMetrics_.inErrors;
+  out["ws_out"] = wsMetrics_.outFrames;
+  out["ws_out_bytes"] = wsMetrics_.outBytes;
+  out["ws_drops"] = wsMetrics_.outDrops;
+  out["nvs_writes"] = prefsStats_.writes;
+  out["nvs_bytes"] = prefsStats_.bytesWritten;
+  out["clients"] = (unsigned)socket_->count();
+
+  JsonArray list = out.createNestedArray("topics");
+  for (size_t i = 0; i < entryCount_; ++i) {
+    const fj::TopicMetrics* m = entries_[i].metrics;
+    if (!m) continue;
+    char line[160];
+    size_t n = (size_t)snprintf(line, sizeof(line), "%s", entries_[i].topic);
+    if (n >= sizeof(line)) n = sizeof(line) - 1;
+    const size_t start = n;
+    n += modelMetricsPart_(line + n, sizeof(line) - n, "parse", m->parse);
+    n += modelMetricsPart_(line + n, sizeof(line) - n, "apply", m->apply);
+    n += modelMetricsPart_(line + n, sizeof(line) - n, "save", m->save);
+    n += modelMetricsPart_(line + n, sizeof(line) - n, "bcast", m->broadcast);
+    if (m->nvsWrites && n < sizeof(line)) snprintf(line + n, sizeof(line) - n, " nvs=%u", (unsigned)m->nvsWrites);
+    if (n > start) list.add(line);  // copied into the document
+  }
+}
+
+inline void ModelBase::writePrometheus(String& out, const MetricsSource* models, size_t count) {
+  struct Counter {
+    const char* name;
+    const char* type;
+    const char* help;
+    uint32_t (*value)(ModelBase& m);
+  };
+  static const Counter counters[] = {
+      {"model_ws_messages_received_total", "counter", "WebSocket messages received",
+       [](ModelBase& m) { return m.wsMetrics_.inMessages; }},
+      {"model_ws_received_bytes_total", "counter", "WebSocket payload bytes received",
+       [](ModelBase& m) { return m.wsMetrics_.inBytes; }},
+      {"model_ws_rejected_total", "counter", "WebSocket messages rejected",
+       [](ModelBase& m) { return m.wsMetrics_.inErrors; }},
+      {"model_ws_frames_sent_total", "counter", "WebSocket frames queued to clients",
+       [](ModelBase& m) { return m.wsMetrics_.outFrames; }},
+      {"model_ws_sent_bytes_total", "counter", "WebSocket payload bytes queued to clients",
+       [](ModelBase& m) { return m.wsMetrics_.outBytes; }},
+      {"model_ws_send_drops_total", "counter", "WebSocket frames refused by AsyncTCP or dropped for congested clients",
+       [](ModelBase& m) { return m.wsMetrics_.outDrops; }},
+      {"model_nvs_writes_total", "counter", "Preferences writes", [](ModelBase& m) { return m.prefsStats_.writes; }},
+      {"model_nvs_written_bytes_total", "counter", "Bytes written to Preferences",
+       [](ModelBase& m) { return m.prefsStats_.bytesWritten; }},
+      {"model_ws_clients", "gauge", "Connected WebSocket clients",
+       [](ModelBase& m) { return (uint32_t)m.socket_->count(); }},
+      {"model_topics", "gauge", "Registered topics", [](ModelBase& m) { return (uint32_t)m.entryCount_; }},
+  };
+  struct Histogram {
+    const char* name;
+    const char* help;
+    fj::LatencyHistogram fj::TopicMetrics::*h;
+  };
+  static const Histogram histograms[] = {
+      {"model_topic_parse_seconds", "Parsing of WebSocket updates into a JsonDocument", &fj::TopicMetrics::parse},
+      {"model_topic_apply_seconds", "Applying WebSocket updates", &fj::TopicMetrics::apply},
+      {"model_topic_save_seconds", "Encoding and writing persisted topics", &fj::TopicMetrics::save},
+      {"model_topic_broadcast_seconds", "Serializing and sending topic frames", &fj::TopicMetrics::broadcast},
+  };
+
+  fj::PrometheusText prom(out);
+  char labels[96];
+  for (const Counter& c : counters) {
+    prom.family(c.name, c.type, c.help);
+    for (size_t i = 0; i < count; ++i) {
+      snprintf(labels, sizeof(labels), "model=\"%s\"", models[i].name);
+      prom.sample(c.name, labels, c.value(*models[i].model));
+    }
+  }
+
+  // Topic series only once there is something to report, which keeps the page small.
+  prom.family("model_topic_nvs_writes_total", "counter", "Preferences writes per topic");
+  for (size_t i = 0; i < count; ++i) {
+    ModelBase& m = *models[i].model;
+    for (size_t t = 0; t < m.entryCount_; ++t) {
+      const fj::TopicMetrics* tm = m.entries_[t].metrics;
+      if (!tm || tm->nvsWrites == 0) continue;
+      snprintf(labels, sizeof(labels), "model=\"%s\",topic=\"%s\"", models[i].name, m.entries_[t].topic);
+      prom.sample("model_topic_nvs_writes_total", labels, tm->nvsWrites);
+    }
+  }
+  for (const Histogram& h : histograms) {
+    prom.family(h.name, "histogram", h.help);
+    for (size_t i = 0; i < count; ++i) {
+      ModelBase& m = *models[i].model;
+      for (size_t t = 0; t < m.entryCount_; ++t) {
+        const fj::TopicMetrics* tm = m.entries_[t].metrics;
+        if (!tm || (tm->*h.h).count == 0) continue;
+        snprintf(labels, sizeof(labels), "model=\"%s\",topic=\"%s\"", models[i].name, m.entries_[t].topic);
+        prom.histogram(h.name, labels, tm->*h.h);
+      }
+    }
+  }
+}
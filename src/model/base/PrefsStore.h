@@ -2,6 +2,8 @@
 
 // Included by src/model/ModelBase.h
 
+#include <new>
+
 inline bool ModelBase::saveTopic(const char* topic) {
   Entry* e = find(topic);
   if (!e) return false;
@@ -9,20 +11,120 @@ inline bool ModelBase::saveTopic(const char* topic) {
 }
 
 inline bool ModelBase::saveEntry(Entry& e) {
+  e.dirtySave = false;
+  e.savePending = false;
   if (!e.persist) {
     LOG_TRACE_F("[Prefs] Topic '%s' not persisted (persist=false)", e.topic);
     return true;
   }
   LOG_TRACE_F("[Prefs] saveEntry starting for topic '%s'", e.topic);
+  fj::MetricsTimer timer(e.metrics, &fj::TopicMetrics::save);
+
+  const PrefsFormat format = entryPrefsFormat(e);
+
+  if (format == PrefsFormat::Binary) {
+    const size_t len = 5 + e.binarySize;
+    std::unique_ptr<uint8_t[]> buf(new (std::nothrow) uint8_t[len]);
+    if (!buf) {
+      LOG_ERROR_F("[Prefs] Out of memory encoding topic '%s' (%u bytes)", e.topic, (unsigned)len);
+      return false;
+    }
+    buf[0] = PREFS_BINARY_V1;
+    memcpy(buf.get() + 1, &e.binaryHash, 4);
+    if (e.writeBinaryPrefs(e.objPtr, buf.get() + 5, e.binarySize) != e.binarySize) {
+      LOG_WARN_F("[Prefs] Binary layout encoding failed for topic '%s'", e.topic);
+      return false;
+    }
+    LOG_TRACE_F("[Prefs] Saving topic '%s' as binary layout (%u bytes)", e.topic, (unsigned)len);
+    return storePrefsPayload(e, buf.get(), len, true);
+  }
+
+  if (format == PrefsFormat::MsgPack) {
+    JsonDocument& doc = buildPrefsDoc(e);
+    const size_t len = 1 + measureMsgPack(doc);
+    std::unique_ptr<uint8_t[]> buf(new (std::nothrow) uint8_t[len]);
+    if (!buf) {
+      LOG_ERROR_F("[Prefs] Out of memory encoding topic '%s' (%u bytes)", e.topic, (unsigned)len);
+      return false;
+    }
+    buf[0] = PREFS_MSGPACK_V1;
+    if (serializeMsgPack(doc, buf.get() + 1, len - 1) != len - 1) {
+      LOG_WARN_F("[Prefs] MessagePack encoding failed for topic '%s'", e.topic);
+      return false;
+    }
+    LOG_TRACE_F("[Prefs] Saving topic '%s' as MessagePack (%u bytes)", e.topic, (unsigned)len);
+    return storePrefsPayload(e, buf.get(), len, true);
+  }
+
   String dataJson = makeDataOnlyJson(e);
   LOG_TRACE_F("[Prefs] Saving topic '%s': %s", e.topic, dataJson.c_str());
-  size_t written = prefs_.putString(e.topic, dataJson);
+  return storePrefsPayload(e, (const uint8_t*)dataJson.c_str(), dataJson.length(), false);
+}
+
+// Binary falls back to MsgPack for topics without a fixed layout.
+inline ModelBase::PrefsFormat ModelBase::entryPrefsFormat(const Entry& e) const {
+  if (prefsFormat_ == PrefsFormat::Binary && e.binarySize == 0) return PrefsFormat::MsgPack;
+  return prefsFormat_;
+}
+
+// data must be NUL-terminated when !binary (stored with putString).
+// The FNV-1a fingerprint of the payload detects no-op writes.
+inline bool ModelBase::storePrefsPayload(Entry& e, const uint8_t* data, size_t len, bool binary) {
+  const uint32_t hash = fj::fnv1a(data, len);
+  if (e.prefsHashValid && e.prefsHash == hash) {
+    prefsStats_.skippedUnchanged++;
+    LOG_TRACE_F("[Prefs] Topic '%s' unchanged, skipping NVS write", e.topic);
+    return true;
+  }
+
+  // NVS keeps one type per key: drop a value stored in the other encoding first.
+  const PreferenceType type = binary ? PT_BLOB : PT_STR;
+  if (prefs_.isKey(e.topic) && prefs_.getType(e.topic) != type) {
+    LOG_DEBUG_F("[Prefs] Topic '%s' changes encoding, removing old value", e.topic);
+    prefs_.remove(e.topic);
+  }
+
+  size_t written = binary ? prefs_.putBytes(e.topic, data, len) : prefs_.putString(e.topic, (const char*)data);
   LOG_DEBUG_F("[Prefs] Written %u bytes for topic '%s'", written, e.topic);
   if (written == 0) {
-    LOG_WARN_F("[Prefs] FAILED to write topic '%s' - putString returned 0", e.topic);
+    LOG_WARN_F("[Prefs] FAILED to write topic '%s' - %s returned 0", e.topic, binary ? "putBytes" : "putString");
+    e.prefsHashValid = false;
+    return false;
+  }
+  prefsStats_.writes++;
+  prefsStats_.bytesWritten += written;
+  if (e.metrics) e.metrics->nvsWrites++;
+  e.prefsHash = hash;
+  e.prefsHashValid = true;
+  LOG_TRACE_F("[Prefs] saveEntry completed for topic '%s'", e.topic);
+  return true;
+}
+
+// Save path for change-driven persistence (Var changes, WS updates): write-through or write-back.
+inline void ModelBase::requestSave(Entry& e) {
+  e.dirtySave = false;
+  if (!e.persist) return;
+  if (prefsWriteBackMs_ == 0) {
+    (void)saveEntry(e);
+    return;
+  }
+  if (e.savePending) {
+    prefsStats_.merged++;
+    return;
+  }
+  e.savePending = true;
+  if (!prefsPending_) {
+    prefsPending_ = true;
+    firstPrefsDirtyMs_ = millis();
+  }
+  LOG_TRACE_F("[Prefs] Topic '%s' scheduled for write-back", e.topic);
+}
+
+inline void ModelBase::flushPrefs() {
+  prefsPending_ = false;
+  for (size_t i = 0; i < entryCount_; ++i) {
+    if (entries_[i].savePending) (void)saveEntry(entries_[i]);
   }
-  LOG_TRACE_F("[Prefs] saveEntry completed for topic '%s', success=%s", e.topic, written > 0 ? "true" : "false");
-  return written > 0;
 }
 
 inline bool ModelBase::loadEntry(Entry& e) {
@@ -36,29 +138,102 @@ inline bool ModelBase::loadEntry(Entry& e) {
     return saveEntry(e);
   }
 
-  String dataJson = prefs_.getString(e.topic, "");
-  if (!dataJson.length()) {
-    LOG_TRACE_F("[Prefs] Topic '%s' exists but empty", e.topic);
-    return false;
-  }
+  PrefsFormat stored = PrefsFormat::Json;
+  bool result = false;
+  if (prefs_.getType(e.topic) == PT_BLOB) {
+    bool outOfMemory = false;
+    result = loadEntryBlob(e, stored, outOfMemory);
+    // The stored value may be fine: keep it rather than rewriting defaults over it.
+    if (outOfMemory) return false;
+  } else {
+    String dataJson = prefs_.getString(e.topic, "");
+    if (!dataJson.length()) {
+      LOG_TRACE_F("[Prefs] Topic '%s' exists but empty", e.topic);
+      return false;
+    }
 
-  LOG_TRACE_F("[Prefs] Loading topic '%s': %s", e.topic, dataJson.c_str());
-  LOG_TRACE_F("[ModelBase] About to call e.applyUpdate for topic '%s'", e.topic);
-  suppressAutoSideEffects_ = true;
-  bool result = e.applyUpdate(e.objPtr, dataJson, false);
-  suppressAutoSideEffects_ = false;
-  LOG_TRACE_F("[ModelBase] applyUpdate completed for topic '%s', result=%s", e.topic, result ? "true" : "false");
+    e.prefsHash = fj::fnv1a(dataJson.c_str(), dataJson.length());
+    e.prefsHashValid = true;
 
-  // If stored JSON is corrupted or incompatible, don't keep the device stuck in a broken state.
+    LOG_TRACE_F("[Prefs] Loading topic '%s': %s", e.topic, dataJson.c_str());
+    LOG_TRACE_F("[ModelBase] About to call e.applyUpdate for topic '%s'", e.topic);
+    suppressAutoSideEffects_ = true;
+    result = e.applyUpdate(e.objPtr, dataJson, false);
+    suppressAutoSideEffects_ = false;
+    LOG_TRACE_F("[ModelBase] applyUpdate completed for topic '%s', result=%s", e.topic, result ? "true" : "false");
+  }
+
+  // If stored data is corrupted or incompatible, don't keep the device stuck in a broken state.
   // Overwrite the stored value with the topic's current defaults.
   if (!result) {
-    LOG_WARN_F("[Prefs] Failed to apply stored JSON for topic '%s' - rewriting defaults", e.topic);
+    LOG_WARN_F("[Prefs] Failed to apply stored data for topic '%s' - rewriting defaults", e.topic);
+    e.prefsHashValid = false;
+    return saveEntry(e);
+  }
+
+  if (stored != entryPrefsFormat(e)) {
+    LOG_INFO_F("[Prefs] Migrating topic '%s' to Prefs format %d", e.topic, (int)entryPrefsFormat(e));
+    e.prefsHashValid = false;
     return saveEntry(e);
   }
 
   return true;
 }
 
+// Blob payloads start with a format/version tag (PREFS_MSGPACK_V1 or PREFS_BINARY_V1).
+// outOfMemory: the blob could not be read into RAM (nothing was decoded).
+inline bool ModelBase::loadEntryBlob(Entry& e, PrefsFormat& stored, bool& outOfMemory) {
+  const size_t len = prefs_.getBytesLength(e.topic);
+  if (len < 2) {
+    LOG_WARN_F("[Prefs] Topic '%s' blob too short (%u bytes)", e.topic, (unsigned)len);
+    return false;
+  }
+
+  std::unique_ptr<uint8_t[]> buf(new (std::nothrow) uint8_t[len]);
+  if (!buf) {
+    LOG_ERROR_F("[Prefs] Out of memory loading topic '%s' (%u bytes)", e.topic, (unsigned)len);
+    outOfMemory = true;
+    return false;
+  }
+  if (prefs_.getBytes(e.topic, buf.get(), len) != len) return false;
+
+  e.prefsHash = fj::fnv1a(buf.get(), len);
+  e.prefsHashValid = true;
+
+  if (buf[0] == PREFS_BINARY_V1) {
+    stored = PrefsFormat::Binary;
+    uint32_t hash = 0;
+    if (len >= 5) memcpy(&hash, buf.get() + 1, 4);
+    if (e.binarySize == 0 || len != 5 + e.binarySize || hash != e.binaryHash) {
+      LOG_WARN_F("[Prefs] Topic '%s' binary layout mismatch (stored %u bytes, hash %08X)", e.topic, (unsigned)len,
+                 (unsigned)hash);
+      return false;
+    }
+    LOG_TRACE_F("[Prefs] Loading topic '%s' from binary layout (%u bytes)", e.topic, (unsigned)len);
+    return e.readBinaryPrefs(e.objPtr, buf.get() + 5, e.binarySize);
+  }
+
+  if (buf[0] != PREFS_MSGPACK_V1) {
+    LOG_WARN_F("[Prefs] Topic '%s' has unknown blob version 0x%02X", e.topic, (unsigned)buf[0]);
+    return false;
+  }
+  stored = PrefsFormat::MsgPack;
+
+  static StaticJsonDocument<JSON_CAPACITY> doc;  // reuse to avoid stack bloat
+  doc.clear();
+  DeserializationError err = deserializeMsgPack(doc, buf.get() + 1, len - 1);
+  if (err) {
+    LOG_WARN_F("[Prefs] MessagePack decode failed for topic '%s': %s", e.topic, err.c_str());
+    return false;
+  }
+
+  LOG_TRACE_F("[Prefs] Loading topic '%s' from MessagePack (%u bytes)", e.topic, (unsigned)len);
+  suppressAutoSideEffects_ = true;
+  bool result = e.applyUpdateJson(e.objPtr, doc.as<JsonObject>(), false);
+  suppressAutoSideEffects_ = false;
+  return result;
+}
+
 inline void ModelBase::loadOrInitAll() {
   for (size_t i = 0; i < entryCount_; ++i) {
     (void)loadEntry(entries_[i]);
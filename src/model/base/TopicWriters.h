@@ -8,6 +8,22 @@ inline void ModelBase::makeWsJsonImpl(void* objPtr, JsonObject out) {
   fj::write_ws(obj, out);
 }
 
+template <typename T>
+inline bool ModelBase::makeWsPatchJsonImpl(void* objPtr, JsonObject out, uint32_t since) {
+  T& obj = *(T*)objPtr;
+  return fj::write_ws_patch(obj, out, since);
+}
+
+template <typename T>
+inline size_t ModelBase::writeBinaryPrefsImpl(void* objPtr, uint8_t* out, size_t cap) {
+  return fj::BinaryLayout<T>::write(*(T*)objPtr, out, cap);
+}
+
+template <typename T>
+inline bool ModelBase::readBinaryPrefsImpl(void* objPtr, const uint8_t* in, size_t len) {
+  return fj::BinaryLayout<T>::read(*(T*)objPtr, in, len);
+}
+
 template <typename T>
 inline void ModelBase::makePrefsJsonImpl(void* objPtr, JsonObject out) {
   T& obj = *(T*)objPtr;
@@ -40,3 +56,15 @@ inline bool ModelBase::applyUpdateJsonImpl(void* objPtr, JsonObject data, bool s
   LOG_TRACE_F("[ModelBase::applyUpdateJsonImpl] TypeAdapter<T>::read returned: %s", result ? "true" : "false");
   return result;
 }
+
+template <typename T>
+inline fj::ScanResult ModelBase::scanUpdateImpl(void* objPtr, const char* json, size_t len) {
+  fj::ScanResult result = fj::scan_update(*(T*)objPtr, json, len);
+  LOG_TRACE_F("[ModelBase::scanUpdateImpl] fj::scan_update returned: %u", (unsigned)result);
+  return result;
+}
+
+template <typename T>
+inline size_t ModelBase::pollThrottledImpl(void* objPtr) {
+  return fj::poll_throttled(*(T*)objPtr);
+}
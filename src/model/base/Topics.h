@@ -4,12 +4,13 @@
 
 #include <type_traits>
 #include <functional>
+#include <new>
 
 template <typename U>
 struct ModelBase::has_setSaveCallback {
   template <typename V>
   static auto test(int)
-      -> decltype(std::declval<V>().setSaveCallback(std::declval<std::function<void()>>()), std::true_type());
+      -> decltype(std::declval<V>().setSaveCallback(std::declval<fj::Callback>()), std::true_type());
   template <typename>
   static std::false_type test(...);
   using type = decltype(test<U>(0));
@@ -17,21 +18,34 @@ struct ModelBase::has_setSaveCallback {
 };
 
 template <typename T>
-inline void ModelBase::registerTopic(const char* topic, T& obj) {
-  addEntry<T>(topic, obj, fj::TypeAdapter<T>::defaultPersist(), fj::TypeAdapter<T>::defaultWsSend());
+inline bool ModelBase::registerTopic(const char* topic, T& obj) {
+  return addEntry<T>(topic, obj, fj::TypeAdapter<T>::defaultPersist(), fj::TypeAdapter<T>::defaultWsSend());
 }
 
 template <typename T>
-inline void ModelBase::registerTopic(const char* topic, T& obj, bool persist, bool wsSend) {
-  addEntry<T>(topic, obj, persist, wsSend);
+inline bool ModelBase::registerTopic(const char* topic, T& obj, bool persist, bool wsSend) {
+  return addEntry<T>(topic, obj, persist, wsSend);
 }
 
 template <typename T>
-inline void ModelBase::addEntry(const char* topic, T& obj, bool persist, bool wsSend) {
-  if (entryCount_ >= MAX_TOPICS) return;
+inline bool ModelBase::addEntry(const char* topic, T& obj, bool persist, bool wsSend) {
+  if (!topic) return false;
+  if (entryCount_ >= MODEL_MAX_TOPICS) {
+    topicRegistrationErrors_++;
+    LOG_ERROR_F("[Model] Cannot register topic '%s': MODEL_MAX_TOPICS (%u) reached", topic, (unsigned)MODEL_MAX_TOPICS);
+    return false;
+  }
+  if (entryCount_ == entryCapacity_ && !growTopics(entryCapacity_ ? entryCapacity_ * 2 : MODEL_TOPIC_RESERVE)) {
+    topicRegistrationErrors_++;
+    LOG_ERROR_F("[Model] Cannot register topic '%s': out of memory (%u topics)", topic, (unsigned)entryCount_);
+    return false;
+  }
 
-  Entry& e = entries_[entryCount_++];
+  const size_t idx = entryCount_++;
+  Entry& e = entries_[idx];
   e.topic = topic;
+  e.hash = nameHash(topic);
+  e.tid = (uint16_t)idx;
   e.objPtr = (void*)&obj;
   e.persist = persist;
   e.ws_send = wsSend;
@@ -40,33 +54,118 @@ inline void ModelBase::addEntry(const char* topic, T& obj, bool persist, bool ws
   e.makePrefsJson = &makePrefsJsonImpl<T>;
   e.applyUpdate = &applyUpdateImpl<T>;
   e.applyUpdateJson = &applyUpdateJsonImpl<T>;
+  e.makeWsPatchJson = &makeWsPatchJsonImpl<T>;
+  e.scanUpdate = fj::ScanUpdate<T>::supported ? &scanUpdateImpl<T> : nullptr;
+  e.pollThrottled = fj::Throttled<T>::value ? &pollThrottledImpl<T> : nullptr;
+  if (e.pollThrottled) throttledTopics_++;
+  e.dirtySave = false;
+  e.dirtyWs = false;
+  e.savePending = false;
+  e.wsGen = fj::currentGeneration();
+  e.staleClients = 0;
+  e.prefsHash = 0;
+  e.prefsHashValid = false;
+  e.binarySize = fj::BinaryLayout<T>::supported ? fj::BinaryLayout<T>::size : 0;
+  e.binaryHash = e.binarySize ? fj::BinaryLayout<T>::hash() : 0;
+  e.writeBinaryPrefs = &writeBinaryPrefsImpl<T>;
+  e.readBinaryPrefs = &readBinaryPrefsImpl<T>;
+#if MODEL_METRICS
+  e.metrics = new (std::nothrow) fj::TopicMetrics();
+  if (!e.metrics) LOG_WARN_F("[Model] No metrics for topic '%s': out of memory", topic);
+#else
+  e.metrics = nullptr;
+#endif
+  indexEntry(idx);
 
-  // If the topic type exposes setSaveCallback(std::function<void()>), hook it to persist this entry on changes.
-  {
-    Entry* ep = &e;
-    maybeAttachSaveCallback<T>(obj, ep);
-  }
+  // If the topic type exposes setSaveCallback(fj::Callback), hook it to persist this entry on changes.
+  maybeAttachSaveCallback<T>(obj, e.tid);
+  return true;
 }
 
 template <typename T>
 inline typename std::enable_if<ModelBase::has_setSaveCallback<T>::value, void>::type
-ModelBase::maybeAttachSaveCallback(T& obj, Entry* ep) {
-  obj.setSaveCallback([this, ep]() {
+ModelBase::maybeAttachSaveCallback(T& obj, uint16_t tid) {
+  obj.setSaveCallback([this, tid]() {
     if (this->suppressAutoSideEffects_) return;
-    (void)this->saveEntry(*ep);
-    if (ep && ep->ws_send) {
-      (void)this->broadcastTopic(ep->topic);
-    }
+    this->markDirty(this->entries_[tid]);
   });
 }
 
 template <typename T>
 inline typename std::enable_if<!ModelBase::has_setSaveCallback<T>::value, void>::type
-ModelBase::maybeAttachSaveCallback(T&, Entry*) {}
+ModelBase::maybeAttachSaveCallback(T&, uint16_t) {}
+
+inline ModelBase::~ModelBase() {
+  if (standaloneServer_) {
+    // AsyncWebServer deletes its handlers; ws_ is a member.
+    standaloneServer_->removeHandler(&ws_);
+    delete standaloneServer_;
+  }
+  for (size_t i = 0; i < entryCount_; ++i) delete entries_[i].metrics;
+  delete[] entries_;
+  delete[] topicIndex_;
+  delete[] graphQueues_;
+}
+
+inline bool ModelBase::reserveTopics(size_t n) {
+  if (n > MODEL_MAX_TOPICS) return false;
+  size_t capacity = entryCapacity_ ? entryCapacity_ : 1;
+  while (capacity < n) capacity *= 2;
+  return capacity == entryCapacity_ || growTopics(capacity);
+}
+
+// Moves the entries into a larger arena and rebuilds the name index; on allocation failure
+// the registry stays as it was.
+inline bool ModelBase::growTopics(size_t capacity) {
+  if (capacity <= entryCapacity_) return true;
+  Entry* entries = new (std::nothrow) Entry[capacity];
+  uint16_t* index = new (std::nothrow) uint16_t[2 * capacity]();
+  if (!entries || !index) {
+    delete[] entries;
+    delete[] index;
+    return false;
+  }
+  for (size_t i = 0; i < entryCount_; ++i) entries[i] = entries_[i];
+  delete[] entries_;
+  delete[] topicIndex_;
+  entries_ = entries;
+  entryCapacity_ = capacity;
+  topicIndex_ = index;
+  topicIndexSize_ = 2 * capacity;
+  for (size_t i = 0; i < entryCount_; ++i) indexEntry(i);
+  LOG_DEBUG_F("[Model] Topic registry capacity: %u", (unsigned)capacity);
+  return true;
+}
+
+// A name registered twice keeps resolving to the first registration (probing finds it first).
+inline void ModelBase::indexEntry(size_t idx) {
+  const size_t mask = topicIndexSize_ - 1;
+  for (size_t i = entries_[idx].hash & mask;; i = (i + 1) & mask) {
+    if (topicIndex_[i] == 0) {
+      topicIndex_[i] = (uint16_t)(idx + 1);
+      return;
+    }
+  }
+}
 
 inline ModelBase::Entry* ModelBase::find(const char* topic) {
-  for (size_t i = 0; i < entryCount_; ++i) {
-    if (strcmp(entries_[i].topic, topic) == 0) return &entries_[i];
+  if (!topic || !topicIndex_) return nullptr;
+  const uint32_t h = nameHash(topic);
+  const size_t mask = topicIndexSize_ - 1;
+  for (size_t i = h & mask, probes = 0; probes < topicIndexSize_; i = (i + 1) & mask, ++probes) {
+    const uint16_t slot = topicIndex_[i];
+    if (slot == 0) return nullptr;
+    Entry& e = entries_[slot - 1];
+    if (e.hash == h && strcmp(e.topic, topic) == 0) return &e;
   }
   return nullptr;
 }
+
+inline ModelBase::Entry* ModelBase::findById(int32_t tid) {
+  return tid >= 0 && (size_t)tid < entryCount_ ? &entries_[tid] : nullptr;
+}
+
+inline int ModelBase::topicId(const char* topic) {
+  Entry* e = find(topic);
+  return e ? (int)e->tid : -1;
+}
@@ -23,16 +23,28 @@ inline ModelBase::ModelBase(uint16_t port, const char* wsPath)
 inline ModelBase::ModelBase(uint16_t port, const char* wsPath, const char* prefsNamespace)
   : wsPath_(wsPath ? wsPath : "/ws"),
     prefsNamespace_(prefsNamespace ? prefsNamespace : "model"),
-    server_(port),
-  ws_(wsPath_) {}
+  ws_(wsPath_),
+  socket_(&ws_) {
+  (void)port;
+}
 
 inline void ModelBase::begin() {
+#if MODEL_HEAP_DIAG
+  LOG_INFO_F("[ModelHeap] sizeof(ModelBase)=%u, no embedded AsyncWebServer (%u bytes + its handlers)%s",
+             (unsigned)sizeof(ModelBase), (unsigned)sizeof(AsyncWebServer),
+             standaloneServer_ ? ", standalone server allocated" : "");
+  modelHeapDiag_("begin");
+#endif
   LOG_TRACE_F("[Model] ModelBase::begin() - opening Preferences namespace '%s'", prefsNamespace_ ? prefsNamespace_ : "(null)");
   prefs_.begin(prefsNamespace_ ? prefsNamespace_ : "model", false);
   LOG_TRACE("[Model] Loading all topics from Preferences");
   suppressAutoSideEffects_ = true;
   loadOrInitAll();
   suppressAutoSideEffects_ = false;
+  if (hub_) {
+    LOG_TRACE_F("[Model] All topics loaded, WebSocket events come from the hub at %s", wsPath());
+    return;
+  }
   LOG_TRACE("[Model] All topics loaded, registering WebSocket handler");
 
   ws_.onEvent([this](AsyncWebSocket* s, AsyncWebSocketClient* c, AwsEventType t, void* a, uint8_t* d, size_t l) {
@@ -45,10 +57,11 @@ inline void ModelBase::attachTo(AsyncWebServer& server) {
 }
 
 inline void ModelBase::attachTo(AsyncWebServer& server, bool addRootRoute) {
-  server.addHandler(&ws_);
+  // On a hub the shared socket is registered by WsHub::attachTo().
+  if (!hub_) server.addHandler(&ws_);
   if (!addRootRoute) return;
 
-  const char* path = wsPath_ ? wsPath_ : "/ws";
+  const char* path = wsPath();
   server.on("/", HTTP_GET, [path](AsyncWebServerRequest* req) {
     String msg = "WS ready at ";
     msg += path;
@@ -56,33 +69,81 @@ inline void ModelBase::attachTo(AsyncWebServer& server, bool addRootRoute) {
   });
 }
 
+inline AsyncWebServer* ModelBase::standalone(uint16_t port) {
+  if (standaloneServer_) return standaloneServer_;
+  standaloneServer_ = new (std::nothrow) AsyncWebServer(port);
+  if (!standaloneServer_) {
+    LOG_ERROR_F("[Model] Could not allocate a standalone server on port %u", (unsigned)port);
+    return nullptr;
+  }
+  attachTo(*standaloneServer_);
+  return standaloneServer_;
+}
+
 inline bool ModelBase::broadcastTopic(const char* topic) {
   Entry* e = find(topic);
   if (!e) return false;
-  if (!e->ws_send) return true;
-  String envelope = makeEnvelope(*e);
-  LOG_TRACE_F("[WS] Broadcasting topic '%s' (%u bytes): %s", topic, envelope.length(), envelope.c_str());
-  ws_.textAll(envelope);
-  return true;
+  return broadcastEntry(*e);
+}
+
+inline bool ModelBase::broadcastEntry(Entry& e) {
+  e.dirtyWs = false;
+  e.wsGen = fj::currentGeneration();
+  if (!e.ws_send) return true;
+  if (socket_->count() == 0) return true;  // nobody listening: skip serialization entirely
+  LOG_TRACE_F("[WS] Broadcasting topic '%s'", e.topic);
+  fj::MetricsTimer timer(e.metrics, &fj::TopicMetrics::broadcast);
+  return textAllJson(buildEnvelope(e), &e);
+}
+
+inline bool ModelBase::broadcastChanges(const char* topic) {
+  Entry* e = find(topic);
+  if (!e) return false;
+  return broadcastEntryChanges(*e);
+}
+
+inline bool ModelBase::broadcastEntryChanges(Entry& e) {
+  e.dirtyWs = false;
+  const uint32_t since = e.wsGen;
+  e.wsGen = fj::currentGeneration();
+  if (!e.ws_send) return true;
+  if (socket_->count() == 0) return true;  // clients get a full snapshot on connect
+
+  fj::MetricsTimer timer(e.metrics, &fj::TopicMetrics::broadcast);
+  JsonDocument* doc = buildPatchEnvelope(e, since);
+  if (!doc) {
+    LOG_TRACE_F("[WS] Topic '%s' unchanged since gen %u, nothing to send", e.topic, (unsigned)since);
+    return true;
+  }
+  LOG_TRACE_F("[WS] Broadcasting changes of topic '%s'", e.topic);
+  return textAllJson(*doc, &e);
 }
 
 inline void ModelBase::broadcastAll() {
+  const uint32_t gen = fj::currentGeneration();
+  for (size_t i = 0; i < entryCount_; ++i) entries_[i].wsGen = gen;
+  if (socket_->count() == 0) return;
   LOG_TRACE_F("[WS] Broadcasting all %zu topics", entryCount_);
   for (size_t i = 0; i < entryCount_; ++i) {
     if (!entries_[i].ws_send) continue;
-    ws_.textAll(makeEnvelope(entries_[i]));
+    entries_[i].dirtyWs = false;
+    fj::MetricsTimer timer(entries_[i].metrics, &fj::TopicMetrics::broadcast);
+    (void)textAllJson(buildEnvelope(entries_[i]), &entries_[i]);
   }
 }
 
 inline void ModelBase::onWsEvent(AsyncWebSocket*, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data,
                                 size_t len) {
   if (type == WS_EVT_CONNECT) {
-    LOG_TRACE_F("[WS] Client connected (id=%u), sending initial state", client->id());
-    broadcastAll();
+    // AsyncTCP task: only claim a slot, loop() sends the initial state (serviceClients()).
+    LOG_TRACE_F("[WS] Client connected (id=%u), initial state follows from loop()", client->id());
+    attachClient(client);
     return;
   }
   if (type == WS_EVT_DISCONNECT) {
     LOG_TRACE_F("[WS] Client disconnected (id=%u)", client->id());
+    detachClient(client->id());
+    if (logStream_) logStream_->unsubscribe(client->id());
     return;
   }
   if (type != WS_EVT_DATA) return;
@@ -95,12 +156,15 @@ inline void ModelBase::onWsEvent(AsyncWebSocket*, AsyncWebSocketClient* client,
 }
 
 inline bool ModelBase::handleIncoming(AsyncWebSocketClient* client, const char* msg, size_t len) {
+  wsMetrics_.inMessages++;
   if (!msg || len == 0) {
+    wsMetrics_.inErrors++;
     LOG_WARN("[WS] Incoming message is empty");
     if (client) client->text(R"({"ok":false,"error":"empty_message"})");
     return false;
   }
 
+  wsMetrics_.inBytes += len;
   modelHeapDiag_("ws_before_parse");
 
   char preview[101];
@@ -109,82 +173,189 @@ inline bool ModelBase::handleIncoming(AsyncWebSocketClient* client, const char*
   preview[n] = '\0';
   LOG_DEBUG_F("[WS] Incoming message (%u bytes): %.100s", (unsigned)len, preview);
 
-  static StaticJsonDocument<JSON_CAPACITY> doc;  // reuse to avoid stack bloat
-  doc.clear();
-  if (deserializeJson(doc, msg, len)) {
-    LOG_WARN("[WS] JSON deserialize failed");
-    if (client) client->text(R"({"ok":false,"error":"invalid_json"})");
-    return false;
-  }
+  // Fast path: fj::scan_update() straight from the text; everything else is parsed below.
+  Entry* e = wsScan_ ? scanIncoming(msg, len) : nullptr;
+  if (e) {
+    wsScanStats_.scanned++;
+  } else {
+    wsScanStats_.fallback++;
+
+    static StaticJsonDocument<JSON_CAPACITY> doc;  // reuse to avoid stack bloat
+    doc.clear();
+    const uint32_t parseStart = MODEL_METRICS ? (uint32_t)micros() : 0;
+    if (deserializeJson(doc, msg, len)) {
+      wsMetrics_.inErrors++;
+      LOG_WARN("[WS] JSON deserialize failed");
+      if (client) client->text(R"({"ok":false,"error":"invalid_json"})");
+      return false;
+    }
 
-  modelHeapDiag_("ws_after_parse");
+    modelHeapDiag_("ws_after_parse");
+
+    // Check if this is a button trigger request
+    const char* action = doc["action"];
+    if (action && strcmp(action, "button_trigger") == 0) {
+      const char* topic = doc["topic"];
+      const char* button = doc["button"];
+      if (!topic || !button) {
+        wsMetrics_.inErrors++;
+        LOG_WARN("[WS] button_trigger: missing topic or button field");
+        if (client) client->text(R"({"ok":false,"error":"missing_topic_or_button"})");
+        return false;
+      }
+      LOG_INFO_F("[WS] Button trigger request: topic=%s, button=%s", topic, button);
+      handleButtonTrigger(client, topic, button);
+      return true;
+    }
+    if (action && strncmp(action, "log_", 4) == 0) {
+      if (handleLogAction(client, action, doc["level"] | (int)LogLevel::INFO, doc["backlog"] | false)) return true;
+      wsMetrics_.inErrors++;
+      return false;
+    }
 
-  // Check if this is a button trigger request
-  const char* action = doc["action"];
-  if (action && strcmp(action, "button_trigger") == 0) {
+    // Topic by name or by id ("tid", see topicId())
     const char* topic = doc["topic"];
-    const char* button = doc["button"];
-    if (!topic || !button) {
-      LOG_WARN("[WS] button_trigger: missing topic or button field");
-      if (client) client->text(R"({"ok":false,"error":"missing_topic_or_button"})");
+    JsonVariant tid = doc["tid"];
+    JsonVariant data = doc["data"];
+    LOG_DEBUG_F("[WS] Parsed topic: %s", topic ? topic : "null");
+
+    if ((!topic && !tid.is<int>()) || !data.is<JsonObject>()) {
+      wsMetrics_.inErrors++;
+      LOG_WARN("[WS] Missing topic or data is not object");
+      if (client) client->text(R"({"ok":false,"error":"missing_topic_or_data"})");
       return false;
     }
-    LOG_INFO_F("[WS] Button trigger request: topic=%s, button=%s", topic, button);
-    handleButtonTrigger(client, topic, button);
-    return true;
-  }
 
-  const char* topic = doc["topic"];
-  JsonVariant data = doc["data"];
-  LOG_DEBUG_F("[WS] Parsed topic: %s", topic ? topic : "null");
+    e = topic ? find(topic) : findById(tid.as<int>());
+    if (!e) {
+      wsMetrics_.inErrors++;
+      LOG_WARN_F("[WS] Unknown topic: %s (tid=%d)", topic ? topic : "-", topic ? -1 : tid.as<int>());
+      if (client) client->text(R"({"ok":false,"error":"unknown_topic"})");
+      return false;
+    }
 
-  if (!topic || !data.is<JsonObject>()) {
-    LOG_WARN("[WS] Missing topic or data is not object");
-    if (client) client->text(R"({"ok":false,"error":"missing_topic_or_data"})");
-    return false;
-  }
+    if (e->metrics) e->metrics->parse.observe((uint32_t)micros() - parseStart);  // includes the topic lookup
 
-  Entry* e = find(topic);
-  if (!e) {
-    LOG_WARN_F("[WS] Unknown topic: %s", topic);
-    if (client) client->text(R"({"ok":false,"error":"unknown_topic"})");
-    return false;
-  }
-
-  LOG_INFO_F("[WS] Applying update for topic: %s", topic);
-  if (Logger::shouldLog(LogLevel::TRACE)) {
-    String dataStr;
-    dataStr.reserve(measureJson(data) + 1);
-    serializeJson(data, dataStr);
-    LOG_TRACE_F("[WS] Data from WebSocket: %s", dataStr.c_str());
-  }
+    LOG_INFO_F("[WS] Applying update for topic: %s", e->topic);
+    if (Logger::shouldLog(LogLevel::TRACE)) {
+      String dataStr;
+      dataStr.reserve(measureJson(data) + 1);
+      serializeJson(data, dataStr);
+      LOG_TRACE_F("[WS] Data from WebSocket: %s", dataStr.c_str());
+    }
 
-  suppressAutoSideEffects_ = true;
-  bool ok = e->applyUpdateJson(e->objPtr, data.as<JsonObject>(), false);
-  suppressAutoSideEffects_ = false;
-  if (!ok) {
-    LOG_WARN_F("[WS] applyUpdate failed for topic: %s", topic);
-    if (client) client->text(R"({"ok":false,"error":"apply_failed"})");
-    return false;
+    bool ok;
+    {
+      fj::MetricsTimer timer(e->metrics, &fj::TopicMetrics::apply);
+      suppressAutoSideEffects_ = true;
+      ok = e->applyUpdateJson(e->objPtr, data.as<JsonObject>(), false);
+      suppressAutoSideEffects_ = false;
+    }
+    if (!ok) {
+      wsMetrics_.inErrors++;
+      LOG_WARN_F("[WS] applyUpdate failed for topic: %s", e->topic);
+      if (client) client->text(R"({"ok":false,"error":"apply_failed"})");
+      return false;
+    }
   }
 
   modelHeapDiag_("ws_after_apply");
 
-  LOG_INFO_F("[WS] Update successful, saving topic: %s", topic);
-  LOG_TRACE_F("[WS] Persisting changes to Preferences for: %s", topic);
-  saveEntry(*e);
-  LOG_TRACE("[WS] Preferences saved, calling on_update callback");
-  on_update(topic);
+  LOG_INFO_F("[WS] Update successful, saving topic: %s", e->topic);
+  LOG_TRACE_F("[WS] Persisting changes to Preferences for: %s", e->topic);
+  requestSave(*e);
+  LOG_TRACE("[WS] Preferences saved (or scheduled), calling on_update callback");
+  on_update(e->topic);
 
   modelHeapDiag_("ws_after_save");
 
   LOG_TRACE("[WS] Sending confirmation back to client");
   if (client) client->text(R"({"ok":true})");
-  broadcastTopic(topic);
+  broadcastEntry(*e);
 
   return true;
 }
 
+// Applies a plain {"topic":..,"data":{..}} (or {"tid":..,"data":{..}}) update without a JsonDocument.
+// Returns the updated entry, or nullptr (nothing changed) when the message needs the JsonDocument path.
+inline ModelBase::Entry* ModelBase::scanIncoming(const char* msg, size_t len) {
+  const uint32_t parseStart = MODEL_METRICS ? (uint32_t)micros() : 0;
+  fj::JsonScanner sc(msg, len);
+  if (!sc.beginObject()) return nullptr;
+
+  char key[8];
+  char topic[32];
+  bool haveTopic = false;
+  int32_t tid = -1;
+  const char* data = nullptr;
+  size_t dataLen = 0;
+  size_t n = 0;
+  while (sc.nextKey(key, sizeof(key), &n)) {
+    bool ok;
+    if (n == 5 && strcmp(key, "topic") == 0) {
+      ok = sc.peek() == fj::JsonScanner::Kind::String && sc.readString(topic, sizeof(topic), &n) && n < sizeof(topic);
+      haveTopic = ok;
+    } else if (n == 3 && strcmp(key, "tid") == 0) {
+      fj::JsonScanner::Number num;
+      uint16_t id = 0;
+      ok = sc.peek() == fj::JsonScanner::Kind::Number && sc.readNumber(num) && num.to(id);
+      tid = ok ? (int32_t)id : -1;
+    } else if (n == 4 && strcmp(key, "data") == 0) {
+      ok = sc.peek() == fj::JsonScanner::Kind::Object && sc.skipValue(&data, &dataLen);
+    } else if (n == 6 && strcmp(key, "action") == 0) {
+      ok = false;
+    } else {
+      ok = sc.skipValue();
+    }
+    if (!ok) return nullptr;
+  }
+  if (sc.failed() || !sc.finish() || (!haveTopic && tid < 0) || !data) return nullptr;
+
+  Entry* e = haveTopic ? find(topic) : findById(tid);
+  if (!e || !e->scanUpdate) return nullptr;
+
+  const uint32_t applyStart = e->metrics ? (uint32_t)micros() : 0;
+  suppressAutoSideEffects_ = true;
+  fj::ScanResult result = e->scanUpdate(e->objPtr, data, dataLen);
+  suppressAutoSideEffects_ = false;
+  if (result != fj::ScanResult::Applied) {
+    LOG_DEBUG_F("[WS] Scanner left topic %s to the JsonDocument path (%u)", e->topic, (unsigned)result);
+    return nullptr;
+  }
+  if (e->metrics) {
+    // parse: envelope scan + topic lookup, as on the JsonDocument path; apply: the data object.
+    e->metrics->parse.observe(applyStart - parseStart);
+    e->metrics->apply.observe((uint32_t)micros() - applyStart);
+  }
+  LOG_INFO_F("[WS] Applied scanned update for topic: %s", e->topic);
+  return e;
+}
+
+inline bool ModelBase::handleLogAction(AsyncWebSocketClient* client, const char* action, int level, bool backlog) {
+  if (strcmp(action, "log_unsubscribe") == 0) {
+    if (logStream_ && client) logStream_->unsubscribe(client->id());
+    if (client) client->text(R"({"ok":true})");
+    return true;
+  }
+  if (strcmp(action, "log_subscribe") != 0) {
+    LOG_WARN_F("[WS] Unknown action: %s", action);
+    if (client) client->text(R"({"ok":false,"error":"unknown_action"})");
+    return false;
+  }
+  if (!logStream_ || !logStream_->active()) {
+    if (client) client->text(R"({"ok":false,"error":"log_stream_unavailable"})");
+    return false;
+  }
+  if (level < (int)LogLevel::TRACE || level > (int)LogLevel::NONE) level = (int)LogLevel::INFO;
+  if (!logStream_->subscribe(client, (LogLevel)level, backlog)) {
+    LOG_WARN("[WS] log_subscribe: no free subscriber slot");
+    if (client) client->text(R"({"ok":false,"error":"log_subscribers_full"})");
+    return false;
+  }
+  if (client) client->text(R"({"ok":true})");
+  return true;
+}
+
 inline void ModelBase::handleButtonTrigger(AsyncWebSocketClient* client, const char* topic, const char* button) {
   LOG_WARN_F("[WS] Button trigger not implemented: topic=%s, button=%s", topic, button);
   if (client) client->text(R"({"ok":false,"error":"button_trigger_not_implemented"})");
@@ -194,4 +365,32 @@ inline void ModelBase::handleButtonTrigger(AsyncWebSocketClient* client, const c
 inline bool ModelBase::testHandleWsMessage(const char* msg, size_t len) {
   return handleIncoming(nullptr, msg, len);
 }
+
+inline String ModelBase::testMakeEnvelope(const char* topic) {
+  Entry* e = find(topic);
+  return e ? makeEnvelope(*e) : String();
+}
+
+inline String ModelBase::testMakeDataOnlyJson(const char* topic) {
+  Entry* e = find(topic);
+  return e ? makeDataOnlyJson(*e) : String();
+}
+
+inline bool ModelBase::testApplyUpdateJson(const char* topic, JsonObject data) {
+  Entry* e = find(topic);
+  if (!e) return false;
+  suppressAutoSideEffects_ = true;
+  bool ok = e->applyUpdateJson(e->objPtr, data, false);
+  suppressAutoSideEffects_ = false;
+  return ok;
+}
+
+inline bool ModelBase::testApplyUpdate(const char* topic, const String& dataJson) {
+  Entry* e = find(topic);
+  if (!e) return false;
+  suppressAutoSideEffects_ = true;
+  bool ok = e->applyUpdate(e->objPtr, dataJson, false);
+  suppressAutoSideEffects_ = false;
+  return ok;
+}
 #endif
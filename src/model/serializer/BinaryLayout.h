@@ -0,0 +1,290 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstring>
+#include <type_traits>
+
+#include "Hash.h"
+#include "Schema.h"
+#include "../var/Var.h"
+
+// Forward declarations: specializations below only need the complete types when a topic
+// actually contains such a field (and then the topic header already includes them).
+template <size_t N>
+struct StringBuffer;
+struct Button;
+
+namespace fj {
+
+// ============================================================================
+// BinaryLayout<T>: fixed, compile-time byte layout for POD-style topics
+// ============================================================================
+// Supported members (plain, FieldStr or wrapped in Var<>): arithmetic types, StringBuffer<N>,
+// char[N] and Button (zero bytes). Fields are packed in schema order, native byte order,
+// no padding. Any other member type (List, PointRingBuffer, nested structs) makes the whole
+// layout unsupported, so callers fall back to the JSON / MessagePack paths.
+//
+// Two purposes share the codecs but not the layout:
+//   Prefs - only PrefsMode::On fields (what writeOnePrefs would persist)
+//   Ws    - WsMode::Value fields full size, WsMode::Meta as one "initialized" byte, None omitted
+//
+// No ArduinoJson involved: save/load is a memcpy per field.
+
+enum class BinaryPurpose : uint8_t { Prefs, Ws };
+
+namespace detail {
+
+// ---- Per-value codecs ----
+// kind: one char describing the encoding, part of the layout hash.
+
+template <typename V, typename Enable = void>
+struct BinaryCodec {
+  static const bool supported = false;
+  static const size_t size = 0;
+  static const char kind = '?';
+  static void write(const V&, uint8_t*) {}
+  static void read(V&, const uint8_t*) {}
+};
+
+template <typename V>
+struct BinaryCodec<V, typename std::enable_if<std::is_arithmetic<V>::value && !std::is_same<V, bool>::value>::type> {
+  static const bool supported = true;
+  static const size_t size = sizeof(V);
+  static const char kind = std::is_floating_point<V>::value ? 'f' : (std::is_signed<V>::value ? 'i' : 'u');
+  static void write(const V& v, uint8_t* out) { std::memcpy(out, &v, sizeof(V)); }
+  static void read(V& v, const uint8_t* in) { std::memcpy(&v, in, sizeof(V)); }
+};
+
+template <>
+struct BinaryCodec<bool> {
+  static const bool supported = true;
+  static const size_t size = 1;
+  static const char kind = 'b';
+  static void write(const bool& v, uint8_t* out) { out[0] = v ? 1 : 0; }
+  static void read(bool& v, const uint8_t* in) { v = in[0] != 0; }
+};
+
+// Fixed N bytes, zero padded; the last byte is forced to '\0' on read.
+template <size_t N>
+struct BinaryCodec<StringBuffer<N>> {
+  static const bool supported = true;
+  static const size_t size = N;
+  static const char kind = 's';
+  static void write(const StringBuffer<N>& v, uint8_t* out) {
+    const char* s = v.c_str();
+    size_t n = 0;
+    while (n < N - 1 && s[n]) ++n;
+    std::memcpy(out, s, n);
+    std::memset(out + n, 0, N - n);
+  }
+  static void read(StringBuffer<N>& v, const uint8_t* in) {
+    std::memcpy(v.data(), in, N);
+    v.data()[N - 1] = '\0';
+  }
+};
+
+// Buttons carry no state worth storing.
+template <>
+struct BinaryCodec<Button> {
+  static const bool supported = true;
+  static const size_t size = 0;
+  static const char kind = 'x';
+  static void write(const Button&, uint8_t*) {}
+  static void read(Button&, const uint8_t*) {}
+};
+
+// ---- Per-field layout ----
+
+template <typename F, BinaryPurpose P>
+struct BinaryField {
+  static const bool supported = false;
+  static const size_t size = 0;
+  static const char kind = '?';
+};
+
+// Plain member
+template <typename ObjT, typename M, BinaryPurpose P>
+struct BinaryField<Field<ObjT, M>, P> {
+  typedef BinaryCodec<M> Codec;
+  static const bool supported = Codec::supported;
+  static const size_t size = Codec::size;
+  static const char kind = Codec::kind;
+  static void write(const ObjT& obj, const Field<ObjT, M>& f, uint8_t* out) { Codec::write(obj.*(f.member), out); }
+  static void read(ObjT& obj, const Field<ObjT, M>& f, const uint8_t* in) { Codec::read(obj.*(f.member), in); }
+};
+
+// Var<> member: honours PrefsMode / WsMode
+template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE, BinaryPurpose P>
+struct BinaryField<Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>>, P> {
+  typedef BinaryCodec<T> Codec;
+  typedef Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>> F;
+  static const bool isMeta = P == BinaryPurpose::Ws && WS == WsMode::Meta;
+  static const bool included = P == BinaryPurpose::Prefs ? PREFS == PrefsMode::On : WS != WsMode::None;
+  static const bool supported = Codec::supported;
+  static const size_t size = !included ? 0 : (isMeta ? 1 : Codec::size);
+  static const char kind = isMeta ? 'm' : Codec::kind;
+
+  static void write(const ObjT& obj, const F& f, uint8_t* out) {
+    if (!included) return;
+    const T& v = (obj.*(f.member)).get();
+    if (isMeta) {
+      out[0] = initialized_of(v) ? 1 : 0;
+      return;
+    }
+    Codec::write(v, out);
+  }
+
+  // Loads into the value directly (no notification), like the JSON load path.
+  static void read(ObjT& obj, const F& f, const uint8_t* in) {
+    if (!included || isMeta) return;
+    Codec::read((obj.*(f.member)).get(), in);
+  }
+};
+
+template <typename ObjT, size_t N, BinaryPurpose P>
+struct BinaryField<FieldStr<ObjT, N>, P> {
+  static const bool supported = true;
+  static const size_t size = N;
+  static const char kind = 's';
+  static void write(const ObjT& obj, const FieldStr<ObjT, N>& f, uint8_t* out) {
+    const char* s = obj.*(f.member);
+    size_t n = 0;
+    while (n < N - 1 && s[n]) ++n;
+    std::memcpy(out, s, n);
+    std::memset(out + n, 0, N - n);
+  }
+  static void read(ObjT& obj, const FieldStr<ObjT, N>& f, const uint8_t* in) {
+    std::memcpy(obj.*(f.member), in, N);
+    (obj.*(f.member))[N - 1] = '\0';
+  }
+};
+
+// ---- Compile-time folds over the field list ----
+
+template <BinaryPurpose P, typename... Fs>
+struct BinaryFold;
+
+template <BinaryPurpose P>
+struct BinaryFold<P> {
+  static const bool supported = true;
+  static const size_t size = 0;
+};
+
+template <BinaryPurpose P, typename F, typename... Rest>
+struct BinaryFold<P, F, Rest...> {
+  static const bool supported = BinaryField<F, P>::supported && BinaryFold<P, Rest...>::supported;
+  static const size_t size = BinaryField<F, P>::size + BinaryFold<P, Rest...>::size;
+};
+
+// ---- Runtime walkers (tuple_for_each functors) ----
+
+template <typename T, BinaryPurpose P>
+struct BinaryWriter {
+  const T& obj;
+  uint8_t* out;
+  BinaryWriter(const T& o, uint8_t* p) : obj(o), out(p) {}
+  template <typename F>
+  void operator()(const F& f) {
+    BinaryField<F, P>::write(obj, f, out);
+    out += BinaryField<F, P>::size;
+  }
+};
+
+template <typename T, BinaryPurpose P>
+struct BinaryReader {
+  T& obj;
+  const uint8_t* in;
+  BinaryReader(T& o, const uint8_t* p) : obj(o), in(p) {}
+  template <typename F>
+  void operator()(const F& f) {
+    BinaryField<F, P>::read(obj, f, in);
+    in += BinaryField<F, P>::size;
+  }
+};
+
+// FNV-1a over every field's key, kind and size: changes to names, order or types change the hash.
+template <BinaryPurpose P>
+struct BinaryHasher {
+  uint32_t h;
+  BinaryHasher() : h(FNV1A_SEED) {}
+  void byte(uint8_t b) { h = fnv1a(&b, 1, h); }
+  template <typename F>
+  void operator()(const F& f) {
+    for (const char* k = f.key; k && *k; ++k) byte((uint8_t)*k);
+    byte(0);
+    byte((uint8_t)BinaryField<F, P>::kind);
+    const uint32_t n = (uint32_t)BinaryField<F, P>::size;
+    for (int i = 0; i < 4; ++i) byte((uint8_t)(n >> (8 * i)));
+  }
+};
+
+template <typename SchemaT, BinaryPurpose P>
+struct BinaryLayoutImpl;
+
+template <typename T, typename... Fs, BinaryPurpose P>
+struct BinaryLayoutImpl<Schema<T, Fs...>, P> {
+  static const bool supported = BinaryFold<P, Fs...>::supported;
+  static const size_t size = BinaryFold<P, Fs...>::size;
+};
+
+template <typename T, BinaryPurpose P, bool HAS_SCHEMA>
+struct BinaryLayoutOf {
+  static const bool supported = false;
+  static const size_t size = 0;
+};
+
+template <typename T, BinaryPurpose P>
+struct BinaryLayoutOf<T, P, true>
+    : BinaryLayoutImpl<typename std::decay<decltype(T::schema())>::type, P> {};
+
+} // namespace detail
+
+template <typename T, BinaryPurpose P = BinaryPurpose::Prefs>
+struct BinaryLayout {
+  typedef detail::BinaryLayoutOf<T, P, detail::has_schema<T>::value> Impl;
+
+  static const bool supported = Impl::supported;
+  static const size_t size = Impl::size;  // payload bytes, known at compile time
+
+  // Identifies the layout (field names, order, kinds, sizes); store it next to the payload.
+  static uint32_t hash() {
+    static const uint32_t h = computeHash_(std::integral_constant<bool, supported>());
+    return h;
+  }
+
+  // Returns the number of bytes written (size), or 0 if unsupported or cap is too small.
+  static size_t write(const T& obj, uint8_t* out, size_t cap) {
+    return write_(obj, out, cap, std::integral_constant<bool, supported>());
+  }
+
+  // len must equal size.
+  static bool read(T& obj, const uint8_t* in, size_t len) {
+    return read_(obj, in, len, std::integral_constant<bool, supported>());
+  }
+
+private:
+  static uint32_t computeHash_(std::true_type) {
+    detail::BinaryHasher<P> hasher;
+    tuple_for_each(T::schema().fields, hasher);
+    return hasher.h;
+  }
+  static uint32_t computeHash_(std::false_type) { return 0; }
+
+  static size_t write_(const T& obj, uint8_t* out, size_t cap, std::true_type) {
+    if (!out || cap < size) return 0;
+    detail::BinaryWriter<T, P> w(obj, out);
+    tuple_for_each(T::schema().fields, w);
+    return size;
+  }
+  static size_t write_(const T&, uint8_t*, size_t, std::false_type) { return 0; }
+
+  static bool read_(T& obj, const uint8_t* in, size_t len, std::true_type) {
+    if (!in || len != size) return false;
+    detail::BinaryReader<T, P> r(obj, in);
+    tuple_for_each(T::schema().fields, r);
+    return true;
+  }
+  static bool read_(T&, const uint8_t*, size_t, std::false_type) { return false; }
+};
+
+} // namespace fj
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace fj {
+
+// ============================================================================
+// FNV-1a (32 bit): topic/button names, persisted payload fingerprints and the
+// BinaryLayout schema hash. Fast and tiny, not collision resistant: never let a
+// hash match alone decide anything that matters.
+// ============================================================================
+
+static const uint32_t FNV1A_SEED = 2166136261u;
+static const uint32_t FNV1A_PRIME = 16777619u;
+
+// seed continues a previous hash: fnv1a(b, nb, fnv1a(a, na)) hashes a followed by b.
+inline uint32_t fnv1a(const void* data, size_t len, uint32_t seed = FNV1A_SEED) {
+  const uint8_t* p = (const uint8_t*)data;
+  uint32_t h = seed;
+  for (size_t i = 0; i < len; ++i) h = (h ^ p[i]) * FNV1A_PRIME;
+  return h;
+}
+
+// Same hash over a NUL-terminated string, usable at compile time (switch case labels).
+inline constexpr uint32_t fnv1aStr(const char* s, uint32_t seed = FNV1A_SEED) {
+  return *s ? fnv1aStr(s + 1, (seed ^ (uint8_t)*s) * FNV1A_PRIME) : seed;
+}
+
+} // namespace fj
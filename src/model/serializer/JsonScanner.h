@@ -0,0 +1,357 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace fj {
+
+// ============================================================================
+// JsonScanner: pull tokenizer over a JSON text, no document / pool
+// ============================================================================
+// Reads values in place from a (not necessarily NUL-terminated) buffer. The caller drives it:
+//
+//   JsonScanner sc(json, len);
+//   if (!sc.beginObject()) ...
+//   while (sc.nextKey(key, sizeof(key))) {
+//     if (strcmp(key, "n") == 0) sc.readNumber(num); else sc.skipValue();
+//   }
+//   if (sc.failed() || !sc.finish()) ...
+//
+// Strict RFC 8259 only (no comments, single quotes or trailing commas). Any error puts the
+// scanner into the failed() state; every later call returns false.
+
+class JsonScanner {
+public:
+  // Kind of the next value, judged by its first character.
+  enum class Kind : uint8_t { Object, Array, String, Number, True, False, Null, Invalid };
+
+  static const uint8_t MAX_DEPTH = 10;  // nesting accepted by skipValue(), same as ArduinoJson
+
+  struct Number {
+    bool integral;       // no fraction / exponent and fits into 64 bits
+    bool negative;
+    uint64_t magnitude;  // integral only
+    double real;
+
+    // Exact conversion: integers must fit into V, floats only convert to floating point types.
+    template <typename V>
+    typename std::enable_if<std::is_integral<V>::value, bool>::type to(V& out) const {
+      if (!integral) return false;
+      if (!negative) {
+        if (magnitude > (uint64_t)std::numeric_limits<V>::max()) return false;
+        out = (V)magnitude;
+        return true;
+      }
+      if (magnitude == 0) {
+        out = 0;
+        return true;
+      }
+      if (!std::is_signed<V>::value) return false;
+      const uint64_t limit = (uint64_t)(-(std::numeric_limits<V>::min() + 1)) + 1;
+      if (magnitude > limit) return false;
+      out = (V)(-(int64_t)(magnitude - 1) - 1);
+      return true;
+    }
+
+    template <typename V>
+    typename std::enable_if<std::is_floating_point<V>::value, bool>::type to(V& out) const {
+      out = (V)real;
+      return true;
+    }
+  };
+
+  JsonScanner(const char* json, size_t len) : p_(json), end_(json ? json + len : json), failed_(!json), first_(false) {}
+
+  bool failed() const { return failed_; }
+  size_t remaining() const { return (size_t)(end_ - p_); }
+
+  Kind peek() {
+    skipWs_();
+    if (failed_ || p_ >= end_) return Kind::Invalid;
+    switch (*p_) {
+      case '{': return Kind::Object;
+      case '[': return Kind::Array;
+      case '"': return Kind::String;
+      case 't': return Kind::True;
+      case 'f': return Kind::False;
+      case 'n': return Kind::Null;
+      default: return (*p_ == '-' || (*p_ >= '0' && *p_ <= '9')) ? Kind::Number : Kind::Invalid;
+    }
+  }
+
+  bool beginObject() { return open_('{'); }
+  bool beginArray() { return open_('['); }
+
+  // true: a key was read into `key` (truncated to cap - 1, full length in keyLen) and ':' consumed.
+  // false: '}' consumed (end of object) or failed().
+  bool nextKey(char* key, size_t cap, size_t* keyLen = nullptr) {
+    if (!next_('}')) return false;
+    if (*p_ != '"') return fail_();
+    if (!readString(key, cap, keyLen)) return false;
+    skipWs_();
+    if (p_ >= end_ || *p_ != ':') return fail_();
+    ++p_;
+    return true;
+  }
+
+  // true: another array item follows. false: ']' consumed (end of array) or failed().
+  bool nextItem() { return next_(']'); }
+
+  // Unescapes into out (may be nullptr to just consume the string); the result is truncated to
+  // cap - 1 bytes and always NUL terminated. fullLen receives the unescaped length.
+  bool readString(char* out, size_t cap, size_t* fullLen = nullptr) {
+    skipWs_();
+    if (failed_ || p_ >= end_ || *p_ != '"') return fail_();
+    ++p_;
+    size_t n = 0;
+    for (;;) {
+      if (p_ >= end_) return fail_();
+      const char c = *p_++;
+      if (c == '"') break;
+      if ((uint8_t)c < 0x20) return fail_();
+      if (c != '\\') {
+        put_(out, cap, n, (uint8_t)c);
+        continue;
+      }
+      if (p_ >= end_) return fail_();
+      const char esc = *p_++;
+      switch (esc) {
+        case '"': put_(out, cap, n, '"'); break;
+        case '\\': put_(out, cap, n, '\\'); break;
+        case '/': put_(out, cap, n, '/'); break;
+        case 'b': put_(out, cap, n, '\b'); break;
+        case 'f': put_(out, cap, n, '\f'); break;
+        case 'n': put_(out, cap, n, '\n'); break;
+        case 'r': put_(out, cap, n, '\r'); break;
+        case 't': put_(out, cap, n, '\t'); break;
+        case 'u': {
+          uint32_t cp = 0;
+          if (!hex4_(cp)) return false;
+          // Surrogate pair
+          if (cp >= 0xD800 && cp <= 0xDBFF && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+            const char* save = p_;
+            p_ += 2;
+            uint32_t lo = 0;
+            if (!hex4_(lo)) return false;
+            if (lo >= 0xDC00 && lo <= 0xDFFF) {
+              cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+            } else {
+              p_ = save;
+            }
+          }
+          putUtf8_(out, cap, n, cp);
+          break;
+        }
+        default: return fail_();
+      }
+    }
+    if (out && cap) out[n < cap ? n : cap - 1] = '\0';
+    if (fullLen) *fullLen = n;
+    return true;
+  }
+
+  bool readNumber(Number& num) {
+    skipWs_();
+    if (failed_ || p_ >= end_) return fail_();
+    const char* start = p_;
+    num.integral = true;
+    num.negative = false;
+    num.magnitude = 0;
+    num.real = 0;
+
+    if (*p_ == '-') {
+      num.negative = true;
+      ++p_;
+    }
+    if (p_ >= end_ || !digit_(*p_)) return fail_();
+    if (*p_ == '0') {
+      ++p_;
+    } else {
+      while (p_ < end_ && digit_(*p_)) {
+        const uint64_t d = (uint64_t)(*p_ - '0');
+        if (num.magnitude > (std::numeric_limits<uint64_t>::max() - d) / 10) num.integral = false;
+        num.magnitude = num.magnitude * 10 + d;
+        ++p_;
+      }
+    }
+    if (p_ < end_ && *p_ == '.') {
+      num.integral = false;
+      ++p_;
+      if (p_ >= end_ || !digit_(*p_)) return fail_();
+      while (p_ < end_ && digit_(*p_)) ++p_;
+    }
+    if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+      num.integral = false;
+      ++p_;
+      if (p_ < end_ && (*p_ == '+' || *p_ == '-')) ++p_;
+      if (p_ >= end_ || !digit_(*p_)) return fail_();
+      while (p_ < end_ && digit_(*p_)) ++p_;
+    }
+
+    // strtod needs a terminated copy; longer numbers than this are not worth a fast path.
+    char tmp[40];
+    const size_t n = (size_t)(p_ - start);
+    if (n >= sizeof(tmp)) return fail_();
+    std::memcpy(tmp, start, n);
+    tmp[n] = '\0';
+    num.real = strtod(tmp, nullptr);
+    return true;
+  }
+
+  bool readBool(bool& b) {
+    skipWs_();
+    if (literal_("true")) {
+      b = true;
+      return true;
+    }
+    if (literal_("false")) {
+      b = false;
+      return true;
+    }
+    return fail_();
+  }
+
+  bool readNull() {
+    skipWs_();
+    return literal_("null") || fail_();
+  }
+
+  // Consumes (and validates) the next value. start / len receive its raw text.
+  bool skipValue(const char** start = nullptr, size_t* len = nullptr) {
+    skipWs_();
+    const char* s = p_;
+    if (!skip_(0)) return false;
+    if (start) *start = s;
+    if (len) *len = (size_t)(p_ - s);
+    return true;
+  }
+
+  // Only whitespace may follow the last value.
+  bool finish() {
+    skipWs_();
+    return !failed_ && p_ == end_;
+  }
+
+private:
+  const char* p_;
+  const char* end_;
+  bool failed_;
+  bool first_;  // right after '{' / '[': no ',' expected before the next member
+
+  bool fail_() {
+    failed_ = true;
+    p_ = end_;
+    return false;
+  }
+
+  static bool digit_(char c) { return c >= '0' && c <= '9'; }
+
+  void skipWs_() {
+    while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) ++p_;
+  }
+
+  bool open_(char c) {
+    skipWs_();
+    if (failed_ || p_ >= end_ || *p_ != c) return fail_();
+    ++p_;
+    first_ = true;
+    return true;
+  }
+
+  // Handles the ',' between members; false once `close` was consumed.
+  bool next_(char close) {
+    skipWs_();
+    if (failed_ || p_ >= end_) return fail_();
+    if (first_) {
+      first_ = false;
+      if (*p_ == close) {
+        ++p_;
+        return false;
+      }
+      return true;
+    }
+    if (*p_ == close) {
+      ++p_;
+      return false;
+    }
+    if (*p_ != ',') return fail_();
+    ++p_;
+    skipWs_();
+    if (p_ >= end_ || *p_ == close) return fail_();
+    return true;
+  }
+
+  bool literal_(const char* lit) {
+    const size_t n = std::strlen(lit);
+    if (failed_ || (size_t)(end_ - p_) < n || std::memcmp(p_, lit, n) != 0) return false;
+    p_ += n;
+    return true;
+  }
+
+  bool hex4_(uint32_t& out) {
+    if (end_ - p_ < 4) return fail_();
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = *p_++;
+      out <<= 4;
+      if (c >= '0' && c <= '9') out |= (uint32_t)(c - '0');
+      else if (c >= 'a' && c <= 'f') out |= (uint32_t)(c - 'a' + 10);
+      else if (c >= 'A' && c <= 'F') out |= (uint32_t)(c - 'A' + 10);
+      else return fail_();
+    }
+    return true;
+  }
+
+  static void put_(char* out, size_t cap, size_t& n, uint8_t b) {
+    if (out && n + 1 < cap) out[n] = (char)b;
+    ++n;
+  }
+
+  static void putUtf8_(char* out, size_t cap, size_t& n, uint32_t cp) {
+    if (cp < 0x80) {
+      put_(out, cap, n, (uint8_t)cp);
+    } else if (cp < 0x800) {
+      put_(out, cap, n, (uint8_t)(0xC0 | (cp >> 6)));
+      put_(out, cap, n, (uint8_t)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+      put_(out, cap, n, (uint8_t)(0xE0 | (cp >> 12)));
+      put_(out, cap, n, (uint8_t)(0x80 | ((cp >> 6) & 0x3F)));
+      put_(out, cap, n, (uint8_t)(0x80 | (cp & 0x3F)));
+    } else {
+      put_(out, cap, n, (uint8_t)(0xF0 | (cp >> 18)));
+      put_(out, cap, n, (uint8_t)(0x80 | ((cp >> 12) & 0x3F)));
+      put_(out, cap, n, (uint8_t)(0x80 | ((cp >> 6) & 0x3F)));
+      put_(out, cap, n, (uint8_t)(0x80 | (cp & 0x3F)));
+    }
+  }
+
+  bool skip_(uint8_t depth) {
+    Number num;
+    bool b;
+    switch (peek()) {
+      case Kind::String: return readString(nullptr, 0);
+      case Kind::Number: return readNumber(num);
+      case Kind::True:
+      case Kind::False: return readBool(b);
+      case Kind::Null: return readNull();
+      case Kind::Object:
+        if (depth >= MAX_DEPTH || !beginObject()) return fail_();
+        while (nextKey(nullptr, 0)) {
+          if (!skip_(depth + 1)) return false;
+        }
+        return !failed_;
+      case Kind::Array:
+        if (depth >= MAX_DEPTH || !beginArray()) return fail_();
+        while (nextItem()) {
+          if (!skip_(depth + 1)) return false;
+        }
+        return !failed_;
+      default: return fail_();
+    }
+  }
+};
+
+} // namespace fj
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tuple>
+#include <type_traits>
 
 namespace fj {
 
@@ -29,6 +30,18 @@ struct Schema {
 template <typename T, typename... Fs>
 inline Schema<T, Fs...> makeSchema(Fs... fs) { return { std::make_tuple(fs...) }; }
 
+namespace detail {
+// Does T provide a static schema()?
+template <typename T>
+struct has_schema {
+  template <typename U>
+  static auto test(int) -> decltype(U::schema(), std::true_type());
+  template <typename>
+  static std::false_type test(...);
+  static const bool value = decltype(test<T>(0))::value;
+};
+} // namespace detail
+
 // ---------------------------------------------------------------------------
 // tuple_for_each (C++11)
 // ---------------------------------------------------------------------------
@@ -1,20 +1,20 @@
 #pragma once
 #include <Arduino.h>
 #include <cstring>
-#include <functional>
 #include "../ModelSerializer.h"
+#include "../var/Callback.h"
 #include "ModelTypeTraits.h"
 
 struct Button {
   int id;
-  std::function<void()> callback;
+  fj::Callback callback;
 
   Button() : id(0), callback(nullptr) {}
   Button(int _id) : id(_id), callback(nullptr) {}
-  Button(int _id, std::function<void()> cb) : id(_id), callback(cb) {}
+  Button(int _id, fj::Callback cb) : id(_id), callback(cb) {}
 
   // Register a callback to be called when button is triggered
-  void setCallback(std::function<void()> cb) {
+  void setCallback(fj::Callback cb) {
     callback = cb;
   }
 
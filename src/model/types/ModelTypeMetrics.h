@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "../ModelBase.h"
+#include "ModelTypeTraits.h"
+
+// Read-only topic that publishes the hot-path metrics of a model (see ModelBase::writeMetrics()
+// and Metrics.h). Register it with persist = false:
+//
+//   metrics.model = this;
+//   registerTopic("metrics", metrics, false, true);
+struct MetricsTopic {
+  ModelBase* model = nullptr;
+};
+
+namespace fj {
+
+template <>
+struct TypeAdapter<MetricsTopic> {
+  static void write(const MetricsTopic& t, JsonObject out) {
+    if (t.model) t.model->writeMetrics(out);
+  }
+
+  static void write_ws(const MetricsTopic& t, JsonObject out) { write(t, out); }
+
+  // Nothing worth persisting.
+  static void write_prefs(const MetricsTopic&, JsonObject) {}
+
+  // Metrics cannot be set from the UI.
+  static bool read(MetricsTopic&, JsonObject, bool) { return false; }
+};
+
+} // namespace fj
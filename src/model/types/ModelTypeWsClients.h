@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "../ModelBase.h"
+#include "ModelTypeTraits.h"
+
+// Read-only topic that publishes the per-client WebSocket counters of a model
+// (see ModelBase::SlowClientPolicy). Register it with persist = false:
+//
+//   clients.model = this;
+//   registerTopic("ws_clients", clients, false, true);
+struct WsClientStatsTopic {
+  ModelBase* model = nullptr;
+};
+
+namespace fj {
+
+template <>
+struct TypeAdapter<WsClientStatsTopic> {
+  static void write(const WsClientStatsTopic& t, JsonObject out) {
+    if (t.model) t.model->writeClientStats(out);
+  }
+
+  static void write_ws(const WsClientStatsTopic& t, JsonObject out) { write(t, out); }
+
+  // Nothing worth persisting.
+  static void write_prefs(const WsClientStatsTopic&, JsonObject) {}
+
+  // Counters cannot be set from the UI.
+  static bool read(WsClientStatsTopic&, JsonObject, bool) { return false; }
+};
+
+} // namespace fj
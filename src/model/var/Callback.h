@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace fj {
+
+// ---- Callback: void() delegate without heap allocation ----
+// Replaces std::function<void()> for change notifications (Var::setOnChange, setSaveCallback),
+// Button callbacks and the AdminModel hooks. Holds an invoker pointer plus an inline copy of the
+// callable, 3 words in total (std::function: 4 words plus a heap block for larger captures).
+//
+// Accepts function pointers and lambdas whose captures are trivially copyable and fit in two
+// pointers, e.g. [this], [this, id] or [&counter]. Anything larger fails to compile instead of
+// silently allocating; capture a pointer to a struct holding the state instead.
+//
+//   fj::Callback cb = [this]() { onChanged(); };
+//   if (cb) cb();
+
+class Callback {
+public:
+  static const size_t STORAGE = 2 * sizeof(void*);
+
+  Callback() : invoke_(nullptr), storage_() {}
+  Callback(std::nullptr_t) : invoke_(nullptr), storage_() {}
+
+  template <typename F,
+            typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Callback>::value>::type>
+  Callback(F fn) : invoke_(&invoke<F>) {
+    static_assert(sizeof(F) <= STORAGE, "fj::Callback: capture at most two pointers");
+    static_assert(alignof(F) <= alignof(void*), "fj::Callback: over-aligned capture");
+    static_assert(std::is_trivially_copyable<F>::value && std::is_trivially_destructible<F>::value,
+                  "fj::Callback: captures must be trivially copyable (no String, std::function, ...)");
+    new (&storage_) F(fn);
+  }
+
+  // Function with a context pointer, as used by PointRingBuffer::setCallback.
+  Callback(void (*fn)(void*), void* ctx) : Callback([fn, ctx]() { fn(ctx); }) {}
+
+  explicit operator bool() const { return invoke_ != nullptr; }
+
+  void operator()() const {
+    if (invoke_) invoke_(&storage_);
+  }
+
+private:
+  typedef typename std::aligned_storage<STORAGE, alignof(void*)>::type Storage;
+
+  void (*invoke_)(void*);
+  mutable Storage storage_;
+
+  template <typename F>
+  static void invoke(void* p) { (*static_cast<F*>(p))(); }
+};
+
+} // namespace fj
@@ -1,51 +1,122 @@
 #pragma once
 
 #include <Arduino.h>
+#include <cstring>
 #include <type_traits>
-#include <functional>
 #include <utility>
 
 #include "Logger.h"
+#include "Callback.h"
 #include "VarPolicy.h"
+#include "VarThrottle.h"
 #include "VarTraits.h"
 #include "VarJsonDispatch.h"
 
 namespace fj {
 
+namespace detail {
+// Change clock shared by all Vars. Every notification stamps the Var with the next tick,
+// so "changed since t" is generation() after t in serial-number order, which survives the
+// clock wrapping around (see changedSince() and write_ws_patch()).
+inline uint32_t& generationClock() {
+  static uint32_t clock = 0;
+  return clock;
+}
+} // namespace detail
+
+inline uint32_t currentGeneration() { return detail::generationClock(); }
+inline bool changedSince(uint32_t gen, uint32_t since) { return (int32_t)(gen - since) > 0; }
+
+namespace detail {
+// ---- same_value: does set(v) leave the value unchanged? (NotifyMode::OnChange) ----
+// Ranked overloads: string-like values compare with strcmp, trivially copyable values with
+// memcmp after conversion to T. Anything else (List, PointRingBuffer, ...) counts as changed.
+template <int N> struct rank : rank<N - 1> {};
+template <> struct rank<0> {};
+
+inline const char* cstr_of(const char* s) { return s ? s : ""; }
+inline const char* cstr_of(const String& s) { return s.c_str(); }
+
+template <typename T, typename U>
+inline auto same_value_(const T& cur, const U& v, rank<3>) -> decltype(cstr_of(v), cur.c_str(), bool()) {
+  return strcmp(cur.c_str(), cstr_of(v)) == 0;
+}
+
+template <typename T, typename U>
+inline auto same_value_(const T& cur, const U& v, rank<2>) -> decltype(cur.c_str(), v.c_str(), bool()) {
+  return strcmp(cur.c_str(), v.c_str()) == 0;
+}
+
+template <typename T, typename U>
+inline typename std::enable_if<std::is_trivially_copyable<T>::value && std::is_convertible<const U&, T>::value, bool>::type
+same_value_(const T& cur, const U& v, rank<1>) {
+  const T next = v;
+  return memcmp(&cur, &next, sizeof(T)) == 0;
+}
+
+template <typename T, typename U>
+inline bool same_value_(const T&, const U&, rank<0>) { return false; }
+
+template <typename T, typename U>
+inline bool same_value(const T& cur, const U& v) { return same_value_(cur, v, rank<3>()); }
+} // namespace detail
+
 // ---- Core Var<T> template: policy-based wrapper with notification ----
 // Template parameters control serialization behavior:
 //   - WsMode:    Value (full data), Meta (only metadata like "initialized"), None (omit from WS)
 //   - PrefsMode: On (persist to preferences), Off (transient only)
 //   - WriteMode: On (accept remote updates), Off (read-only, reject updates)
+//   - NotifyMode: Always (every set() notifies), OnChange (set() to the current value is a no-op)
+//   - GATE:      NoThrottle, or a Throttle<> / Deadband<> rate limit (see VarThrottle.h)
 
 template <typename T,
           WsMode WS = WsMode::Value,
           PrefsMode PREFS = PrefsMode::On,
-          WriteMode WRITE = WriteMode::On>
-class Var {
+          WriteMode WRITE = WriteMode::On,
+          NotifyMode NOTIFY = NotifyMode::Always,
+          typename GATE = NoThrottle>
+class Var : private GATE::template State<T> {
 public:
   typedef T ValueType;
 
-  Var() : value_(), on_change_() {}
-  Var(const T& v) : value_(v), on_change_() {}
+  Var() : value_(), on_change_(), gen_(0) {}
+  Var(const T& v) : value_(v), on_change_(), gen_(0) {}
 
   const T& get() const { return value_; }
   T&       get()       { return value_; }
 
-  void setOnChange(std::function<void()> cb) {
+  // Change-clock tick of the last set()/touch(). In-place edits through get() are not
+  // seen until touch() is called.
+  uint32_t generation() const { return gen_; }
+
+  void setOnChange(Callback cb) {
     LOG_TRACE_F("[Var] setOnChange callback registered");
     on_change_ = cb;
   }
 
   void touch() {
     LOG_TRACE_F("[Var] touch() called, notifying");
-    notify_();
+    this->gateSent_(value_, millis());
+    deliver_();
+  }
+
+  // Trailing edge of a Throttle<> gate: notifies if a held-back change is due. ModelBase::loop()
+  // calls this for registered topics; standalone Vars need their own caller.
+  bool poll() {
+    if (!GATE::enabled || !this->gateDue_(value_, millis())) return false;
+    deliver_();
+    return true;
   }
 
-  // Generic set (always notifies; keep it simple and predictable)
+  // Generic set. Notifies on every call, or with NotifyMode::OnChange only if the value differs
+  // (the change clock is not advanced either, so patches skip the field). touch() always notifies.
   template <typename U>
   void set(U&& v) {
     LOG_TRACE_F("[Var::set] Called with new value");
+    if (NOTIFY == NotifyMode::OnChange && detail::same_value(value_, v)) {
+      LOG_TRACE_F("[Var::set] Value unchanged, not notifying");
+      return;
+    }
     assign_(std::forward<U>(v));
     LOG_TRACE_F("[Var::set] Assignment completed, calling notify");
     notify_();
@@ -95,9 +166,19 @@ public:
 
 private:
   T value_;
-  std::function<void()> on_change_;
+  Callback on_change_;
+  uint32_t gen_;
 
   void notify_() {
+    if (GATE::enabled && !this->gateAdmit_(value_, millis())) {
+      LOG_TRACE("[Var] Change held back by throttle");
+      return;
+    }
+    deliver_();
+  }
+
+  void deliver_() {
+    gen_ = ++detail::generationClock();
     if (on_change_) {
       LOG_TRACE("[Var] Calling on_change callback");
       on_change_();
@@ -22,4 +22,22 @@ template <typename T> using VarMetaRw      = Var<T, WsMode::Meta,  PrefsMode::Of
 template <typename T> using VarMetaPrefsRo = Var<T, WsMode::Meta,  PrefsMode::On,  WriteMode::Off>;
 template <typename T> using VarMetaRo      = Var<T, WsMode::Meta,  PrefsMode::Off, WriteMode::Off>;
 
+// Same policies as V, but set() only notifies when the value changes (NotifyMode::OnChange):
+//   fj::OnChange<fj::VarWsRo<int>> remaining_seconds;
+template <typename V> struct OnChangeOf;
+template <typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
+struct OnChangeOf<Var<T, WS, PREFS, WRITE, NOTIFY, GATE>> {
+  typedef Var<T, WS, PREFS, WRITE, NotifyMode::OnChange, GATE> type;
+};
+template <typename V> using OnChange = typename OnChangeOf<V>::type;
+
+// Same policies as V behind a notification gate (VarThrottle.h):
+//   fj::Gated<fj::VarWsRo<float>, fj::Throttle<100, 100>> temperature;
+template <typename V, typename G> struct GatedOf;
+template <typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE, typename G>
+struct GatedOf<Var<T, WS, PREFS, WRITE, NOTIFY, GATE>, G> {
+  typedef Var<T, WS, PREFS, WRITE, NOTIFY, G> type;
+};
+template <typename V, typename G> using Gated = typename GatedOf<V, G>::type;
+
 } // namespace fj
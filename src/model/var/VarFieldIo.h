@@ -14,10 +14,10 @@ namespace fj {
 // These functions are called by ModelSerializer for each field in a struct.
 // They apply the Var's policy (WsMode, PrefsMode, WriteMode) during serialization.
 
-template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE>
-inline void writeOne(const ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE>>& f, JsonObject out) {
+template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
+inline void writeOne(const ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>>& f, JsonObject out) {
   LOG_TRACE_F("[writeOne] Var key='%s', WsMode=%d", f.key, (int)WS);
-  const Var<T, WS, PREFS, WRITE>& v = (obj.*(f.member));
+  const Var<T, WS, PREFS, WRITE, NOTIFY, GATE>& v = (obj.*(f.member));
   if (WS == WsMode::None) {
     LOG_TRACE_F("[writeOne] WsMode=None, skipping");
     return;
@@ -41,15 +41,15 @@ inline void writeOne(const ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE>
 // Write Var field to preferences JSON (only if PrefsMode::On)
 // Always emits actual value, not metadata (unlike WsMode)
 
-template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE>
-inline void writeOnePrefs(const ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE>>& f, JsonObject out) {
+template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
+inline void writeOnePrefs(const ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>>& f, JsonObject out) {
   LOG_TRACE_F("[ModelVar] writeOnePrefs called for Var key='%s', WS=%d, PREFS=%d",
               f.key, (int)WS, (int)PREFS);
   if (PREFS == PrefsMode::Off) {
     LOG_TRACE_F("[ModelVar] Skipping, PREFS=Off");
     return;
   }
-  const Var<T, WS, PREFS, WRITE>& v = (obj.*(f.member));
+  const Var<T, WS, PREFS, WRITE, NOTIFY, GATE>& v = (obj.*(f.member));
   // For Prefs, ALWAYS write the actual value, not metadata (unlike WebSocket)
   LOG_TRACE_F("[ModelVar] About to write key='%s', getting value from Var", f.key);
   const T& val = v.get();
@@ -64,9 +64,9 @@ inline void writeOnePrefs(const ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, W
 // Read Var field from incoming JSON (only if WriteMode::On)
 // Routes through TypeAdapter for complex types, or direct assignment for scalars/strings
 
-template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE>
+template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
 inline typename std::enable_if<detail::has_typeadapter_read<T>::value, bool>::type
-readOne(ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE>>& f, JsonObject in) {
+readOne(ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>>& f, JsonObject in) {
   LOG_TRACE_F("readOne (Var/TypeAdapter) key='%s', WRITE=%s", f.key, WRITE == WriteMode::Off ? "Off" : "On");
   bool keyExists = in.containsKey(f.key);
   LOG_TRACE_F("[ModelVar] Key '%s' exists in JSON: %s", f.key, keyExists ? "YES" : "NO");
@@ -84,7 +84,7 @@ readOne(ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE>>& f, JsonObject in
     return false;
   }
 
-  Var<T, WS, PREFS, WRITE>& dst = (obj.*(f.member));
+  Var<T, WS, PREFS, WRITE, NOTIFY, GATE>& dst = (obj.*(f.member));
 
   LOG_TRACE_F("[ModelVar] Variant for key '%s' is JsonObject: %s", f.key, v.is<JsonObject>() ? "YES" : "NO");
 
@@ -109,9 +109,9 @@ readOne(ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE>>& f, JsonObject in
 // Fallback path for scalar/string vars: direct assignment allowed (legacy support)
 // Does NOT route through TypeAdapter (for compatibility with plain types)
 
-template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE>
+template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
 inline typename std::enable_if<!detail::has_typeadapter_read<T>::value, bool>::type
-readOne(ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE>>& f, JsonObject in) {
+readOne(ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>>& f, JsonObject in) {
   LOG_TRACE_F("readOne (Var) called for key='%s', WRITE=%s", f.key, WRITE == WriteMode::Off ? "Off" : "On");
 
   if (WRITE == WriteMode::Off) {
@@ -136,7 +136,7 @@ readOne(ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE>>& f, JsonObject in
     LOG_TRACE("  -> variant type: other");
   }
 
-  Var<T, WS, PREFS, WRITE>& dst = (obj.*(f.member));
+  Var<T, WS, PREFS, WRITE, NOTIFY, GATE>& dst = (obj.*(f.member));
 
   if (v.is<JsonObject>()) {
     JsonObject o = v.as<JsonObject>();
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ArduinoJson.h>
+#include <type_traits>
+#include <utility>
+
+#include "Var.h"
+#include "VarFieldIo.h"
+#include "../serializer/Schema.h"
+#include "../types/ModelTypeTraits.h"
+
+namespace fj {
+
+// ---- Delta (patch) writer ----
+// Emits only the Var fields whose generation() is newer than `since`, using the same
+// WS policy as writeOne(). Plain members, FieldStr and Buttons carry no generation and
+// are left out of patches (buttons are static; plain members need a full broadcastTopic()).
+
+// Var fields: tracked
+template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
+inline bool writePatchOne(const ObjT& obj, const Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>>& f, JsonObject out,
+                          uint32_t since) {
+  const Var<T, WS, PREFS, WRITE, NOTIFY, GATE>& v = (obj.*(f.member));
+  if (changedSince(v.generation(), since)) {
+    LOG_TRACE_F("[writePatchOne] key='%s' changed (gen=%u > %u)", f.key, (unsigned)v.generation(), (unsigned)since);
+    writeOne(obj, f, out);
+  }
+  return true;
+}
+
+// Everything else: untracked
+template <typename ObjT, typename MemberT>
+inline bool writePatchOne(const ObjT&, const Field<ObjT, MemberT>&, JsonObject, uint32_t) {
+  return false;
+}
+
+template <typename ObjT, size_t N>
+inline bool writePatchOne(const ObjT&, const FieldStr<ObjT, N>&, JsonObject, uint32_t) {
+  return false;
+}
+
+template <typename T>
+struct WriterPatch {
+  const T& obj;
+  JsonObject out;
+  uint32_t since;
+  size_t tracked;
+  WriterPatch(const T& o, JsonObject jo, uint32_t s) : obj(o), out(jo), since(s), tracked(0) {}
+  template <typename F>
+  void operator()(const F& f) {
+    if (writePatchOne(obj, f, out, since)) tracked++;
+  }
+};
+
+namespace detail {
+
+template <typename T, typename... Fs>
+inline bool write_ws_patch_fields(const T& obj, const Schema<T, Fs...>& schema, JsonObject out, uint32_t since) {
+  WriterPatch<T> w(obj, out, since);
+  tuple_for_each(schema.fields, w);
+  return w.tracked > 0;
+}
+
+template <typename T>
+inline bool write_ws_patch_impl(const T& obj, JsonObject out, uint32_t since, std::true_type /*patchable*/) {
+  return write_ws_patch_fields(obj, T::schema(), out, since);
+}
+
+template <typename T>
+inline bool write_ws_patch_impl(const T&, JsonObject, uint32_t, std::false_type /*patchable*/) {
+  return false;
+}
+
+} // namespace detail
+
+// Write the WS fields of `obj` that changed after change-clock tick `since` (see currentGeneration()).
+// Returns false if T cannot be patched (no schema, custom TypeAdapter::write_ws or no Var fields);
+// the caller then has to send the full write_ws() representation instead.
+template <typename T>
+inline bool write_ws_patch(const T& obj, JsonObject out, uint32_t since) {
+  typedef std::integral_constant<bool, detail::has_schema<T>::value && !HasWriteWs<T>::value> Patchable;
+  return detail::write_ws_patch_impl(obj, out, since, Patchable());
+}
+
+} // namespace fj
@@ -15,9 +15,14 @@ namespace fj {
 //
 // - WriteMode::On:  accept incoming remote updates
 // - WriteMode::Off: treat as read-only
+//
+// - NotifyMode::Always:   every set() notifies (save callback, change clock)
+// - NotifyMode::OnChange: set() with the current value is a no-op (strcmp for string-like
+//                         values, memcmp for trivially copyable ones)
 
 enum class WsMode    : uint8_t { Value, Meta, None };
 enum class PrefsMode : uint8_t { On, Off };
 enum class WriteMode : uint8_t { On, Off };
+enum class NotifyMode : uint8_t { Always, OnChange };
 
 } // namespace fj
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+
+#include "Var.h"
+#include "../serializer/JsonScanner.h"
+#include "../serializer/Schema.h"
+#include "../types/ModelTypeTraits.h"
+
+// Longest schema key scan_update() can match (including the terminator).
+#ifndef MODEL_SCAN_KEY_LEN
+#define MODEL_SCAN_KEY_LEN 32
+#endif
+
+// Forward declarations: the readers below only need the complete types when a topic
+// actually contains such a field (and then the topic header already includes them).
+template <size_t N>
+struct StringBuffer;
+template <typename T, size_t N>
+struct List;
+
+namespace fj {
+
+// ============================================================================
+// scan_update(): apply a WS "data" object straight from its JSON text
+// ============================================================================
+// Schema-driven counterpart of TypeAdapter<T>::read(obj, in, false) that walks the message with
+// JsonScanner instead of a JsonDocument: keys are matched against the schema and the values
+// written like readOne() does (scalars and strings raw into the value, no notification).
+//
+// Handled per field (everything else makes the whole update Unsupported):
+//   Var<arithmetic|bool|StringBuffer<N>>  as plain value or {"value": ...}
+//   Var<List<arithmetic|StringBuffer, N>>  as [..] or {"items": [..]}
+//   plain arithmetic / StringBuffer<N> members, FieldStr
+//   WriteMode::Off fields and unknown keys are skipped, null leaves a field unchanged.
+// Conversions must be exact (integral JSON numbers for integer fields, strings for strings).
+//
+// The message is scanned twice: a dry run first, so a Unsupported / Invalid result never
+// leaves the object half updated.
+
+enum class ScanResult : uint8_t { Applied, Unsupported, Invalid };
+
+namespace detail {
+
+// ---- Values ----
+// read(sc, dst): dst == nullptr validates only. false = wrong JSON kind (or scanner failed).
+
+template <typename V, typename Enable = void>
+struct ScanValue {
+  static const bool supported = false;
+  static bool read(JsonScanner&, V*) { return false; }
+};
+
+template <typename V>
+struct ScanValue<V, typename std::enable_if<std::is_arithmetic<V>::value && !std::is_same<V, bool>::value>::type> {
+  static const bool supported = true;
+  static bool read(JsonScanner& sc, V* dst) {
+    if (sc.peek() != JsonScanner::Kind::Number) return false;
+    JsonScanner::Number num;
+    V v;
+    if (!sc.readNumber(num) || !num.to(v)) return false;
+    if (dst) *dst = v;
+    return true;
+  }
+};
+
+template <>
+struct ScanValue<bool> {
+  static const bool supported = true;
+  static bool read(JsonScanner& sc, bool* dst) {
+    const JsonScanner::Kind k = sc.peek();
+    if (k != JsonScanner::Kind::True && k != JsonScanner::Kind::False) return false;
+    bool v = false;
+    if (!sc.readBool(v)) return false;
+    if (dst) *dst = v;
+    return true;
+  }
+};
+
+template <size_t N>
+struct ScanValue<StringBuffer<N>> {
+  static const bool supported = true;
+  static bool read(JsonScanner& sc, StringBuffer<N>* dst) {
+    if (sc.peek() != JsonScanner::Kind::String) return false;
+    return sc.readString(dst ? dst->data() : nullptr, dst ? N : 0);
+  }
+};
+
+// Same as List::read: cleared, then filled up to N items; the rest is ignored.
+template <typename T, size_t N>
+struct ScanValue<List<T, N>> {
+  static const bool supported = ScanValue<T>::supported;
+  static bool read(JsonScanner& sc, List<T, N>* dst) {
+    if (sc.peek() != JsonScanner::Kind::Array || !sc.beginArray()) return false;
+    if (dst) dst->clear();
+    while (sc.nextItem()) {
+      if (dst && dst->count < N) {
+        T item;
+        if (!ScanValue<T>::read(sc, &item)) return false;
+        dst->add(item);
+      } else if (!ScanValue<T>::read(sc, nullptr)) {
+        return false;
+      }
+    }
+    return !sc.failed();
+  }
+};
+
+template <typename V>
+struct is_scan_list : std::false_type {};
+template <typename T, size_t N>
+struct is_scan_list<List<T, N>> : std::true_type {};
+
+// ---- Var values: wrapper objects ----
+
+// Scalars / strings: {"value": x}, other keys ignored; no "value" or null leaves the field as is.
+template <typename V>
+inline bool scanVarValue(JsonScanner& sc, V* dst, std::false_type /*list*/) {
+  if (sc.peek() != JsonScanner::Kind::Object) return ScanValue<V>::read(sc, dst);
+  if (!sc.beginObject()) return false;
+  char key[8];
+  size_t keyLen = 0;
+  while (sc.nextKey(key, sizeof(key), &keyLen)) {
+    const bool isValue = keyLen == 5 && std::strcmp(key, "value") == 0;
+    bool ok;
+    if (!isValue) ok = sc.skipValue();
+    else if (sc.peek() == JsonScanner::Kind::Null) ok = sc.readNull();
+    else ok = ScanValue<V>::read(sc, dst);
+    if (!ok) return false;
+  }
+  return !sc.failed();
+}
+
+// Lists: [..] or {"items": [..]} (the shape write_ws produces); a "value" key is not handled.
+template <typename V>
+inline bool scanVarValue(JsonScanner& sc, V* dst, std::true_type /*list*/) {
+  if (sc.peek() != JsonScanner::Kind::Object) return ScanValue<V>::read(sc, dst);
+  if (!sc.beginObject()) return false;
+  char key[8];
+  size_t keyLen = 0;
+  while (sc.nextKey(key, sizeof(key), &keyLen)) {
+    bool ok;
+    if (keyLen == 5 && std::strcmp(key, "value") == 0) return false;
+    if (keyLen == 5 && std::strcmp(key, "items") == 0) {
+      ok = sc.peek() == JsonScanner::Kind::Null ? sc.readNull() : ScanValue<V>::read(sc, dst);
+    } else {
+      ok = sc.skipValue();
+    }
+    if (!ok) return false;
+  }
+  return !sc.failed();
+}
+
+// ---- Fields ----
+
+template <typename F>
+struct ScanField {
+  static const bool supported = false;
+};
+
+// Plain member
+template <typename ObjT, typename M>
+struct ScanField<Field<ObjT, M>> {
+  static const bool supported = ScanValue<M>::supported && !is_scan_list<M>::value;
+  static bool read(ObjT& obj, const Field<ObjT, M>& f, JsonScanner& sc, bool commit) {
+    if (sc.peek() == JsonScanner::Kind::Null) return sc.readNull();
+    return ScanValue<M>::read(sc, commit ? &(obj.*(f.member)) : nullptr);
+  }
+};
+
+// Var<> member: WriteMode::Off fields are skipped like readOne() does
+template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
+struct ScanField<Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>>> {
+  typedef Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>> F;
+  static const bool supported = ScanValue<T>::supported;
+  static bool read(ObjT& obj, const F& f, JsonScanner& sc, bool commit) {
+    if (WRITE == WriteMode::Off) return sc.skipValue();
+    if (sc.peek() == JsonScanner::Kind::Null) return sc.readNull();
+    T* dst = commit ? &(obj.*(f.member)).get() : nullptr;
+    return scanVarValue(sc, dst, is_scan_list<T>());
+  }
+};
+
+template <typename ObjT, size_t N>
+struct ScanField<FieldStr<ObjT, N>> {
+  static const bool supported = true;
+  static bool read(ObjT& obj, const FieldStr<ObjT, N>& f, JsonScanner& sc, bool commit) {
+    const JsonScanner::Kind k = sc.peek();
+    if (k == JsonScanner::Kind::Null) return sc.readNull();
+    if (k != JsonScanner::Kind::String) return false;
+    return sc.readString(commit ? (obj.*(f.member)) : nullptr, commit ? N : 0);
+  }
+};
+
+// Unsupported field types only fail when the message actually contains their key.
+template <typename ObjT, typename F>
+inline bool scanFieldRead(ObjT& obj, const F& f, JsonScanner& sc, bool commit, std::true_type) {
+  return ScanField<F>::read(obj, f, sc, commit);
+}
+
+template <typename ObjT, typename F>
+inline bool scanFieldRead(ObjT&, const F&, JsonScanner&, bool, std::false_type) {
+  return false;
+}
+
+// ---- Key dispatch (tuple_for_each functor) ----
+
+template <typename T>
+struct ScanDispatcher {
+  T& obj;
+  JsonScanner& sc;
+  const char* key;
+  bool commit;
+  bool matched;
+  bool ok;
+  ScanDispatcher(T& o, JsonScanner& s, const char* k, bool c)
+      : obj(o), sc(s), key(k), commit(c), matched(false), ok(true) {}
+  template <typename F>
+  void operator()(const F& f) {
+    if (matched || std::strcmp(f.key, key) != 0) return;
+    matched = true;
+    ok = scanFieldRead(obj, f, sc, commit, std::integral_constant<bool, ScanField<F>::supported>());
+  }
+};
+
+template <typename T>
+inline ScanResult scan_pass(T& obj, const char* json, size_t len, bool commit) {
+  JsonScanner sc(json, len);
+  if (!sc.beginObject()) return ScanResult::Invalid;
+
+  char key[MODEL_SCAN_KEY_LEN];
+  size_t keyLen = 0;
+  while (sc.nextKey(key, sizeof(key), &keyLen)) {
+    ScanDispatcher<T> d(obj, sc, key, commit);
+    // Longer keys cannot match a field (and must not match by their truncated prefix).
+    if (keyLen < sizeof(key)) tuple_for_each(T::schema().fields, d);
+    if (!d.matched) d.ok = sc.skipValue();
+    if (!d.ok) return sc.failed() ? ScanResult::Invalid : ScanResult::Unsupported;
+  }
+  if (sc.failed() || !sc.finish()) return ScanResult::Invalid;
+  return ScanResult::Applied;
+}
+
+template <typename T>
+inline ScanResult scan_update_impl(T& obj, const char* json, size_t len, std::true_type) {
+  const ScanResult dry = scan_pass(obj, json, len, false);
+  if (dry != ScanResult::Applied) return dry;
+  return scan_pass(obj, json, len, true);
+}
+
+template <typename T>
+inline ScanResult scan_update_impl(T&, const char*, size_t, std::false_type) {
+  return ScanResult::Unsupported;
+}
+
+} // namespace detail
+
+// Topics scan_update() can handle at all: schema types using the generic TypeAdapter.
+template <typename T>
+struct ScanUpdate {
+  static const bool supported = detail::has_schema<T>::value && !HasWriteWs<T>::value;
+};
+
+// Apply the JSON object text `json` (the "data" member of a WS update) to obj.
+// Applied: done. Unsupported: a field/value shape the scanner does not handle, nothing changed;
+// use TypeAdapter<T>::read instead. Invalid: malformed JSON, nothing changed.
+template <typename T>
+inline ScanResult scan_update(T& obj, const char* json, size_t len) {
+  return detail::scan_update_impl(obj, json, len, std::integral_constant<bool, ScanUpdate<T>::supported>());
+}
+
+} // namespace fj
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cmath>
+#include <type_traits>
+
+#include "VarPolicy.h"
+#include "../serializer/Schema.h"
+
+namespace fj {
+
+// ---- Notification gates: rate limit and deadband per field ----
+// Last template parameter of Var<>. The gate sits between set() and the change notification
+// (change clock + save callback), so a held-back value is neither saved nor broadcast.
+//
+//   Var<float, WsMode::Value, PrefsMode::Off, WriteMode::Off, NotifyMode::Always, Throttle<100, 100>>
+//     at most one notification per 100 ms, and only when the value moved by >= 0.1
+//
+// Throttle<IntervalMs, AbsMilli, RelPermille, Trailing>
+//   IntervalMs   minimum time between two notifications (0 = no rate limit)
+//   AbsMilli     absolute deadband in thousandths of the value's unit (100 = 0.1)
+//   RelPermille  relative deadband in permille of the last notified value (10 = 1 %)
+//   Trailing     a change held back by the rate limit is delivered by poll() once the interval
+//                has passed (ModelBase::loop() polls registered topics); false drops it
+//
+// The larger of the two deadbands applies; values within it are dropped, not delayed. The first
+// set() always notifies, touch() always notifies. Deadbands need an arithmetic T. NoThrottle (the
+// default) is an empty base class: fields without a gate cost nothing.
+
+struct NoThrottle {
+  static const bool enabled = false;
+
+  template <typename T>
+  struct State {
+    bool gateAdmit_(const T&, uint32_t) { return true; }
+    void gateSent_(const T&, uint32_t) {}
+    bool gateDue_(const T&, uint32_t) { return false; }
+  };
+};
+
+template <uint32_t IntervalMs, uint32_t AbsMilli = 0, uint32_t RelPermille = 0, bool Trailing = true>
+struct Throttle {
+  static const bool enabled = true;
+  static const bool hasDeadband = AbsMilli > 0 || RelPermille > 0;
+
+  template <typename T>
+  struct State {
+    static_assert(!hasDeadband || std::is_arithmetic<T>::value, "fj::Throttle: deadbands need an arithmetic value");
+    // float math on the ESP32 FPU, double only where float would lose precision
+    typedef typename std::conditional<(sizeof(T) > 4), double, float>::type Real;
+
+    T sent_ = T();
+    uint32_t sentMs_ = 0;
+    bool primed_ = false;
+    bool pending_ = false;
+
+    bool withinDeadband_(const T& v, std::true_type) const {
+      const Real delta = std::fabs((Real)v - (Real)sent_);
+      const Real absBand = (Real)AbsMilli / (Real)1000;
+      const Real relBand = std::fabs((Real)sent_) * (Real)RelPermille / (Real)1000;
+      return delta < (absBand > relBand ? absBand : relBand);
+    }
+    bool withinDeadband_(const T&, std::false_type) const { return false; }
+
+    // true: notify now. false: dropped (deadband) or held back (rate limit, pending_ if Trailing).
+    bool gateAdmit_(const T& v, uint32_t now) {
+      if (primed_) {
+        if (withinDeadband_(v, std::integral_constant<bool, hasDeadband>())) {
+          pending_ = false;  // back near the last notified value: nothing left to deliver
+          return false;
+        }
+        if (IntervalMs > 0 && (uint32_t)(now - sentMs_) < IntervalMs) {
+          pending_ = Trailing;
+          return false;
+        }
+      }
+      gateSent_(v, now);
+      return true;
+    }
+
+    void gateSent_(const T& v, uint32_t now) {
+      sent_ = v;
+      sentMs_ = now;
+      primed_ = true;
+      pending_ = false;
+    }
+
+    // Trailing edge: a held-back change whose interval has passed.
+    bool gateDue_(const T& v, uint32_t now) {
+      if (!pending_ || (uint32_t)(now - sentMs_) < IntervalMs) return false;
+      gateSent_(v, now);
+      return true;
+    }
+  };
+};
+
+// Deadband only, no rate limit.
+template <uint32_t AbsMilli, uint32_t RelPermille = 0>
+using Deadband = Throttle<0, AbsMilli, RelPermille, false>;
+
+template <typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
+class Var;
+
+// ---- Topic-level support: which schema topics need poll_throttled() ----
+
+namespace detail {
+
+template <typename F>
+struct field_throttled : std::false_type {};
+
+template <typename ObjT, typename T, WsMode WS, PrefsMode PREFS, WriteMode WRITE, NotifyMode NOTIFY, typename GATE>
+struct field_throttled<Field<ObjT, Var<T, WS, PREFS, WRITE, NOTIFY, GATE>>>
+    : std::integral_constant<bool, GATE::enabled> {};
+
+template <typename... Fs>
+struct any_throttled : std::false_type {};
+
+template <typename F, typename... Rest>
+struct any_throttled<F, Rest...>
+    : std::integral_constant<bool, field_throttled<F>::value || any_throttled<Rest...>::value> {};
+
+template <typename SchemaT>
+struct schema_throttled : std::false_type {};
+
+template <typename T, typename... Fs>
+struct schema_throttled<Schema<T, Fs...>> : any_throttled<Fs...> {};
+
+template <typename T, bool HAS_SCHEMA>
+struct ThrottledOf : std::false_type {};
+
+template <typename T>
+struct ThrottledOf<T, true> : schema_throttled<typename std::decay<decltype(T::schema())>::type> {};
+
+template <typename T>
+struct ThrottlePoller {
+  T& obj;
+  size_t delivered;
+  explicit ThrottlePoller(T& o) : obj(o), delivered(0) {}
+
+  template <typename F>
+  void operator()(const F& f) {
+    poll(f, field_throttled<F>());
+  }
+  template <typename F>
+  void poll(const F& f, std::true_type) {
+    if ((obj.*(f.member)).poll()) delivered++;
+  }
+  template <typename F>
+  void poll(const F&, std::false_type) {}
+};
+
+} // namespace detail
+
+// Schema topics with at least one gated Var field.
+template <typename T>
+struct Throttled {
+  static const bool value = detail::ThrottledOf<T, detail::has_schema<T>::value>::value;
+};
+
+namespace detail {
+template <typename T>
+inline size_t poll_throttled_impl(T& obj, std::true_type) {
+  ThrottlePoller<T> p(obj);
+  tuple_for_each(T::schema().fields, p);
+  return p.delivered;
+}
+
+template <typename T>
+inline size_t poll_throttled_impl(T&, std::false_type) {
+  return 0;
+}
+} // namespace detail
+
+// Delivers the trailing-edge notifications that are due. Returns how many fields notified.
+template <typename T>
+inline size_t poll_throttled(T& obj) {
+  return detail::poll_throttled_impl(obj, std::integral_constant<bool, Throttled<T>::value>());
+}
+
+} // namespace fj
@@ -0,0 +1,316 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <ArduinoJson.h>
+
+#include "../../src/AdminModel.h"
+
+#include <functional>
+
+#ifdef NATIVE_BUILD
+#include <chrono>
+#endif
+
+// Serializer micro-benchmarks (enabled with -DMODEL_BENCH, see env:bench_esp32s3 / env:bench_native).
+//
+// Times encode/decode of realistic topics through the same entry points ModelBase uses
+// (makeEnvelope, makeDataOnlyJson, applyUpdateJson/applyUpdate, scan_update) plus the raw fj:: writers/readers.
+// Reports ns/op, bytes produced (or consumed) and the ArduinoJson pool usage of the document.
+//
+// Timing: CPU cycle counter on the ESP32, steady_clock on the host.
+
+#ifndef MODEL_BENCH_TARGET_MS
+#define MODEL_BENCH_TARGET_MS 200
+#endif
+
+namespace SerializerBench {
+
+// ---------------------------------------------------------------------------
+// Clock
+// ---------------------------------------------------------------------------
+
+struct Stopwatch {
+#ifdef NATIVE_BUILD
+  std::chrono::steady_clock::time_point t0;
+  void start() { t0 = std::chrono::steady_clock::now(); }
+  uint64_t elapsedNs() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+  }
+#else
+  // 32-bit cycle counter wraps after ~17s at 240 MHz; a single measurement stays far below that.
+  uint32_t c0 = 0;
+  void start() { c0 = ESP.getCycleCount(); }
+  uint64_t elapsedNs() const {
+    const uint32_t cycles = ESP.getCycleCount() - c0;
+    return (uint64_t)cycles * 1000ULL / (uint64_t)getCpuFrequencyMhz();
+  }
+#endif
+};
+
+// Runs fn until roughly MODEL_BENCH_TARGET_MS have elapsed and returns ns/op.
+template <typename Fn>
+inline uint64_t measureNsPerOp(Fn fn, uint32_t& iterationsOut) {
+  Stopwatch sw;
+
+  // Warm-up + calibration (first call also populates static docs / schemas).
+  fn();
+  sw.start();
+  fn();
+  uint64_t once = sw.elapsedNs();
+  if (once == 0) once = 1;
+
+  uint64_t iters = ((uint64_t)MODEL_BENCH_TARGET_MS * 1000000ULL) / once;
+  if (iters < 10) iters = 10;
+  if (iters > 100000) iters = 100000;
+
+  sw.start();
+  for (uint64_t i = 0; i < iters; ++i) fn();
+  const uint64_t total = sw.elapsedNs();
+
+  iterationsOut = (uint32_t)iters;
+  yield();
+  return total / iters;
+}
+
+inline void report(const char* topic, const char* op, uint32_t iterations, uint64_t nsPerOp, size_t bytes, size_t pool,
+                   bool overflowed) {
+  LOG_INFO_F("[Bench] %-6s %-12s %7u it %10llu ns/op %7u B %7u pool%s", topic, op, (unsigned)iterations,
+             (unsigned long long)nsPerOp, (unsigned)bytes, (unsigned)pool, overflowed ? " OVERFLOW" : "");
+}
+
+// ---------------------------------------------------------------------------
+// Fixtures
+// ---------------------------------------------------------------------------
+
+class BenchModel : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+static const size_t GRAPH_POINTS = 256;
+
+struct Fixtures {
+  WifiSettings wifi;
+  OTASettings ota;
+  PointRingBuffer<GRAPH_POINTS> graph;
+
+  Fixtures() : graph("bench", "temp") {
+    wifi.ssid = "BenchNetwork-5G";
+    wifi.ap_ssid = "ESP32-Setup";
+    wifi.pass = "correct horse battery staple";
+    wifi.log_level = 2;
+    for (int i = 0; i < WifiSettings::MAX_NETWORKS; ++i) {
+      char name[WifiSettings::SSID_LEN];
+      snprintf(name, sizeof(name), "Neighbour-%02d", i);
+      wifi.available_networks.get().add(StringBuffer<WifiSettings::SSID_LEN>(name));
+    }
+
+    ota.ota_pass = "Ota-Bench-Pass-123";
+    ota.window_seconds = 600;
+    ota.remaining_seconds = 421;
+
+    for (size_t i = 0; i < GRAPH_POINTS; ++i) {
+      graph.push((uint64_t)1700000000000ULL + i * 1000ULL, 20.0f + (float)(i % 50) * 0.25f);
+    }
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Per-topic run
+// ---------------------------------------------------------------------------
+
+// fj::BinaryLayout save/load (PrefsFormat::Binary), only for topics with a fixed layout.
+template <typename T>
+inline void benchBinaryLayout(const char* topic, T& obj, std::true_type) {
+  typedef fj::BinaryLayout<T> Layout;
+  static uint8_t buf[Layout::size ? Layout::size : 1];
+  uint32_t iters = 0;
+  uint64_t ns = measureNsPerOp([&]() { (void)Layout::write(obj, buf, sizeof(buf)); }, iters);
+  report(topic, "prefs_bin", iters, ns, Layout::size, 0, false);
+  ns = measureNsPerOp([&]() { (void)Layout::read(obj, buf, Layout::size); }, iters);
+  report(topic, "load_bin", iters, ns, Layout::size, 0, false);
+}
+
+template <typename T>
+inline void benchBinaryLayout(const char*, T&, std::false_type) {}
+
+// fj::scan_update straight from the text (WS update fast path), only for scannable topics.
+template <typename T>
+inline void benchScan(const char* topic, T& obj, const String& json, std::true_type) {
+  const fj::ScanResult result = fj::scan_update(obj, json.c_str(), json.length());
+  if (result != fj::ScanResult::Applied) {
+    // e.g. Button objects in the Prefs payload; the UI only sends plain values
+    LOG_INFO_F("[Bench] %-6s %-12s payload takes the JsonDocument path (%u)", topic, "scan_apply", (unsigned)result);
+    return;
+  }
+  uint32_t iters = 0;
+  uint64_t ns = measureNsPerOp([&]() { (void)fj::scan_update(obj, json.c_str(), json.length()); }, iters);
+  report(topic, "scan_apply", iters, ns, json.length(), 0, false);
+}
+
+template <typename T>
+inline void benchScan(const char*, T&, const String&, std::false_type) {}
+
+template <typename T>
+inline void benchTopic(BenchModel& model, const char* topic, T& obj) {
+  static StaticJsonDocument<ModelBase::JSON_CAPACITY> doc;
+  uint32_t iters = 0;
+  uint64_t ns = 0;
+
+  // fj::write_ws into a document (no serialization)
+  ns = measureNsPerOp([&]() {
+    doc.clear();
+    JsonObject root = doc.to<JsonObject>();
+    fj::write_ws(obj, root);
+  }, iters);
+  report(topic, "write_ws", iters, ns, measureJson(doc), doc.memoryUsage(), doc.overflowed());
+  const size_t wsPool = doc.memoryUsage();
+  const bool wsOverflow = doc.overflowed();
+
+  // ModelBase::makeEnvelope (doc + measure + serialize to String)
+  String envelope;
+  ns = measureNsPerOp([&]() { envelope = model.testMakeEnvelope(topic); }, iters);
+  report(topic, "envelope", iters, ns, envelope.length(), wsPool, wsOverflow);
+
+  // ModelBase::makeDataOnlyJson (Prefs payload)
+  String prefsJson;
+  ns = measureNsPerOp([&]() { prefsJson = model.testMakeDataOnlyJson(topic); }, iters);
+  doc.clear();
+  JsonObject prefsRoot = doc.to<JsonObject>();
+  fj::write_prefs(obj, prefsRoot);
+  report(topic, "prefs_json", iters, ns, prefsJson.length(), doc.memoryUsage(), doc.overflowed());
+
+  // MessagePack Prefs payload (ModelBase::PrefsFormat::MsgPack, without the version tag)
+  static uint8_t packed[ModelBase::JSON_CAPACITY];
+  size_t packedLen = 0;
+  ns = measureNsPerOp([&]() {
+    doc.clear();
+    JsonObject root = doc.to<JsonObject>();
+    fj::write_prefs(obj, root);
+    packedLen = serializeMsgPack(doc, packed, sizeof(packed));
+  }, iters);
+  report(topic, "prefs_mpack", iters, ns, packedLen, doc.memoryUsage(), doc.overflowed());
+
+  // Decode paths use the Prefs payload as input (what loadEntry() and the UI send back).
+  doc.clear();
+  DeserializationError err = deserializeJson(doc, prefsJson);
+  if (err) {
+    LOG_WARN_F("[Bench] %s: prefs payload does not parse (%s), skipping decode", topic, err.c_str());
+    return;
+  }
+  const size_t parsedPool = doc.memoryUsage();
+  JsonObject parsed = doc.as<JsonObject>();
+
+  // fj::TypeAdapter<T>::read (readFieldsTolerant for schema topics)
+  ns = measureNsPerOp([&]() { (void)fj::TypeAdapter<T>::read(obj, parsed, false); }, iters);
+  report(topic, "read", iters, ns, prefsJson.length(), parsedPool, false);
+
+  // ModelBase applyUpdateJsonImpl (WS update path after parsing)
+  ns = measureNsPerOp([&]() { (void)model.testApplyUpdateJson(topic, parsed); }, iters);
+  report(topic, "apply_json", iters, ns, prefsJson.length(), parsedPool, false);
+
+  // ModelBase applyUpdateImpl (deserializeJson + read, Prefs load path)
+  ns = measureNsPerOp([&]() { (void)model.testApplyUpdate(topic, prefsJson); }, iters);
+  report(topic, "parse_apply", iters, ns, prefsJson.length(), parsedPool, false);
+
+  // Same payload without a document (compare with parse_apply)
+  benchScan(topic, obj, prefsJson, std::integral_constant<bool, fj::ScanUpdate<T>::supported>());
+
+  // MessagePack load path (deserializeMsgPack + read), compare with parse_apply
+  static StaticJsonDocument<ModelBase::JSON_CAPACITY> packedDoc;
+  ns = measureNsPerOp([&]() {
+    packedDoc.clear();
+    if (!deserializeMsgPack(packedDoc, packed, packedLen)) {
+      (void)fj::TypeAdapter<T>::read(obj, packedDoc.as<JsonObject>(), false);
+    }
+  }, iters);
+  report(topic, "parse_mpack", iters, ns, packedLen, packedDoc.memoryUsage(), false);
+
+  benchBinaryLayout(topic, obj, std::integral_constant<bool, fj::BinaryLayout<T>::supported>());
+}
+
+// ---------------------------------------------------------------------------
+// Change callbacks: fj::Callback vs std::function (RAM per Var and call cost)
+// ---------------------------------------------------------------------------
+
+inline void benchCallbacks() {
+  static volatile uint32_t hits = 0;
+  struct Owner {
+    uint16_t tid;
+    void onChange() { hits = hits + tid; }
+  } owner = {1};
+  Owner* self = &owner;
+  const uint16_t tid = 1;
+
+  // Same capture as ModelBase::maybeAttachSaveCallback ([this, tid]).
+  std::function<void()> stdFn = [self, tid]() { self->onChange(); (void)tid; };
+  fj::Callback delegate = [self, tid]() { self->onChange(); (void)tid; };
+
+  uint32_t iters = 0;
+  uint64_t ns = measureNsPerOp([&]() { stdFn(); }, iters);
+  report("cb", "std_function", iters, ns, sizeof(stdFn), 0, false);
+  ns = measureNsPerOp([&]() { delegate(); }, iters);
+  report("cb", "fj_callback", iters, ns, sizeof(delegate), 0, false);
+
+  // One Var with a save callback, as every persisted field of a topic carries.
+  fj::VarWsPrefsRw<int> var;
+  var.setOnChange(delegate);
+  int v = 0;
+  ns = measureNsPerOp([&]() { var.set(++v); }, iters);
+  report("cb", "var_set", iters, ns, sizeof(var), 0, false);
+}
+
+// Producer side of one log call with the async ring: eager formatting (what Logger::vlogf does)
+// vs. a deferred LogRecord. The ring is emptied every 32 calls by a consumer that discards.
+inline void benchLogRecords() {
+  static LogRing ring(8192);
+  const char* fmt = "[WS] Applying update for topic: %s (tid=%d, %u bytes)";
+  const char* topic = "wifi";
+  uint32_t i = 0;
+  auto discard = [](uint8_t, const char*, size_t) {};
+
+  uint32_t iters = 0;
+  uint64_t ns = measureNsPerOp([&]() {
+    char line[LOG_LINE_LEN];
+    const int n = snprintf(line, sizeof(line), fmt, topic, (int)(i & 7), (unsigned)i);
+    (void)ring.push((uint8_t)LogLevel::DEBUG, line, (size_t)n);
+    if ((++i & 31) == 0) ring.drain(discard);
+  }, iters);
+  report("log", "eager_format", iters, ns, 0, 0, false);
+
+  uint8_t rec[LOG_LINE_LEN];
+  size_t recLen = 0;
+  ns = measureNsPerOp([&]() {
+    recLen = LogRecord::encode(rec, sizeof(rec), fmt, i, topic, (int)(i & 7), (unsigned)i);
+    (void)ring.push((uint8_t)(Logger::TAG_DEFERRED | (uint8_t)LogLevel::DEBUG), rec, recLen);
+    if ((++i & 31) == 0) ring.drain(discard);
+  }, iters);
+  report("log", "deferred_record", iters, ns, recLen, 0, false);
+
+  char line[LOG_LINE_LEN];
+  ns = measureNsPerOp([&]() { (void)LogRecord::format(line, sizeof(line), rec, recLen); }, iters);
+  report("log", "deferred_format", iters, ns, 0, 0, false);
+  ring.drain(discard);
+}
+
+inline void runAll() {
+  SUITE_START("SERIALIZER BENCH");
+  LOG_INFO_F("[Bench] JSON_CAPACITY=%u, target=%u ms per case, LOG_MIN_LEVEL=%d", (unsigned)ModelBase::JSON_CAPACITY,
+             (unsigned)MODEL_BENCH_TARGET_MS, (int)LOG_MIN_LEVEL);
+
+  static Fixtures fx;
+  BenchModel model(80, "/bench_ws", "bench");
+  // No persistence / broadcast: only the serializer work is timed.
+  model.registerTopic("wifi", fx.wifi, false, false);
+  model.registerTopic("ota", fx.ota, false, false);
+  model.registerTopic("graph", fx.graph, false, false);
+
+  benchTopic(model, "wifi", fx.wifi);
+  benchTopic(model, "ota", fx.ota);
+  benchTopic(model, "graph", fx.graph);
+  benchCallbacks();
+  benchLogRecords();
+}
+
+} // namespace SerializerBench
@@ -10,8 +10,22 @@
 #include "model_type_test/test_graph_var_sync.h"
 #include "model_type_test/test_modelbase_prefs.h"
 #include "model_type_test/test_modelbase_ws_update.h"
+#include "model_type_test/test_json_scanner.h"
+#include "model_type_test/test_topic_index.h"
+#include "model_type_test/test_binary_layout.h"
+#include "model_type_test/test_graph_ws.h"
+#include "model_type_test/test_ws_backpressure.h"
+#include "model_type_test/test_ws_hub.h"
+#include "model_type_test/test_callback.h"
+#include "model_type_test/test_var_throttle.h"
+#include "model_type_test/test_logger.h"
+#include "model_type_test/test_log_stream.h"
+#include "model_type_test/test_metrics.h"
 #include "model_type_test/test_wifi_integration.h"
 #include "button_system_test.h"
+#ifdef MODEL_BENCH
+#include "bench/serializer_bench.h"
+#endif
 
 // Forward declarations for button and password tests
 namespace ButtonSystemTest { void runAllTests(); }
@@ -62,6 +76,17 @@ void setup() {
   GraphVarSyncTest::runAllTests();
   ModelBasePrefsTest::runAllTests();
   ModelBaseWsUpdateTest::runAllTests();
+  JsonScannerTest::runAllTests();
+  TopicIndexTest::runAllTests();
+  BinaryLayoutTest::runAllTests();
+  GraphWsTest::runAllTests();
+  WsBackpressureTest::runAllTests();
+  WsHubTest::runAllTests();
+  CallbackTest::runAllTests();
+  VarThrottleTest::runAllTests();
+  LoggerTest::runAllTests();
+  LogStreamTest::runAllTests();
+  MetricsTest::runAllTests();
   ButtonSystemTest::runAllTests();
   ModelPasswordTest::runAllTests();
   // WiFi integration tests  
@@ -88,6 +113,10 @@ void setup() {
     LOG_ERROR("SOME TESTS FAILED");
   }
   LOG_INFO("========================================");
+
+#ifdef MODEL_BENCH
+  SerializerBench::runAll();
+#endif
 }
 
 void loop() {
@@ -0,0 +1,243 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <Preferences.h>
+
+#include "../../src/model/ModelBase.h"
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/types/ModelTypePrimitive.h"
+#include "../../src/model/types/ModelTypeButton.h"
+#include "../../src/model/types/ModelTypeList.h"
+
+namespace BinaryLayoutTest {
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+// Config-style topic: everything has a fixed size.
+struct PodTopic {
+  fj::VarWsPrefsRw<StringBuffer<16>> name;
+  fj::VarWsPrefsRw<int> window;
+  fj::VarWsRo<int> remaining;           // PrefsMode::Off: not in the Prefs layout
+  fj::VarMetaPrefsRw<StringBuffer<8>> secret;
+  fj::VarWsPrefsRw<bool> enabled;
+  fj::VarWsPrefsRw<float> gain;
+  Button reset;
+
+  typedef fj::Schema<PodTopic,
+                     fj::Field<PodTopic, decltype(name)>,
+                     fj::Field<PodTopic, decltype(window)>,
+                     fj::Field<PodTopic, decltype(remaining)>,
+                     fj::Field<PodTopic, decltype(secret)>,
+                     fj::Field<PodTopic, decltype(enabled)>,
+                     fj::Field<PodTopic, decltype(gain)>,
+                     fj::Field<PodTopic, Button>>
+      SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<PodTopic>(
+        fj::Field<PodTopic, decltype(name)>{"name", &PodTopic::name},
+        fj::Field<PodTopic, decltype(window)>{"window", &PodTopic::window},
+        fj::Field<PodTopic, decltype(remaining)>{"remaining", &PodTopic::remaining},
+        fj::Field<PodTopic, decltype(secret)>{"secret", &PodTopic::secret},
+        fj::Field<PodTopic, decltype(enabled)>{"enabled", &PodTopic::enabled},
+        fj::Field<PodTopic, decltype(gain)>{"gain", &PodTopic::gain},
+        fj::Field<PodTopic, Button>{"reset", &PodTopic::reset});
+    return s;
+  }
+};
+
+// Same fields, different order: must hash differently.
+struct PodTopicReordered {
+  fj::VarWsPrefsRw<int> window;
+  fj::VarWsPrefsRw<StringBuffer<16>> name;
+
+  typedef fj::Schema<PodTopicReordered,
+                     fj::Field<PodTopicReordered, decltype(window)>,
+                     fj::Field<PodTopicReordered, decltype(name)>>
+      SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<PodTopicReordered>(
+        fj::Field<PodTopicReordered, decltype(window)>{"window", &PodTopicReordered::window},
+        fj::Field<PodTopicReordered, decltype(name)>{"name", &PodTopicReordered::name});
+    return s;
+  }
+};
+
+struct ListTopic {
+  fj::VarWsPrefsRw<int> count;
+  fj::VarWsRo<List<StringBuffer<8>, 4>> items;
+
+  typedef fj::Schema<ListTopic,
+                     fj::Field<ListTopic, decltype(count)>,
+                     fj::Field<ListTopic, decltype(items)>>
+      SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<ListTopic>(
+        fj::Field<ListTopic, decltype(count)>{"count", &ListTopic::count},
+        fj::Field<ListTopic, decltype(items)>{"items", &ListTopic::items});
+    return s;
+  }
+};
+
+// Compile-time layout: 16 (name) + 4 (window) + 8 (secret) + 1 (enabled) + 4 (gain) + 0 (button)
+static_assert(fj::BinaryLayout<PodTopic>::supported, "PodTopic should have a binary layout");
+static_assert(fj::BinaryLayout<PodTopic>::size == 16 + sizeof(int) + 8 + 1 + sizeof(float),
+              "Prefs layout should skip PrefsMode::Off fields");
+static_assert(fj::BinaryLayout<PodTopic, fj::BinaryPurpose::Ws>::size == 16 + 2 * sizeof(int) + 1 + 1 + sizeof(float),
+              "WS layout should include read-only fields and one byte for meta fields");
+static_assert(!fj::BinaryLayout<ListTopic>::supported, "List fields have no fixed layout");
+
+static void clearModelNamespace() {
+  Preferences prefs;
+  prefs.begin("model", false);
+  prefs.clear();
+  prefs.end();
+}
+
+void test_layout_roundtrip() {
+  TEST_START("BinaryLayout write/read round-trip");
+
+  PodTopic src;
+  src.name = "kitchen";
+  src.window = 600;
+  src.remaining = 42;
+  src.secret = "pw";
+  src.enabled = true;
+  src.gain = 1.5f;
+
+  uint8_t buf[fj::BinaryLayout<PodTopic>::size];
+  size_t n = fj::BinaryLayout<PodTopic>::write(src, buf, sizeof(buf));
+  CUSTOM_ASSERT(n == sizeof(buf), "write() should fill the whole layout");
+  CUSTOM_ASSERT(fj::BinaryLayout<PodTopic>::write(src, buf, sizeof(buf) - 1) == 0, "Too small buffer should fail");
+
+  PodTopic dst;
+  dst.remaining = 7;
+  CUSTOM_ASSERT(fj::BinaryLayout<PodTopic>::read(dst, buf, n), "read() should accept its own layout");
+  CUSTOM_ASSERT(strcmp(dst.name.get().c_str(), "kitchen") == 0, "name should round-trip");
+  CUSTOM_ASSERT(dst.window.get() == 600, "window should round-trip");
+  CUSTOM_ASSERT(dst.remaining.get() == 7, "PrefsMode::Off field should be untouched");
+  CUSTOM_ASSERT(strcmp(dst.secret.get().c_str(), "pw") == 0, "Meta field should persist its real value");
+  CUSTOM_ASSERT(dst.enabled.get(), "bool should round-trip");
+  CUSTOM_ASSERT(dst.gain.get() == 1.5f, "float should round-trip");
+
+  CUSTOM_ASSERT(!fj::BinaryLayout<PodTopic>::read(dst, buf, n - 1), "Wrong length should be rejected");
+
+  TEST_END();
+}
+
+void test_layout_hash_tracks_schema() {
+  TEST_START("BinaryLayout hash tracks schema changes");
+
+  const uint32_t a = fj::BinaryLayout<PodTopic>::hash();
+  const uint32_t b = fj::BinaryLayout<PodTopicReordered>::hash();
+  CUSTOM_ASSERT(a != 0, "Supported layout should have a hash");
+  CUSTOM_ASSERT(a == fj::BinaryLayout<PodTopic>::hash(), "Hash should be stable");
+  CUSTOM_ASSERT(a != b, "Different schemas should hash differently");
+  const uint32_t ws = fj::BinaryLayout<PodTopic, fj::BinaryPurpose::Ws>::hash();
+  CUSTOM_ASSERT(a != ws, "Prefs and WS layouts should differ");
+
+  TEST_END();
+}
+
+void test_modelbase_binary_prefs_format() {
+  TEST_START("ModelBase PrefsFormat::Binary stores fixed layout");
+
+  clearModelNamespace();
+
+  {
+    TestModelBase model(80, "/ws");
+    PodTopic t;
+    t.name = "garage";
+    t.window = 120;
+    ListTopic l;
+    l.count = 3;
+    model.setPrefsFormat(ModelBase::PrefsFormat::Binary);
+    model.registerTopic("pod", t, true, false);
+    model.registerTopic("list", l, true, false);
+    model.begin();
+  }
+
+  Preferences prefs;
+  prefs.begin("model", true);
+  size_t podLen = prefs.getBytesLength("pod");
+  uint8_t podTag = 0, listTag = 0;
+  uint8_t buf[64];
+  if (podLen > 0 && podLen <= sizeof(buf)) {
+    prefs.getBytes("pod", buf, sizeof(buf));
+    podTag = buf[0];
+  }
+  size_t listLen = prefs.getBytesLength("list");
+  if (listLen > 0 && listLen <= sizeof(buf)) {
+    prefs.getBytes("list", buf, sizeof(buf));
+    listTag = buf[0];
+  }
+  prefs.end();
+
+  CUSTOM_ASSERT(podLen == 5 + fj::BinaryLayout<PodTopic>::size, "Blob should be tag + hash + layout");
+  CUSTOM_ASSERT(podTag == ModelBase::PREFS_BINARY_V1, "POD topic should use the binary tag");
+  CUSTOM_ASSERT(listTag == ModelBase::PREFS_MSGPACK_V1, "Topic without layout should fall back to MessagePack");
+
+  TestModelBase model(80, "/ws");
+  PodTopic loaded;
+  ListTopic loadedList;
+  model.setPrefsFormat(ModelBase::PrefsFormat::Binary);
+  model.registerTopic("pod", loaded, true, false);
+  model.registerTopic("list", loadedList, true, false);
+  model.begin();
+
+  CUSTOM_ASSERT(strcmp(loaded.name.get().c_str(), "garage") == 0, "name should load from binary layout");
+  CUSTOM_ASSERT(loaded.window.get() == 120, "window should load from binary layout");
+  CUSTOM_ASSERT(loadedList.count.get() == 3, "List topic should load from MessagePack");
+
+  TEST_END();
+}
+
+void test_binary_layout_mismatch_resets_defaults() {
+  TEST_START("ModelBase binary layout mismatch rewrites defaults");
+
+  clearModelNamespace();
+
+  {
+    TestModelBase model(80, "/ws");
+    PodTopicReordered t;
+    t.window = 999;
+    model.setPrefsFormat(ModelBase::PrefsFormat::Binary);
+    model.registerTopic("pod", t, true, false);
+    model.begin();
+  }
+
+  // Same key, other schema (e.g. after a firmware update): must not decode garbage.
+  TestModelBase model(80, "/ws");
+  PodTopic t;
+  t.window = 5;
+  model.setPrefsFormat(ModelBase::PrefsFormat::Binary);
+  model.registerTopic("pod", t, true, false);
+  model.begin();
+
+  CUSTOM_ASSERT(t.window.get() == 5, "Mismatching layout should keep defaults");
+
+  Preferences prefs;
+  prefs.begin("model", true);
+  size_t len = prefs.getBytesLength("pod");
+  prefs.end();
+  CUSTOM_ASSERT(len == 5 + fj::BinaryLayout<PodTopic>::size, "Topic should be rewritten with the new layout");
+
+  TEST_END();
+}
+
+void runAllTests() {
+  SUITE_START("BINARY LAYOUT");
+  test_layout_roundtrip();
+  test_layout_hash_tracks_schema();
+  test_modelbase_binary_prefs_format();
+  test_binary_layout_mismatch_resets_defaults();
+  SUITE_END("BINARY LAYOUT");
+}
+
+} // namespace BinaryLayoutTest
@@ -0,0 +1,89 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/types/ModelTypeButton.h"
+
+namespace CallbackTest {
+
+static_assert(sizeof(fj::Callback) == 3 * sizeof(void*), "Callback is an invoker plus two words of storage");
+
+static int freeCalls = 0;
+static void freeFunction() { freeCalls++; }
+static void contextFunction(void* ctx) { (*static_cast<int*>(ctx)) += 10; }
+
+void test_empty_and_assigned() {
+  TEST_START("fj::Callback empty, function pointer and context pointer");
+
+  fj::Callback empty;
+  fj::Callback fromNull = nullptr;
+  CUSTOM_ASSERT(!empty && !fromNull, "Default and nullptr callbacks should be empty");
+  empty();  // calling an empty callback is a no-op
+
+  freeCalls = 0;
+  fj::Callback fn = &freeFunction;
+  CUSTOM_ASSERT(static_cast<bool>(fn), "Function pointer callback should be set");
+  fn();
+  CUSTOM_ASSERT(freeCalls == 1, "Function pointer should be called");
+
+  int value = 0;
+  fj::Callback withCtx(&contextFunction, &value);
+  withCtx();
+  CUSTOM_ASSERT(value == 10, "Context pointer should be passed to the function");
+
+  TEST_END();
+}
+
+void test_captures_are_copied() {
+  TEST_START("fj::Callback stores captures inline and copies them");
+
+  int a = 0;
+  int b = 0;
+  fj::Callback cb = [&a, &b]() { a++; b += 2; };
+  fj::Callback copy = cb;
+  cb();
+  copy();
+  CUSTOM_ASSERT(a == 2 && b == 4, "Original and copy should call the same lambda");
+
+  int counter = 0;
+  fj::Callback byValue = [&counter]() mutable { counter++; };
+  cb = byValue;
+  cb();
+  CUSTOM_ASSERT(counter == 1 && a == 2, "Assignment should replace the callable");
+
+  cb = nullptr;
+  CUSTOM_ASSERT(!cb, "Assigning nullptr should clear the callback");
+
+  TEST_END();
+}
+
+void test_var_and_button() {
+  TEST_START("fj::Callback drives Var change notifications and Button triggers");
+
+  int changes = 0;
+  fj::VarWsPrefsRw<int> var;
+  var.setOnChange([&changes]() { changes++; });
+  var = 5;
+  var.touch();
+  CUSTOM_ASSERT(changes == 2, "Var should notify through the callback");
+  var.setOnChange(nullptr);
+  var = 6;
+  CUSTOM_ASSERT(changes == 2, "Cleared callback should not be called");
+
+  int presses = 0;
+  Button btn(3, [&presses]() { presses++; });
+  btn.on_trigger();
+  CUSTOM_ASSERT(presses == 1, "Button should call its callback");
+
+  TEST_END();
+}
+
+void runAllTests() {
+  SUITE_START("CALLBACK");
+  test_empty_and_assigned();
+  test_captures_are_copied();
+  test_var_and_button();
+  SUITE_END("CALLBACK");
+}
+
+} // namespace CallbackTest
@@ -0,0 +1,206 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <ArduinoJson.h>
+
+#include "../../src/model/ModelBase.h"
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/types/ModelTypePointRingBuffer.h"
+
+namespace GraphWsTest {
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+#ifdef NATIVE_BUILD
+// Host only: the stub AsyncWebSocket records the frames each client received.
+
+struct DecodedPoint {
+  uint8_t version;
+  bool synced;
+  uint16_t id;
+  uint64_t x;
+  float y;
+};
+
+static DecodedPoint decodeFrame(const std::string& p) {
+  const uint8_t* b = (const uint8_t*)p.data();
+  DecodedPoint d;
+  d.version = b[0];
+  d.synced = (b[1] & 0x01) != 0;
+  d.id = (uint16_t)(b[2] | (b[3] << 8));
+  d.x = 0;
+  for (int i = 7; i >= 0; --i) d.x = (d.x << 8) | b[4 + i];
+  uint32_t ybits = 0;
+  for (int i = 3; i >= 0; --i) ybits = (ybits << 8) | b[12 + i];
+  memcpy(&d.y, &ybits, sizeof(d.y));
+  return d;
+}
+
+void test_binary_frame_after_series_announcement() {
+  TEST_START("Graph push sends series announcement + binary frame");
+
+  TestModelBase model(80, "/ws");
+  PointRingBuffer<8> rb("temp", "inside");
+  rb.setCallback(&ModelBase::graphPushCbXY, &model);
+
+  AsyncWebSocketClient* a = model.testWebSocket()._connect();
+  rb.push(1700000000123ULL, 21.5f);
+
+  CUSTOM_ASSERT(a->_sent.size() == 2, "First point should send announcement and frame");
+  CUSTOM_ASSERT(a->_sent[0].opcode == WS_TEXT, "Announcement should be a text frame");
+  CUSTOM_ASSERT(a->_sent[0].payload == R"({"topic":"graph_series","data":{"id":0,"graph":"temp","label":"inside"}})",
+                "Announcement should map id 0 to temp/inside");
+  CUSTOM_ASSERT(a->_sent[1].opcode == WS_BINARY, "Point should be a binary frame");
+  CUSTOM_ASSERT(a->_sent[1].payload.size() == ModelBase::GRAPH_FRAME_SIZE, "Frame should be 16 bytes");
+
+  const DecodedPoint d = decodeFrame(a->_sent[1].payload);
+  CUSTOM_ASSERT(d.version == ModelBase::GRAPH_FRAME_V1, "Frame should carry the version byte");
+  CUSTOM_ASSERT(d.id == 0 && d.synced, "Frame should carry series id and synced flag");
+  CUSTOM_ASSERT(d.x == 1700000000123ULL, "x should survive as u64");
+  CUSTOM_ASSERT(d.y == 21.5f, "y should survive as f32");
+
+  rb.push(1700000000124ULL, 22.0f);
+  CUSTOM_ASSERT(a->_sent.size() == 3, "Known series should only send the binary frame");
+  CUSTOM_ASSERT(a->_sent[2].opcode == WS_BINARY, "Second point should be binary");
+
+  TEST_END();
+}
+
+void test_series_ids_and_reconnect() {
+  TEST_START("Graph series get distinct ids, new clients get announcements");
+
+  TestModelBase model(80, "/ws");
+  model.begin();
+  AsyncWebSocket& ws = model.testWebSocket();
+  AsyncWebSocketClient* a = ws._connect();
+  model.loop();  // initial state
+  a->_sent.clear();
+
+  model.sendGraphPointXY("temp", "inside", 1, 1.0f, false);
+  model.sendGraphPointXY("temp", "outside", 2, 2.0f, false);
+  model.sendGraphPointXY("temp", "inside", 3, 3.0f, false);
+
+  CUSTOM_ASSERT(a->_sent.size() == 5, "Two announcements + three frames expected");
+  CUSTOM_ASSERT(decodeFrame(a->_sent[3].payload).id == 1, "Second series should get id 1");
+  CUSTOM_ASSERT(decodeFrame(a->_sent[4].payload).id == 0, "Known series should keep its id");
+  CUSTOM_ASSERT(!decodeFrame(a->_sent[4].payload).synced, "synced flag should be cleared");
+
+  AsyncWebSocketClient* b = ws._connect();
+  model.loop();
+  size_t announcements = 0;
+  for (size_t i = 0; i < b->_sent.size(); ++i) {
+    if (b->_sent[i].payload.find("\"graph_series\"") != std::string::npos) announcements++;
+  }
+  CUSTOM_ASSERT(announcements == 2, "Connecting client should receive every known series");
+
+  TEST_END();
+}
+
+void test_json_mode_and_table_overflow() {
+  TEST_START("Graph points fall back to JSON frames");
+
+  TestModelBase model(80, "/ws");
+  AsyncWebSocketClient* a = model.testWebSocket()._connect();
+
+  model.setGraphBinary(false);
+  model.sendGraphPointXY("temp", "inside", 5, 1.5f, true);
+  CUSTOM_ASSERT(a->_sent.size() == 1 && a->_sent[0].opcode == WS_TEXT, "JSON mode should send one text frame");
+  CUSTOM_ASSERT(a->_sent[0].payload.find("\"topic\":\"graph_point\"") != std::string::npos,
+                "JSON mode should keep the graph_point envelope");
+
+  model.setGraphBinary(true);
+  static const char* labels[] = {"l0", "l1", "l2", "l3", "l4", "l5", "l6", "l7", "l8", "l9", "l10", "l11",
+                                 "l12", "l13", "l14", "l15", "l16"};
+  const size_t n = MODEL_MAX_GRAPH_SERIES + 1;
+  CUSTOM_ASSERT(n <= sizeof(labels) / sizeof(labels[0]), "Test needs more labels");
+  for (size_t i = 0; i < n; ++i) model.sendGraphPointXY("many", labels[i], i, 0.0f, true);
+
+  const AsyncWebSocketClient::Frame& last = a->_sent.back();
+  CUSTOM_ASSERT(last.opcode == WS_TEXT && last.payload.find("\"graph_point\"") != std::string::npos,
+                "Series beyond MODEL_MAX_GRAPH_SERIES should use JSON frames");
+
+  TEST_END();
+}
+
+void test_batched_binary_flush() {
+  TEST_START("Graph batching sends one frame per series per interval");
+
+  TestModelBase model(80, "/ws");
+  model.setGraphFlushIntervalMs(100);
+  AsyncWebSocketClient* a = model.testWebSocket()._connect();
+
+  for (int i = 0; i < 5; ++i) model.sendGraphPointXY("temp", "inside", 1000 + i, (float)i, true);
+  model.sendGraphPointXY("temp", "outside", 2000, 9.0f, true);
+  CUSTOM_ASSERT(a->_sent.empty(), "Points should be queued until the interval passed");
+
+  model.loop();
+  CUSTOM_ASSERT(a->_sent.empty(), "loop() before the interval should not flush");
+
+  delay(100);
+  model.loop();
+  CUSTOM_ASSERT(a->_sent.size() == 4, "Two announcements + one batch per series expected");
+  CUSTOM_ASSERT(a->_sent[1].opcode == WS_BINARY, "Batch should be binary");
+
+  const std::string& batch = a->_sent[1].payload;
+  const uint8_t* b = (const uint8_t*)batch.data();
+  const size_t count = (size_t)(b[4] | (b[5] << 8));
+  CUSTOM_ASSERT(b[0] == ModelBase::GRAPH_BATCH_V1, "Batch should carry the batch version byte");
+  CUSTOM_ASSERT(count == 5, "Batch should carry all queued points");
+  CUSTOM_ASSERT(batch.size() == ModelBase::GRAPH_BATCH_HEADER + 5 * ModelBase::GRAPH_BATCH_POINT,
+                "Batch size should be header + 12 bytes per point");
+  const size_t lastX = ModelBase::GRAPH_BATCH_HEADER + 4 * ModelBase::GRAPH_BATCH_POINT;
+  CUSTOM_ASSERT(b[lastX] == (uint8_t)(1004 & 0xFF) && b[lastX + 1] == (uint8_t)(1004 >> 8),
+                "Points should keep their order");
+
+  const ModelBase::GraphStats& stats = model.graphStats();
+  CUSTOM_ASSERT(stats.points == 6 && stats.frames == 2 && stats.dropped == 0, "Stats should count points and frames");
+
+  model.loop();
+  CUSTOM_ASSERT(a->_sent.size() == 4, "Empty queues should not send anything");
+
+  TEST_END();
+}
+
+void test_batch_backlog_drops_oldest() {
+  TEST_START("Graph batching keeps only the newest MODEL_GRAPH_QUEUE_LEN points");
+
+  TestModelBase model(80, "/ws");
+  model.setGraphFlushIntervalMs(100);
+  model.setGraphBinary(false);
+  AsyncWebSocketClient* a = model.testWebSocket()._connect();
+
+  const int total = MODEL_GRAPH_QUEUE_LEN + 3;
+  for (int i = 0; i < total; ++i) model.sendGraphPointXY("temp", "inside", (uint64_t)i, (float)i, false);
+  model.flush();
+
+  CUSTOM_ASSERT(a->_sent.size() == 1 && a->_sent[0].opcode == WS_TEXT, "JSON batch should be one text frame");
+  StaticJsonDocument<2048> doc;
+  CUSTOM_ASSERT(!deserializeJson(doc, a->_sent[0].payload), "JSON batch should parse");
+  JsonArray points = doc["data"]["points"];
+  const bool isBatch = strcmp(doc["topic"] | "", "graph_points") == 0;
+  CUSTOM_ASSERT(isBatch, "JSON batch should use the graph_points topic");
+  CUSTOM_ASSERT(points.size() == MODEL_GRAPH_QUEUE_LEN, "Batch should be capped at the queue length");
+  CUSTOM_ASSERT(points[0]["x"].as<int>() == 3, "Oldest points should be dropped");
+  CUSTOM_ASSERT(model.graphStats().dropped == 3, "Dropped points should be counted");
+
+  TEST_END();
+}
+#endif
+
+void runAllTests() {
+  SUITE_START("GRAPH WS");
+#ifdef NATIVE_BUILD
+  test_binary_frame_after_series_announcement();
+  test_series_ids_and_reconnect();
+  test_json_mode_and_table_overflow();
+  test_batched_binary_flush();
+  test_batch_backlog_drops_oldest();
+#endif
+  SUITE_END("GRAPH WS");
+}
+
+} // namespace GraphWsTest
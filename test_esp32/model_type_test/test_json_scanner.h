@@ -0,0 +1,263 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <ArduinoJson.h>
+
+#include "../../src/model/ModelBase.h"
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/types/ModelTypePrimitive.h"
+#include "../../src/model/types/ModelTypeButton.h"
+#include "../../src/model/types/ModelTypeList.h"
+
+namespace JsonScannerTest {
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+struct ScanTopic {
+  fj::VarWsPrefsRw<int> window;
+  fj::VarWsPrefsRw<float> gain;
+  fj::VarWsPrefsRw<bool> enabled;
+  fj::VarWsPrefsRw<StringBuffer<16>> name;
+  fj::VarWsRo<int> remaining;
+  fj::VarWsPrefsRw<List<StringBuffer<8>, 4>> tags;
+  uint16_t port = 0;
+  Button reset;
+
+  typedef fj::Schema<ScanTopic,
+                     fj::Field<ScanTopic, decltype(window)>,
+                     fj::Field<ScanTopic, decltype(gain)>,
+                     fj::Field<ScanTopic, decltype(enabled)>,
+                     fj::Field<ScanTopic, decltype(name)>,
+                     fj::Field<ScanTopic, decltype(remaining)>,
+                     fj::Field<ScanTopic, decltype(tags)>,
+                     fj::Field<ScanTopic, uint16_t>,
+                     fj::Field<ScanTopic, Button>>
+      SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<ScanTopic>(
+        fj::Field<ScanTopic, decltype(window)>{"window", &ScanTopic::window},
+        fj::Field<ScanTopic, decltype(gain)>{"gain", &ScanTopic::gain},
+        fj::Field<ScanTopic, decltype(enabled)>{"enabled", &ScanTopic::enabled},
+        fj::Field<ScanTopic, decltype(name)>{"name", &ScanTopic::name},
+        fj::Field<ScanTopic, decltype(remaining)>{"remaining", &ScanTopic::remaining},
+        fj::Field<ScanTopic, decltype(tags)>{"tags", &ScanTopic::tags},
+        fj::Field<ScanTopic, uint16_t>{"port", &ScanTopic::port},
+        fj::Field<ScanTopic, Button>{"reset", &ScanTopic::reset});
+    return s;
+  }
+};
+
+// Larger than the 512 byte scratch document the JsonDocument path uses for list arrays.
+struct BigListTopic {
+  fj::VarWsPrefsRw<List<StringBuffer<32>, 24>> items;
+
+  typedef fj::Schema<BigListTopic, fj::Field<BigListTopic, decltype(items)>> SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<BigListTopic>(
+        fj::Field<BigListTopic, decltype(items)>{"items", &BigListTopic::items});
+    return s;
+  }
+};
+
+static bool sameTopic(const ScanTopic& a, const ScanTopic& b) {
+  if (a.window.get() != b.window.get() || a.gain.get() != b.gain.get() || a.enabled.get() != b.enabled.get()) return false;
+  if (strcmp(a.name.get().c_str(), b.name.get().c_str()) != 0) return false;
+  if (a.remaining.get() != b.remaining.get() || a.port != b.port) return false;
+  if (a.tags.get().count != b.tags.get().count) return false;
+  for (size_t i = 0; i < a.tags.get().count; ++i) {
+    if (strcmp(a.tags.get().items[i].c_str(), b.tags.get().items[i].c_str()) != 0) return false;
+  }
+  return true;
+}
+
+// Applies json with the scanner to one copy and with TypeAdapter::read to another.
+static bool scanMatchesDom(const char* json) {
+  ScanTopic scanned;
+  ScanTopic parsed;
+  scanned.remaining = 5;
+  parsed.remaining = 5;
+
+  if (fj::scan_update(scanned, json, strlen(json)) != fj::ScanResult::Applied) return false;
+
+  StaticJsonDocument<512> doc;
+  if (deserializeJson(doc, json)) return false;
+  fj::TypeAdapter<ScanTopic>::read(parsed, doc.as<JsonObject>(), false);
+  return sameTopic(scanned, parsed);
+}
+
+void test_scanner_tokens() {
+  TEST_START("JsonScanner reads objects, arrays, strings and numbers");
+
+  const char* json = " {\"s\":\"a\\\"b\\u00e4\\ud83d\\ude00\", \"n\":-42, \"f\":1.5e2, \"a\":[true,false,null], \"o\":{\"x\":[1,{}]}} ";
+  fj::JsonScanner sc(json, strlen(json));
+  CUSTOM_ASSERT(sc.beginObject(), "Should open the object");
+
+  char key[8];
+  char str[16];
+  size_t len = 0;
+  CUSTOM_ASSERT(sc.nextKey(key, sizeof(key)) && strcmp(key, "s") == 0, "First key should be 's'");
+  CUSTOM_ASSERT(sc.readString(str, sizeof(str), &len), "String should read");
+  CUSTOM_ASSERT(strcmp(str, "a\"b\xc3\xa4\xf0\x9f\x98\x80") == 0, "Escapes and surrogate pairs should decode to UTF-8");
+  CUSTOM_ASSERT(len == 9, "Unescaped length should be reported");
+
+  fj::JsonScanner::Number num;
+  int i = 0;
+  uint8_t u = 0;
+  CUSTOM_ASSERT(sc.nextKey(key, sizeof(key)) && sc.readNumber(num), "Integer should read");
+  CUSTOM_ASSERT(num.to(i) && i == -42, "Integer should convert exactly");
+  CUSTOM_ASSERT(!num.to(u), "Negative number should not convert to unsigned");
+
+  float f = 0;
+  CUSTOM_ASSERT(sc.nextKey(key, sizeof(key)) && sc.readNumber(num), "Float should read");
+  CUSTOM_ASSERT(!num.integral && num.to(f) && f == 150.0f, "Exponent should parse as float");
+  CUSTOM_ASSERT(!num.to(i), "Float should not convert to int");
+
+  bool b = false;
+  CUSTOM_ASSERT(sc.nextKey(key, sizeof(key)) && sc.beginArray(), "Array should open");
+  CUSTOM_ASSERT(sc.nextItem() && sc.readBool(b) && b, "true should read");
+  CUSTOM_ASSERT(sc.nextItem() && sc.readBool(b) && !b, "false should read");
+  CUSTOM_ASSERT(sc.nextItem() && sc.readNull(), "null should read");
+  CUSTOM_ASSERT(!sc.nextItem() && !sc.failed(), "Array should close");
+
+  CUSTOM_ASSERT(sc.nextKey(key, sizeof(key)) && sc.skipValue(), "Nested value should skip");
+  CUSTOM_ASSERT(!sc.nextKey(key, sizeof(key)) && !sc.failed(), "Object should close");
+  CUSTOM_ASSERT(sc.finish(), "Trailing whitespace is fine");
+
+  TEST_END();
+}
+
+void test_scanner_rejects_malformed() {
+  TEST_START("JsonScanner rejects malformed JSON");
+
+  const char* bad[] = {"{\"a\":1,}", "{\"a\" 1}", "{\"a\":01}", "{\"a\":\"x}", "{\"a\":[1 2]}", "{'a':1}", "{\"a\":1} x",
+                       "{\"a\":tru}", "{\"a\":\"\\q\"}"};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+    fj::JsonScanner sc(bad[i], strlen(bad[i]));
+    const bool ok = sc.skipValue() && sc.finish();
+    CUSTOM_ASSERT(!ok, "Malformed input should fail");
+  }
+
+  // Deeper than MAX_DEPTH
+  const char* deep = "[[[[[[[[[[[1]]]]]]]]]]]";
+  fj::JsonScanner sc(deep, strlen(deep));
+  CUSTOM_ASSERT(!sc.skipValue(), "Nesting deeper than MAX_DEPTH should fail");
+
+  TEST_END();
+}
+
+void test_scan_update_matches_dom() {
+  TEST_START("fj::scan_update matches TypeAdapter::read");
+
+  CUSTOM_ASSERT(fj::ScanUpdate<ScanTopic>::supported, "Schema topic should be scannable");
+  CUSTOM_ASSERT(scanMatchesDom("{\"window\":600,\"gain\":2.5,\"enabled\":true,\"name\":\"kitchen\"}"), "Plain values");
+  CUSTOM_ASSERT(scanMatchesDom("{\"window\":{\"value\":7,\"type\":\"int\"},\"name\":{\"value\":\"hall\"}}"), "Wrapped values");
+  CUSTOM_ASSERT(scanMatchesDom("{\"name\":\"a name that is far too long\"}"), "Truncated string");
+  CUSTOM_ASSERT(scanMatchesDom("{\"remaining\":99,\"unknown\":{\"x\":[1,2]}}"), "Read-only and unknown keys");
+  CUSTOM_ASSERT(scanMatchesDom("{\"tags\":[\"a\",\"b\",\"c\",\"d\",\"e\"]}"), "List array truncated to capacity");
+  CUSTOM_ASSERT(scanMatchesDom("{\"tags\":{\"type\":\"list\",\"items\":[\"x\"]}}"), "List object form");
+  CUSTOM_ASSERT(scanMatchesDom("{\"port\":8080,\"window\":null,\"gain\":3}"), "Plain member, null and int to float");
+
+  ScanTopic t;
+  const char* json = "{\"name\":\"x\"}";
+  const uint32_t gen = t.name.generation();
+  fj::scan_update(t, json, strlen(json));
+  CUSTOM_ASSERT(t.name.generation() == gen, "Like readOne, the scanner writes the value without notification");
+
+  TEST_END();
+}
+
+void test_scan_update_unsupported_changes_nothing() {
+  TEST_START("fj::scan_update leaves the object untouched on Unsupported / Invalid");
+
+  ScanTopic t;
+  t.window = 1;
+  t.name = "keep";
+
+  const char* wrongKind = "{\"window\":5,\"name\":42}";
+  CUSTOM_ASSERT(fj::scan_update(t, wrongKind, strlen(wrongKind)) == fj::ScanResult::Unsupported,
+                "Number for a string field should be Unsupported");
+  const char* fraction = "{\"name\":\"new\",\"window\":2.5}";
+  CUSTOM_ASSERT(fj::scan_update(t, fraction, strlen(fraction)) == fj::ScanResult::Unsupported,
+                "Fraction for an int field should be Unsupported");
+  const char* button = "{\"window\":5,\"reset\":{\"id\":3}}";
+  CUSTOM_ASSERT(fj::scan_update(t, button, strlen(button)) == fj::ScanResult::Unsupported,
+                "Button field should be Unsupported");
+  const char* broken = "{\"window\":5,\"name\":\"new\"";
+  CUSTOM_ASSERT(fj::scan_update(t, broken, strlen(broken)) == fj::ScanResult::Invalid, "Truncated JSON should be Invalid");
+
+  CUSTOM_ASSERT(t.window.get() == 1, "Dry run should keep window");
+  CUSTOM_ASSERT(strcmp(t.name.get().c_str(), "keep") == 0, "Dry run should keep name");
+
+  TEST_END();
+}
+
+void test_modelbase_scan_path() {
+  TEST_START("ModelBase applies WS updates through the scanner");
+
+  TestModelBase model(80, "/ws");
+  ScanTopic t;
+  model.registerTopic("scan", t, false, false);
+
+  const char* update = "{\"topic\":\"scan\",\"data\":{\"window\":42,\"name\":\"via scan\"}}";
+  CUSTOM_ASSERT(model.testHandleWsMessage(update, strlen(update)), "Update should succeed");
+  CUSTOM_ASSERT(t.window.get() == 42 && strcmp(t.name.get().c_str(), "via scan") == 0, "Values should be applied");
+  CUSTOM_ASSERT(model.wsScanStats().scanned == 1 && model.wsScanStats().fallback == 0, "Scanner should handle it");
+
+  const char* button = "{\"topic\":\"scan\",\"data\":{\"window\":43,\"reset\":{\"id\":1}}}";
+  CUSTOM_ASSERT(model.testHandleWsMessage(button, strlen(button)), "Unsupported shape should still succeed");
+  CUSTOM_ASSERT(t.window.get() == 43, "JsonDocument path should apply it");
+  CUSTOM_ASSERT(model.wsScanStats().fallback == 1, "Unsupported shape should fall back");
+
+  const char* unknown = "{\"topic\":\"nope\",\"data\":{}}";
+  CUSTOM_ASSERT(!model.testHandleWsMessage(unknown, strlen(unknown)), "Unknown topic should still fail");
+  const char* broken = "{\"topic\":\"scan\",\"data\":{\"window\":1}";
+  CUSTOM_ASSERT(!model.testHandleWsMessage(broken, strlen(broken)), "Malformed JSON should still fail");
+  CUSTOM_ASSERT(t.window.get() == 43, "Failed messages should not change the topic");
+
+  model.setWsScan(false);
+  model.resetWsScanStats();
+  const char* again = "{\"topic\":\"scan\",\"data\":{\"window\":44}}";
+  CUSTOM_ASSERT(model.testHandleWsMessage(again, strlen(again)) && t.window.get() == 44, "Disabled scanner should parse");
+  CUSTOM_ASSERT(model.wsScanStats().scanned == 0 && model.wsScanStats().fallback == 1, "Disabled scanner is not used");
+
+  TEST_END();
+}
+
+void test_scan_large_list() {
+  TEST_START("fj::scan_update fills large lists without a scratch document");
+
+  String json = "{\"items\":[";
+  for (int i = 0; i < 24; ++i) {
+    if (i) json += ",";
+    json += "\"entry-number-";
+    json += i;
+    json += "-abcdefghijk\"";
+  }
+  json += "]}";
+
+  BigListTopic t;
+  CUSTOM_ASSERT(fj::scan_update(t, json.c_str(), json.length()) == fj::ScanResult::Applied, "Large list should scan");
+  CUSTOM_ASSERT(t.items.get().count == 24, "All items should be applied");
+  CUSTOM_ASSERT(strcmp(t.items.get().items[23].c_str(), "entry-number-23-abcdefghijk") == 0, "Last item should match");
+
+  TEST_END();
+}
+
+void runAllTests() {
+  SUITE_START("JSON SCANNER");
+  test_scanner_tokens();
+  test_scanner_rejects_malformed();
+  test_scan_update_matches_dom();
+  test_scan_update_unsupported_changes_nothing();
+  test_modelbase_scan_path();
+  test_scan_large_list();
+  SUITE_END("JSON SCANNER");
+}
+
+} // namespace JsonScannerTest
@@ -0,0 +1,254 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <string>
+
+#include "../../src/LogStream.h"
+#include "../../src/model/ModelBase.h"
+
+namespace LogStreamTest {
+
+void test_history_keeps_newest_lines() {
+  TEST_START("LogStream history overwrites its oldest lines");
+
+  LogStream stream(256, 1024);
+  const bool started = stream.begin();
+  LogStream second(256, 1024);
+  const bool secondStarted = second.begin();
+
+  for (int i = 0; i < 20; ++i) LOG_INFO_F("[LogStreamTest] history line %02d", i);
+  const size_t pumped = stream.pump();
+  const LogStream::Stats st = stream.stats();
+  const uint32_t held = stream.historyLines();
+  const size_t used = stream.historyUsed();
+  stream.end();
+  const bool tapFree = second.begin();
+  second.end();
+
+  CUSTOM_ASSERT(started, "begin() should install the tap");
+  CUSTOM_ASSERT(!secondStarted, "A second stream cannot install another tap");
+  CUSTOM_ASSERT(pumped == 20 && st.lines == 20, "Every line should reach the history");
+  CUSTOM_ASSERT(st.evicted > 0 && held == 20 - st.evicted, "Old lines should be evicted to make room");
+  CUSTOM_ASSERT(used <= 256, "History should stay within its capacity");
+  CUSTOM_ASSERT(tapFree, "end() should remove the tap");
+
+  TEST_END();
+}
+
+#ifdef NATIVE_BUILD
+// Host only: subscribes stub clients and inspects the frames they receive.
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+};
+
+static size_t countLogFrames(const AsyncWebSocketClient* c, size_t from) {
+  size_t n = 0;
+  for (size_t i = from; i < c->_sent.size(); ++i) {
+    if (c->_sent[i].payload.find("\"topic\":\"log\"") != std::string::npos) n++;
+  }
+  return n;
+}
+
+void test_subscribe_backlog_and_level_filter() {
+  TEST_START("log_subscribe streams the backlog and filters by level");
+
+  TestModelBase model(80, "/ws");
+  LogStream stream(2048, 1024);
+  stream.setIntervalMs(100);
+  CUSTOM_ASSERT(stream.begin(), "Stream should start");
+  model.setLogStream(&stream);
+  model.begin();
+
+  LOG_INFO("[LogStreamTest] before connect");
+  LOG_WARN("[LogStreamTest] warning \"quoted\"");
+
+  AsyncWebSocket& ws = model.testWebSocket();
+  AsyncWebSocketClient* all = ws._connect();
+  AsyncWebSocketClient* warn = ws._connect();
+  AsyncWebSocketClient* none = ws._connect();
+  ws._receive(all, R"({"action":"log_subscribe","level":2,"backlog":true})");
+  ws._receive(warn, R"({"action":"log_subscribe","level":3})");
+  CUSTOM_ASSERT(all->_sent.back().payload == R"({"ok":true})", "Subscription should be acknowledged");
+  CUSTOM_ASSERT(stream.subscriberCount() == 2, "Two clients subscribed");
+
+  LOG_INFO("[LogStreamTest] after connect");
+  LOG_WARN("[LogStreamTest] after connect warning");
+  delay(100);
+  const size_t allBefore = all->_sent.size();
+  const size_t warnBefore = warn->_sent.size();
+  model.loop();
+
+  CUSTOM_ASSERT(all->_sent.size() == allBefore + 1 && warn->_sent.size() == warnBefore + 1, "One frame per subscriber");
+  const std::string& a = all->_sent.back().payload;
+  const std::string& w = warn->_sent.back().payload;
+  CUSTOM_ASSERT(a.find("before connect") != std::string::npos, "Backlog should include lines before subscribing");
+  CUSTOM_ASSERT(a.find("warning \\\"quoted\\\"") != std::string::npos, "Text should be JSON escaped");
+  CUSTOM_ASSERT(a.find("[2,") != std::string::npos && a.find("[3,") != std::string::npos, "Lines carry their level");
+  CUSTOM_ASSERT(a.find("[INFO]") == std::string::npos, "The level prefix is not repeated in the text");
+  CUSTOM_ASSERT(w.find("before connect") == std::string::npos, "Without backlog only new lines are sent");
+  CUSTOM_ASSERT(w.find("after connect warning") != std::string::npos && w.find("\"after connect\"") == std::string::npos,
+                "Level filter should drop lines below WARN");
+  CUSTOM_ASSERT(countLogFrames(none, 0) == 0, "Clients that did not subscribe get no log frames");
+
+  LOG_WARN("[LogStreamTest] within the interval");
+  model.loop();
+  CUSTOM_ASSERT(all->_sent.size() == allBefore + 1, "No second frame within the interval");
+
+  ws._disconnect(warn);
+  CUSTOM_ASSERT(stream.subscriberCount() == 1, "Disconnect should unsubscribe");
+  ws._receive(all, R"({"action":"log_unsubscribe"})");
+  CUSTOM_ASSERT(stream.subscriberCount() == 0, "log_unsubscribe should unsubscribe");
+
+  model.setLogStream(nullptr);
+  stream.end();
+  ws._receive(none, R"({"action":"log_subscribe"})");
+  CUSTOM_ASSERT(none->_sent.back().payload.find("log_stream_unavailable") != std::string::npos,
+                "Without a stream the request is refused");
+
+  TEST_END();
+}
+
+void test_rate_limit_and_slow_clients() {
+  TEST_START("LogStream batches lines and backs off from slow clients");
+
+  TestModelBase model(80, "/ws");
+  LogStream stream(4096, 4096);
+  stream.setIntervalMs(100);
+  stream.setBatchBytes(300);
+  CUSTOM_ASSERT(stream.begin(), "Stream should start");
+  model.setLogStream(&stream);
+  model.begin();
+
+  AsyncWebSocket& ws = model.testWebSocket();
+  AsyncWebSocketClient* c = ws._connect();
+  AsyncWebSocketClient* slow = ws._connect(false);
+  ws._receive(c, R"({"action":"log_subscribe","level":2})");
+  ws._receive(slow, R"({"action":"log_subscribe","level":2})");
+  for (int i = 0; i < (int)LOG_STREAM_QUEUE_LIMIT; ++i) slow->text("x");  // AsyncTCP queue at its limit
+
+  const size_t before = c->_sent.size();
+  const size_t slowBefore = slow->_sent.size();
+  for (int i = 0; i < 30; ++i) LOG_INFO_F("[LogStreamTest] burst line %02d", i);
+  delay(100);
+  model.loop();
+  CUSTOM_ASSERT(c->_sent.size() == before + 1, "A burst goes out as one frame per interval");
+  const std::string& first = c->_sent.back().payload;
+  CUSTOM_ASSERT(first.size() < 300 + 128, "Frame should respect the batch size");
+  CUSTOM_ASSERT(first.find("\"more\":true") != std::string::npos, "Frame should announce that more lines follow");
+  CUSTOM_ASSERT(slow->_sent.size() == slowBefore && stream.stats().deferred == 1, "Congested client should be skipped");
+
+  for (int i = 0; i < 8; ++i) {
+    delay(100);
+    model.loop();
+  }
+  std::string joined;
+  for (size_t i = before; i < c->_sent.size(); ++i) joined += c->_sent[i].payload;
+  CUSTOM_ASSERT(joined.find("burst line 00") != std::string::npos && joined.find("burst line 29") != std::string::npos,
+                "All lines should arrive over the following intervals");
+  CUSTOM_ASSERT(c->_sent.back().payload.find("\"more\"") == std::string::npos, "Last frame has no more flag");
+
+  slow->_drain();
+  delay(100);
+  model.loop();
+  CUSTOM_ASSERT(countLogFrames(slow, slowBefore) == 1, "Drained client should receive its pending lines");
+  CUSTOM_ASSERT(slow->_sent.back().payload.find("burst line 00") != std::string::npos, "Pending lines waited in the history");
+
+  model.setLogStream(nullptr);
+  stream.end();
+
+  TEST_END();
+}
+
+void test_evicted_lines_are_reported() {
+  TEST_START("Subscribers learn how many lines they missed");
+
+  TestModelBase model(80, "/ws");
+  LogStream stream(256, 2048);
+  stream.setIntervalMs(0);
+  CUSTOM_ASSERT(stream.begin(), "Stream should start");
+  model.setLogStream(&stream);
+  model.begin();
+
+  AsyncWebSocket& ws = model.testWebSocket();
+  AsyncWebSocketClient* c = ws._connect(false);
+  ws._receive(c, R"({"action":"log_subscribe","level":2})");
+  c->_drain();
+  for (int i = 0; i < (int)LOG_STREAM_QUEUE_LIMIT; ++i) c->text("x");
+
+  for (int i = 0; i < 20; ++i) {
+    LOG_INFO_F("[LogStreamTest] lost line %02d", i);
+    model.loop();  // history fills while the client is congested
+  }
+  c->_drain();
+  model.loop();
+  const std::string& p = c->_sent.back().payload;
+  CUSTOM_ASSERT(p.find("\"topic\":\"log\"") != std::string::npos, "Frame should be sent once the client drained");
+  CUSTOM_ASSERT(p.find("\"skipped\":0") == std::string::npos && stream.stats().skipped > 0, "Missed lines should be counted");
+  CUSTOM_ASSERT(p.find("lost line 19") != std::string::npos, "The newest lines are still delivered");
+
+  model.setLogStream(nullptr);
+  stream.end();
+
+  TEST_END();
+}
+
+static bool isValidUtf8(const std::string& s) {
+  for (size_t i = 0; i < s.size(); ++i) {
+    if ((uint8_t)s[i] < 0x80) continue;
+    const size_t n = utf8SequenceLen_((const uint8_t*)s.data() + i, s.size() - i);
+    if (n == 0) return false;
+    i += n - 1;
+  }
+  return true;
+}
+
+void test_frames_stay_valid_utf8() {
+  TEST_START("Log frames are valid UTF-8 text");
+
+  TestModelBase model(80, "/ws");
+  LogStream stream(2048, 2048);
+  stream.setIntervalMs(0);
+  CUSTOM_ASSERT(stream.begin(), "Stream should start");
+  model.setLogStream(&stream);
+  model.begin();
+
+  AsyncWebSocket& ws = model.testWebSocket();
+  AsyncWebSocketClient* c = ws._connect();
+  ws._receive(c, R"({"action":"log_subscribe","level":2})");
+
+  // A 2-byte character (U+00E9) whose first byte is the last one that fits LOG_LINE_LEN.
+  std::string straddle(LOG_LINE_LEN - 1, 'x');
+  straddle += "\xC3\xA9 tail";
+  LOG_INFO_F("%s", straddle.c_str());
+  LOG_INFO("[LogStreamTest] ssid \xFF\xC3");  // not UTF-8 at all
+  model.loop();
+
+  const std::string& p = c->_sent.back().payload;
+  CUSTOM_ASSERT(p.find("\"topic\":\"log\"") != std::string::npos, "Lines should be streamed");
+  CUSTOM_ASSERT(isValidUtf8(p), "Frame should be valid UTF-8");
+  CUSTOM_ASSERT(p.find(std::string(LOG_LINE_LEN - 1, 'x') + "\"") != std::string::npos,
+                "Long line should be cut in front of the split character");
+  CUSTOM_ASSERT(p.find("ssid \\ufffd\\ufffd") != std::string::npos, "Invalid bytes should become \\ufffd");
+
+  model.setLogStream(nullptr);
+  stream.end();
+
+  TEST_END();
+}
+#endif
+
+void runAllTests() {
+  SUITE_START("LOG STREAM");
+  test_history_keeps_newest_lines();
+#ifdef NATIVE_BUILD
+  test_subscribe_backlog_and_level_filter();
+  test_rate_limit_and_slow_clients();
+  test_evicted_lines_are_reported();
+  test_frames_stay_valid_utf8();
+#endif
+  SUITE_END("LOG STREAM");
+}
+
+} // namespace LogStreamTest
@@ -0,0 +1,195 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <string>
+
+#include "../../src/Logger.h"
+
+namespace LoggerTest {
+
+struct Collected {
+  std::string text;
+  uint8_t tags[64];
+  size_t count = 0;
+};
+
+static void collect(Collected& out, uint8_t tag, const char* data, size_t len) {
+  if (out.count < sizeof(out.tags)) out.tags[out.count] = tag;
+  out.count++;
+  out.text.append(data, len);
+  out.text.push_back('|');
+}
+
+void test_ring_order_and_wrap() {
+  TEST_START("LogRing keeps records in order across the wrap");
+
+  LogRing ring(100);
+  CUSTOM_ASSERT(ring.ok() && ring.capacity() == 128, "Capacity is rounded up to a power of two");
+
+  Collected out;
+  bool allPushed = true;
+  // 20-byte records (4 header + 13 payload + 3 padding) wrap the 128-byte ring several times.
+  for (int i = 0; i < 20; ++i) {
+    char rec[16];
+    snprintf(rec, sizeof(rec), "record-%06d", i);
+    allPushed = ring.push((uint8_t)(i % 5), rec, strlen(rec)) && allPushed;
+    if (i % 3 == 2) ring.drain([&out](uint8_t t, const char* d, size_t n) { collect(out, t, d, n); });
+  }
+  ring.drain([&out](uint8_t t, const char* d, size_t n) { collect(out, t, d, n); });
+
+  CUSTOM_ASSERT(allPushed, "Records should fit while the consumer keeps up");
+  CUSTOM_ASSERT(out.count == 20, "Every record should be drained once");
+  CUSTOM_ASSERT(out.text.find("record-000000|record-000001|") == 0, "Records should come out in order");
+  CUSTOM_ASSERT(out.text.find("record-000019|") == out.text.size() - 14, "Last record should come out last");
+  CUSTOM_ASSERT(out.tags[7] == 2, "Tags should be preserved");
+  CUSTOM_ASSERT(ring.used() == 0, "Drained ring should be empty");
+
+  TEST_END();
+}
+
+void test_ring_full_drops() {
+  TEST_START("LogRing drops and counts records when full");
+
+  LogRing ring(64);
+  const char payload[] = "0123456789abcdef0123456";  // 23 + 4 header, padded to 28 bytes
+  size_t pushed = 0;
+  for (int i = 0; i < 5; ++i) pushed += ring.push(1, payload, sizeof(payload) - 1) ? 1 : 0;
+  CUSTOM_ASSERT(pushed == 2, "Only two records fit into 64 bytes");
+  CUSTOM_ASSERT(ring.stats().dropped == 3 && ring.stats().written == 2, "Drops should be counted");
+  CUSTOM_ASSERT(ring.stats().highWater == 56, "High water mark should be recorded");
+
+  char big[64] = {0};
+  CUSTOM_ASSERT(!ring.push(1, big, sizeof(big)), "Record larger than half the ring is rejected");
+
+  Collected out;
+  ring.drain([&out](uint8_t t, const char* d, size_t n) { collect(out, t, d, n); }, 1);
+  CUSTOM_ASSERT(out.count == 1, "drain(max) should stop after max records");
+  CUSTOM_ASSERT(ring.push(1, payload, sizeof(payload) - 1), "Freed space should be reusable");
+
+  TEST_END();
+}
+
+void test_logger_async_queue() {
+  TEST_START("Logger::beginAsync queues lines until drain()");
+
+  const bool started = Logger::beginAsync(256, false);
+  LOG_INFO_F("[LogTest] queued line %d", 1);
+  LOG_INFO("[LogTest] queued line 2");
+  LOG_DEBUG("[LogTest] below the runtime level, not queued");
+  const Logger::AsyncStats queued = Logger::asyncStats();
+  const size_t drained = Logger::drain();
+
+  // 7 more lines of ~40 bytes overflow the 256-byte ring.
+  for (int i = 0; i < 7; ++i) LOG_WARN_F("[LogTest] overflow line %d", i);
+  const Logger::AsyncStats full = Logger::asyncStats();
+  Logger::endAsync();
+  const Logger::AsyncStats after = Logger::asyncStats();
+
+  CUSTOM_ASSERT(started, "beginAsync should succeed");
+  CUSTOM_ASSERT(queued.active && queued.written == 2, "Both lines should be queued, not printed");
+  CUSTOM_ASSERT(drained == 2, "drain() should write the queued lines");
+  CUSTOM_ASSERT(full.dropped > 0 && full.written + full.dropped == 9, "Overflow should be dropped and counted");
+  CUSTOM_ASSERT(!after.active, "endAsync() should return to synchronous output");
+
+  TEST_END();
+}
+
+void test_record_format_matches_printf() {
+  TEST_START("LogRecord formats deferred arguments like printf");
+
+  uint8_t rec[192];
+  char out[128];
+  char expected[128];
+  const uint64_t big = 12345678901234ULL;
+  int local = 7;
+  const char* fmt = "%s=%d %u %llu %.2f %p %% %c";
+  size_t n = LogRecord::encode(rec, sizeof(rec), fmt, 1234, "key", -42, 42u, big, 3.14159f, (void*)&local, 'z');
+  LogRecord::format(out, sizeof(out), rec, n);
+  snprintf(expected, sizeof(expected), fmt, "key", -42, 42u, (unsigned long long)big, 3.14159, (void*)&local, 'z');
+  CUSTOM_ASSERT(strcmp(out, expected) == 0, "Deferred output should equal printf output");
+  CUSTOM_ASSERT(LogRecord::timestamp(rec) == 1234 && LogRecord::formatString(rec) == fmt, "Header keeps format and timestamp");
+
+  const char* widths = "[%5s|%-4d|%08X] %.*s";
+  n = LogRecord::encode(rec, sizeof(rec), widths, 0, "ab", 9, 0xBEEFu, 3, "truncated");
+  LogRecord::format(out, sizeof(out), rec, n);
+  snprintf(expected, sizeof(expected), widths, "ab", 9, 0xBEEFu, 3, "truncated");
+  CUSTOM_ASSERT(strcmp(out, expected) == 0, "Flags, widths and '*' precision should match printf");
+
+  {
+    String temp("copied before it goes away");
+    n = LogRecord::encode(rec, sizeof(rec), "[%s]", 0, temp.c_str());
+  }
+  LogRecord::format(out, sizeof(out), rec, n);
+  CUSTOM_ASSERT(strcmp(out, "[copied before it goes away]") == 0, "String arguments are copied into the record");
+
+  n = LogRecord::encode(rec, sizeof(rec), "%d %s %d", 0, 1, 2, 3);
+  LogRecord::format(out, sizeof(out), rec, n);
+  CUSTOM_ASSERT(strcmp(out, "1 ? 3") == 0, "Argument of the wrong kind prints as ?");
+
+  n = LogRecord::encode(rec, LogRecord::HEADER + 6, "%d %d", 0, 1, 2);
+  LogRecord::format(out, sizeof(out), rec, n);
+  CUSTOM_ASSERT(strcmp(out, "1 ?") == 0, "Arguments that do not fit print as ?");
+
+  n = LogRecord::encode(rec, sizeof(rec), "%s", 0, "0123456789");
+  CUSTOM_ASSERT(LogRecord::format(out, 6, rec, n) == 5 && strcmp(out, "01234") == 0, "Output is truncated to the buffer");
+
+  TEST_END();
+}
+
+struct TapCapture {
+  std::string text;
+  uint32_t ms = 0;
+  size_t count = 0;
+};
+
+static void captureTap(void* ctx, LogLevel, uint32_t ms, const char* line, size_t len) {
+  TapCapture* cap = static_cast<TapCapture*>(ctx);
+  cap->text.append(line, len);
+  cap->text.push_back('|');
+  cap->ms = ms;
+  cap->count++;
+}
+
+void test_logger_deferred_records() {
+  TEST_START("Logger::setDeferred stores records and formats them on drain()");
+
+  TapCapture cap;
+  const bool started = Logger::beginAsync(1024, false);
+  Logger::setDeferred(true);
+  const bool tapped = Logger::setTap(&captureTap, &cap);
+
+  char scratch[16];
+  strcpy(scratch, "first");
+  const uint32_t before = millis();
+  LOG_INFO_F("[LogTest] deferred %s %d %.1f", scratch, 5, 2.5);
+  strcpy(scratch, "overwritten");
+  LOG_WARN("[LogTest] plain message");
+  const size_t queuedLines = cap.count;
+  delay(5);
+  const size_t drained = Logger::drain();
+
+  Logger::setDeferred(false);
+  (void)Logger::setTap(nullptr, nullptr);
+  Logger::endAsync();
+
+  CUSTOM_ASSERT(started && tapped, "Async ring and tap should be installed");
+  CUSTOM_ASSERT(queuedLines == 0, "Deferred records are not formatted when logged");
+  CUSTOM_ASSERT(drained == 2 && cap.count == 2, "drain() formats both records");
+  CUSTOM_ASSERT(cap.text == "[INFO]  [LogTest] deferred first 5 2.5|[WARN]  [LogTest] plain message|",
+                "Formatted lines carry the prefix and the arguments as they were when logged");
+  CUSTOM_ASSERT(cap.ms >= before && cap.ms < before + 5, "Tap gets the timestamp of the log call");
+
+  TEST_END();
+}
+
+void runAllTests() {
+  SUITE_START("LOGGER");
+  test_ring_order_and_wrap();
+  test_ring_full_drops();
+  test_logger_async_queue();
+  test_record_format_matches_printf();
+  test_logger_deferred_records();
+  SUITE_END("LOGGER");
+}
+
+} // namespace LoggerTest
@@ -0,0 +1,198 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <ArduinoJson.h>
+#include <string>
+
+#include "../../src/model/Metrics.h"
+#include "../../src/model/ModelBase.h"
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/types/ModelTypeMetrics.h"
+#include "../../src/model/types/ModelTypePrimitive.h"
+
+namespace MetricsTest {
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+struct LevelTopic {
+  fj::VarWsPrefsRw<int> level;
+
+  typedef fj::Schema<LevelTopic,
+                     fj::Field<LevelTopic, decltype(level)>>
+      SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<LevelTopic>(
+        fj::Field<LevelTopic, decltype(level)>{"level", &LevelTopic::level});
+    return s;
+  }
+};
+
+void test_histogram_buckets() {
+  TEST_START("LatencyHistogram sorts durations into fixed buckets");
+
+  fj::LatencyHistogram h = fj::LatencyHistogram();
+  h.observe(0);
+  h.observe(100);    // bounds are inclusive
+  h.observe(101);
+  h.observe(4000);
+  h.observe(90000);  // +Inf
+
+  CUSTOM_ASSERT(h.counts[0] == 2 && h.counts[1] == 1, "Durations up to a bound land in its bucket");
+  CUSTOM_ASSERT(h.counts[5] == 1 && h.counts[fj::LatencyHistogram::BUCKETS - 1] == 1, "Large durations go to +Inf");
+  CUSTOM_ASSERT(h.count == 5 && h.sumUs == 94201 && h.maxUs == 90000, "Count, sum and max are kept");
+  CUSTOM_ASSERT(h.avgUs() == 18840, "Average is sum / count");
+
+  {
+    fj::MetricsTimer none(nullptr);
+    fj::MetricsTimer timed(&h);
+  }
+  CUSTOM_ASSERT(h.count == 6, "MetricsTimer records its scope, a timer without histogram nothing");
+
+  TEST_END();
+}
+
+void test_prometheus_histogram_text() {
+  TEST_START("PrometheusText writes cumulative buckets in seconds");
+
+  fj::LatencyHistogram h = fj::LatencyHistogram();
+  h.observe(50);
+  h.observe(300);
+  h.observe(300);
+  String out;
+  fj::PrometheusText prom(out);
+  prom.family("x_seconds", "histogram", "Test");
+  prom.histogram("x_seconds", "topic=\"t\"", h);
+  prom.sample("x_total", "", 7);
+  const std::string text = out.c_str();
+
+  CUSTOM_ASSERT(text.find("# HELP x_seconds Test\n# TYPE x_seconds histogram\n") == 0, "Family header comes first");
+  CUSTOM_ASSERT(text.find("x_seconds_bucket{topic=\"t\",le=\"0.0001\"} 1\n") != std::string::npos, "First bucket");
+  CUSTOM_ASSERT(text.find("x_seconds_bucket{topic=\"t\",le=\"0.0005\"} 3\n") != std::string::npos, "Buckets are cumulative");
+  CUSTOM_ASSERT(text.find("x_seconds_bucket{topic=\"t\",le=\"+Inf\"} 3\n") != std::string::npos, "+Inf holds the count");
+  CUSTOM_ASSERT(text.find("x_seconds_sum{topic=\"t\"} 0.000650\n") != std::string::npos, "Sum is in seconds");
+  CUSTOM_ASSERT(text.find("x_seconds_count{topic=\"t\"} 3\n") != std::string::npos, "Count line");
+  CUSTOM_ASSERT(text.find("\nx_total 7\n") != std::string::npos, "Sample without labels has no braces");
+
+  TEST_END();
+}
+
+#ifdef NATIVE_BUILD
+// Host only: drives updates through stub clients.
+
+void test_ws_and_topic_counters() {
+  TEST_START("Model counts WS traffic and times apply, save and broadcast per topic");
+
+  TestModelBase model(80, "/ws", "metrics_test");
+  LevelTopic t;
+  model.registerTopic("level", t, true, true);
+  model.setPrefsWriteBackMs(0);
+  model.begin();
+
+  AsyncWebSocket& ws = model.testWebSocket();
+  AsyncWebSocketClient* a = ws._connect();
+  AsyncWebSocketClient* b = ws._connect();
+  model.loop();  // initial state
+  model.resetMetrics();
+
+  const char* scanned = R"({"topic":"level","data":{"level":3}})";
+  ws._receive(a, scanned);
+  model.setWsScan(false);
+  const char* parsed = R"({"topic":"level","data":{"level":4}})";
+  ws._receive(a, parsed);
+  ws._receive(a, R"({"topic":"nope","data":{}})");
+  ws._receive(a, "{broken");
+
+  const ModelBase::WsMetrics& m = model.wsMetrics();
+  const fj::TopicMetrics* tm = model.topicMetrics("level");
+  CUSTOM_ASSERT(tm != nullptr, "Registered topics get a metrics block");
+  CUSTOM_ASSERT(m.inMessages == 4 && m.inErrors == 2, "Messages and rejections should be counted");
+  CUSTOM_ASSERT(m.inBytes == strlen(scanned) + strlen(parsed) + 26 + 7, "Received bytes should be counted");
+  CUSTOM_ASSERT(tm->apply.count == 2 && tm->parse.count == 2, "Scanner and JsonDocument updates time parse and apply");
+  CUSTOM_ASSERT(tm->save.count == 2 && tm->nvsWrites == 2, "Write-through saves are timed and counted");
+  CUSTOM_ASSERT(tm->broadcast.count == 2, "Each update is broadcast once");
+  CUSTOM_ASSERT(m.outFrames == 4 && m.outBytes > 0, "Broadcast frames to both clients are counted");
+
+  const fj::TopicMetrics* none = model.topicMetrics("missing");
+  CUSTOM_ASSERT(none == nullptr, "Unknown topics have no metrics");
+
+  b->_autoDrain = false;
+  b->_drain();
+  model.setSlowClientPolicy(ModelBase::SlowClientPolicy::DropGraphs);
+  model.setClientQueueLimit(1);
+  t.level = 9;
+  model.broadcastTopic("level");
+  model.sendGraphPointXY("temp", "inside", 1, 1.0f, true);
+  CUSTOM_ASSERT(model.wsMetrics().outDrops == 1, "Graph frame for the congested client is a drop");
+
+  model.resetMetrics();
+  CUSTOM_ASSERT(model.wsMetrics().inMessages == 0 && tm->apply.count == 0, "resetMetrics() clears everything");
+
+  TEST_END();
+}
+
+void test_metrics_topic_and_prometheus() {
+  TEST_START("MetricsTopic and writePrometheus export the recorded metrics");
+
+  TestModelBase model(80, "/ws", "metrics_test2");
+  LevelTopic t;
+  MetricsTopic metrics;
+  metrics.model = &model;
+  model.registerTopic("level", t, true, true);
+  model.registerTopic("metrics", metrics, false, true);
+  model.setPrefsWriteBackMs(0);
+  model.begin();
+
+  AsyncWebSocket& ws = model.testWebSocket();
+  AsyncWebSocketClient* a = ws._connect();
+  ws._receive(a, R"({"topic":"level","data":{"level":5}})");
+  ws._receive(a, R"({"topic":"metrics","data":{"ws_in":0}})");
+
+  StaticJsonDocument<1024> doc;
+  CUSTOM_ASSERT(!deserializeJson(doc, model.testMakeEnvelope("metrics")), "Envelope should parse");
+  JsonObject data = doc["data"];
+  CUSTOM_ASSERT(data["ws_in"].as<int>() == 2 && data["ws_in_errors"].as<int>() == 1, "Read-only topic rejects updates");
+  CUSTOM_ASSERT(data["nvs_writes"].as<int>() >= 1 && data["clients"].as<int>() == 1, "NVS writes and clients are listed");
+  JsonArray topics = data["topics"];
+  const std::string first = topics.size() ? topics[0].as<const char*>() : "";
+  CUSTOM_ASSERT(first.find("level apply=1x") == 0, "Active topics are listed with their histograms");
+  CUSTOM_ASSERT(first.find(" save=") != std::string::npos && first.find(" nvs=") != std::string::npos,
+                "Saves and NVS writes per topic are listed");
+
+  ModelBase::MetricsSource sources[] = {{"admin", &model}, {"user", &model}};
+  String out;
+  ModelBase::writePrometheus(out, sources, 2);
+  const std::string text = out.c_str();
+  size_t families = 0;
+  for (size_t pos = text.find("# TYPE model_ws_messages_received_total"); pos != std::string::npos;
+       pos = text.find("# TYPE model_ws_messages_received_total", pos + 1)) {
+    families++;
+  }
+  CUSTOM_ASSERT(families == 1, "Each family is declared once for all models");
+  CUSTOM_ASSERT(text.find("model_ws_messages_received_total{model=\"user\"} 2\n") != std::string::npos,
+                "Samples carry the model label");
+  CUSTOM_ASSERT(text.find("model_topic_apply_seconds_count{model=\"admin\",topic=\"level\"} 1\n") != std::string::npos,
+                "Topic histograms carry model and topic labels");
+  CUSTOM_ASSERT(text.find("model_topic_parse_seconds_count{model=\"admin\",topic=\"level\"}") == std::string::npos,
+                "Empty histograms are left out");
+
+  TEST_END();
+}
+#endif
+
+void runAllTests() {
+  SUITE_START("METRICS");
+  test_histogram_buckets();
+  test_prometheus_histogram_text();
+#ifdef NATIVE_BUILD
+  test_ws_and_topic_counters();
+  test_metrics_topic_and_prometheus();
+#endif
+  SUITE_END("METRICS");
+}
+
+} // namespace MetricsTest
@@ -45,7 +45,7 @@ struct AutoSaveTopic {
     return s;
   }
 
-  void setSaveCallback(std::function<void()> cb) {
+  void setSaveCallback(fj::Callback cb) {
     counter.setOnChange(cb);
   }
 };
@@ -232,6 +232,256 @@ void test_corrupted_prefs_is_rewritten_with_defaults() {
   TEST_END();
 }
 
+static int readSavedCounter(const char* key) {
+  Preferences prefs;
+  prefs.begin("model", true);
+  String saved = prefs.getString(key, "");
+  prefs.end();
+
+  StaticJsonDocument<256> doc;
+  if (deserializeJson(doc, saved)) return -1;
+  return doc["counter"]["value"].as<int>();
+}
+
+void test_coalesced_changes_persist_on_loop() {
+  TEST_START("ModelBase coalesced changes persist on loop()");
+
+  clearModelNamespace();
+
+  TestModelBase model(80, "/ws");
+  AutoSaveTopic settings;
+  settings.counter = 1;
+
+  model.registerTopic("coalesce", settings, true, false);
+  model.begin();
+  model.setCoalesceWindowMs(0);
+
+  settings.counter = 2;
+  settings.counter = 3;
+  settings.counter = 4;
+
+  CUSTOM_ASSERT(model.hasPendingChanges(), "Changes should be pending before loop()");
+  CUSTOM_ASSERT(readSavedCounter("coalesce") == 1, "Prefs should still hold the value from begin()");
+
+  model.loop();
+
+  CUSTOM_ASSERT(!model.hasPendingChanges(), "loop() should flush pending changes");
+  CUSTOM_ASSERT(readSavedCounter("coalesce") == 4, "Prefs should hold the last value after loop()");
+
+  TEST_END();
+}
+
+void test_coalesce_window_delays_flush() {
+  TEST_START("ModelBase coalesce window delays flush");
+
+  clearModelNamespace();
+
+  TestModelBase model(80, "/ws");
+  AutoSaveTopic settings;
+  settings.counter = 1;
+
+  model.registerTopic("window", settings, true, false);
+  model.begin();
+  model.setCoalesceWindowMs(20);
+
+  settings.counter = 7;
+  model.loop();
+  CUSTOM_ASSERT(readSavedCounter("window") == 1, "loop() inside the window should not flush");
+
+  delay(25);
+  model.loop();
+  CUSTOM_ASSERT(readSavedCounter("window") == 7, "loop() after the window should flush");
+
+  TEST_END();
+}
+
+void test_discard_pending_drops_coalesced_save() {
+  TEST_START("ModelBase discardPending() drops pending saves");
+
+  clearModelNamespace();
+
+  TestModelBase model(80, "/ws");
+  AutoSaveTopic settings;
+  settings.counter = 1;
+
+  model.registerTopic("discard", settings, true, false);
+  model.begin();
+  model.setCoalesceWindowMs(0);
+
+  settings.counter = 5;
+  model.discardPending();
+  CUSTOM_ASSERT(!model.hasPendingChanges(), "Nothing should be pending after discardPending()");
+
+  model.loop();
+  CUSTOM_ASSERT(readSavedCounter("discard") == 1, "loop() should not write the discarded change");
+
+  TEST_END();
+}
+
+void test_batch_flushes_once_at_scope_end() {
+  TEST_START("ModelBase batch() flushes at scope end");
+
+  clearModelNamespace();
+
+  TestModelBase model(80, "/ws");
+  AutoSaveTopic settings;
+  settings.counter = 1;
+
+  model.registerTopic("batch", settings, true, false);
+  model.begin();
+
+  {
+    ModelBase::Batch b = model.batch();
+    settings.counter = 5;
+    settings.counter = 6;
+    CUSTOM_ASSERT(readSavedCounter("batch") == 1, "Changes inside a batch should not persist yet");
+
+    // loop() must not flush while a batch is open
+    model.loop();
+    CUSTOM_ASSERT(readSavedCounter("batch") == 1, "loop() should not flush inside a batch");
+  }
+
+  CUSTOM_ASSERT(!model.hasPendingChanges(), "Batch end should flush in immediate mode");
+  CUSTOM_ASSERT(readSavedCounter("batch") == 6, "Prefs should hold the last value after the batch");
+
+  TEST_END();
+}
+
+void test_identical_payload_is_not_rewritten() {
+  TEST_START("ModelBase skips NVS write for identical payload");
+
+  clearModelNamespace();
+
+  TestModelBase model(80, "/ws");
+  SettingsTopic settings;
+  settings.counter = 3;
+
+  model.registerTopic("identical", settings, true, false);
+  model.begin();
+  model.resetPrefsStats();
+
+  CUSTOM_ASSERT(model.saveTopic("identical"), "saveTopic should succeed");
+  CUSTOM_ASSERT(model.prefsStats().writes == 0, "Unchanged payload should not be written");
+  CUSTOM_ASSERT(model.prefsStats().skippedUnchanged == 1, "Skip should be counted");
+
+  settings.counter = 4;
+  CUSTOM_ASSERT(model.saveTopic("identical"), "saveTopic should succeed");
+  CUSTOM_ASSERT(model.prefsStats().writes == 1, "Changed payload should be written once");
+  CUSTOM_ASSERT(readSavedCounter("identical") == 4, "Prefs should hold the new value");
+
+  TEST_END();
+}
+
+void test_prefs_write_back_defers_and_merges() {
+  TEST_START("ModelBase Prefs write-back defers and merges saves");
+
+  clearModelNamespace();
+
+  TestModelBase model(80, "/ws");
+  AutoSaveTopic settings;
+  settings.counter = 1;
+
+  model.registerTopic("writeback", settings, true, false);
+  model.begin();
+  model.setPrefsWriteBackMs(20);
+  model.resetPrefsStats();
+
+  for (int i = 2; i <= 10; ++i) settings.counter = i;  // e.g. a slider being dragged
+
+  model.loop();
+  CUSTOM_ASSERT(readSavedCounter("writeback") == 1, "Nothing should be written inside the write-back window");
+  CUSTOM_ASSERT(model.prefsStats().merged == 8, "Repeated saves should merge into the pending one");
+
+  delay(25);
+  model.loop();
+  CUSTOM_ASSERT(readSavedCounter("writeback") == 10, "Write-back should persist the last value");
+  CUSTOM_ASSERT(model.prefsStats().writes == 1, "Write-back should cost a single NVS write");
+  CUSTOM_ASSERT(!model.hasPendingChanges(), "Nothing should be pending after write-back");
+
+  settings.counter = 11;
+  model.flush();
+  CUSTOM_ASSERT(readSavedCounter("writeback") == 11, "flush() should write pending topics immediately");
+
+  TEST_END();
+}
+
+void test_msgpack_format_roundtrip() {
+  TEST_START("ModelBase MessagePack Prefs format round-trip");
+
+  clearModelNamespace();
+
+  {
+    TestModelBase model(80, "/ws");
+    SettingsTopic settings;
+    settings.counter = 321;
+    model.setPrefsFormat(ModelBase::PrefsFormat::MsgPack);
+    model.registerTopic("mpack", settings, true, false);
+    model.begin();
+  }
+
+  Preferences prefs;
+  prefs.begin("model", true);
+  PreferenceType type = prefs.getType("mpack");
+  uint8_t tag = 0;
+  size_t len = prefs.getBytesLength("mpack");
+  uint8_t buf[64];
+  if (len > 0 && len <= sizeof(buf)) {
+    prefs.getBytes("mpack", buf, sizeof(buf));
+    tag = buf[0];
+  }
+  prefs.end();
+
+  CUSTOM_ASSERT(type == PT_BLOB, "MessagePack topic should be stored as blob");
+  CUSTOM_ASSERT(tag == ModelBase::PREFS_MSGPACK_V1, "Blob should start with the version tag");
+
+  TestModelBase model(80, "/ws");
+  SettingsTopic loaded;
+  loaded.counter = 0;
+  model.setPrefsFormat(ModelBase::PrefsFormat::MsgPack);
+  model.registerTopic("mpack", loaded, true, false);
+  model.begin();
+
+  CUSTOM_ASSERT(loaded.counter.get() == 321, "Value should load back from MessagePack");
+
+  TEST_END();
+}
+
+void test_json_prefs_migrate_to_msgpack() {
+  TEST_START("ModelBase migrates JSON Prefs to MessagePack");
+
+  clearModelNamespace();
+
+  Preferences prefs;
+  prefs.begin("model", false);
+  prefs.putString("migrate", R"({"counter":{"value":55}})");
+  prefs.end();
+
+  TestModelBase model(80, "/ws");
+  SettingsTopic settings;
+  settings.counter = 1;
+  model.setPrefsFormat(ModelBase::PrefsFormat::MsgPack);
+  model.registerTopic("migrate", settings, true, false);
+  model.begin();
+
+  CUSTOM_ASSERT(settings.counter.get() == 55, "Legacy JSON value should be loaded");
+
+  prefs.begin("model", true);
+  PreferenceType type = prefs.getType("migrate");
+  prefs.end();
+  CUSTOM_ASSERT(type == PT_BLOB, "Topic should be rewritten as MessagePack blob");
+
+  // And back: a JSON-configured model still reads the blob.
+  TestModelBase jsonModel(80, "/ws");
+  SettingsTopic again;
+  again.counter = 0;
+  jsonModel.registerTopic("migrate", again, true, false);
+  jsonModel.begin();
+  CUSTOM_ASSERT(again.counter.get() == 55, "JSON model should read the MessagePack blob");
+  CUSTOM_ASSERT(readSavedCounter("migrate") == 55, "Topic should be migrated back to JSON");
+
+  TEST_END();
+}
+
 void runAllTests() {
   SUITE_START("MODELBASE PREFS");
   test_begin_initializes_missing_prefs_key();
@@ -240,6 +490,14 @@ void runAllTests() {
   test_setSaveCallback_auto_persists_on_change();
   test_without_setSaveCallback_does_not_auto_persist();
   test_corrupted_prefs_is_rewritten_with_defaults();
+  test_coalesced_changes_persist_on_loop();
+  test_coalesce_window_delays_flush();
+  test_discard_pending_drops_coalesced_save();
+  test_batch_flushes_once_at_scope_end();
+  test_identical_payload_is_not_rewritten();
+  test_prefs_write_back_defers_and_merges();
+  test_msgpack_format_roundtrip();
+  test_json_prefs_migrate_to_msgpack();
   SUITE_END("MODELBASE PREFS");
 }
 
@@ -31,6 +31,74 @@ struct SettingsTopic {
   }
 };
 
+struct PatchTopic {
+  fj::VarWsPrefsRw<int> window;
+  fj::VarWsRo<int> remaining;
+
+  typedef fj::Schema<PatchTopic,
+                     fj::Field<PatchTopic, decltype(window)>,
+                     fj::Field<PatchTopic, decltype(remaining)>>
+      SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<PatchTopic>(
+        fj::Field<PatchTopic, decltype(window)>{"window", &PatchTopic::window},
+        fj::Field<PatchTopic, decltype(remaining)>{"remaining", &PatchTopic::remaining});
+    return s;
+  }
+};
+
+void test_ws_patch_contains_only_changed_fields() {
+  TEST_START("fj::write_ws_patch writes only changed fields");
+
+  PatchTopic t;
+  t.window = 600;
+  t.remaining = 10;
+
+  const uint32_t since = fj::currentGeneration();
+  t.remaining = 9;
+
+  StaticJsonDocument<256> doc;
+  JsonObject out = doc.to<JsonObject>();
+  bool patchable = fj::write_ws_patch(t, out, since);
+
+  CUSTOM_ASSERT(patchable, "Schema topic with Var fields should be patchable");
+  CUSTOM_ASSERT(out.size() == 1, "Patch should contain exactly one field");
+  CUSTOM_ASSERT(out.containsKey("remaining"), "Patch should contain 'remaining'");
+  CUSTOM_ASSERT(!out.containsKey("window"), "Patch should not contain unchanged 'window'");
+  CUSTOM_ASSERT(out["remaining"]["value"].as<int>() == 9, "Patched value should be 9");
+
+  doc.clear();
+  out = doc.to<JsonObject>();
+  CUSTOM_ASSERT(fj::write_ws_patch(t, out, fj::currentGeneration()), "Patchable even when nothing changed");
+  CUSTOM_ASSERT(out.size() == 0, "No changes should yield an empty patch");
+
+  TEST_END();
+}
+
+void test_ws_patch_survives_generation_wrap() {
+  TEST_START("fj::write_ws_patch across the generation clock wrap");
+
+  PatchTopic t;
+  const uint32_t saved = fj::detail::generationClock();
+  fj::detail::generationClock() = 0xFFFFFFF0u;
+  t.window = 600;
+  const uint32_t since = fj::currentGeneration();
+  fj::detail::generationClock() = 0xFFFFFFFEu;
+  t.remaining = 1;  // 0xFFFFFFFF
+  t.remaining = 2;  // wraps to 0
+
+  StaticJsonDocument<256> doc;
+  JsonObject out = doc.to<JsonObject>();
+  (void)fj::write_ws_patch(t, out, since);
+  fj::detail::generationClock() = saved;
+
+  CUSTOM_ASSERT(out.containsKey("remaining"), "Field changed after the wrap should be in the patch");
+  CUSTOM_ASSERT(!out.containsKey("window"), "Field unchanged since before the wrap should not");
+
+  TEST_END();
+}
+
 void test_ws_envelope_applies_update_without_prefs() {
   TEST_START("ModelBase WS handleIncoming applies update");
 
@@ -106,11 +174,91 @@ void test_ws_unknown_topic_returns_false() {
   TEST_END();
 }
 
+#ifdef NATIVE_BUILD
+// Host only: the stub AsyncWebSocket can simulate connected clients.
+void test_broadcast_topic_streams_envelope_to_all_clients() {
+  TEST_START("ModelBase broadcastTopic streams envelope to every client");
+
+  TestModelBase model(80, "/ws");
+  SettingsTopic settings;
+  settings.counter = 5;
+  model.registerTopic("settings", settings, false, true);
+
+  AsyncWebSocket& ws = model.testWebSocket();
+  CUSTOM_ASSERT(model.broadcastTopic("settings"), "Broadcast without clients should succeed (no-op)");
+
+  // begin() is not called, so connecting does not trigger the initial-state broadcast.
+  AsyncWebSocketClient* a = ws._connect();
+  AsyncWebSocketClient* b = ws._connect();
+
+  CUSTOM_ASSERT(model.broadcastTopic("settings"), "Broadcast should succeed");
+
+  const String expected = model.testMakeEnvelope("settings");
+  CUSTOM_ASSERT(a->_sent.size() == 1 && b->_sent.size() == 1, "Each client should receive exactly one frame");
+  CUSTOM_ASSERT(a->_sent[0].opcode == WS_TEXT, "Envelope should be sent as text frame");
+  CUSTOM_ASSERT(a->_sent[0].payload == expected.c_str(), "Streamed envelope should match makeEnvelope()");
+  CUSTOM_ASSERT(b->_sent[0].payload == a->_sent[0].payload, "All clients should receive the same payload");
+
+  TEST_END();
+}
+
+void test_broadcast_changes_sends_patch() {
+  TEST_START("ModelBase broadcastChanges sends patch envelope");
+
+  TestModelBase model(80, "/ws");
+  PatchTopic t;
+  t.window = 600;
+  t.remaining = 10;
+  model.registerTopic("ota", t, false, true);
+
+  AsyncWebSocket& ws = model.testWebSocket();
+  AsyncWebSocketClient* a = ws._connect();
+
+  t.remaining = 9;
+  CUSTOM_ASSERT(model.broadcastChanges("ota"), "broadcastChanges should succeed");
+  CUSTOM_ASSERT(a->_sent.size() == 1, "Client should receive one frame");
+  CUSTOM_ASSERT(a->_sent[0].payload == R"({"topic":"ota","tid":0,"patch":{"remaining":{"value":9}}})",
+                "Frame should be a patch with only the changed field");
+
+  CUSTOM_ASSERT(model.broadcastChanges("ota"), "Unchanged topic should succeed");
+  CUSTOM_ASSERT(a->_sent.size() == 1, "Unchanged topic should send nothing");
+
+  // A full broadcast resets the baseline as well.
+  t.window = 300;
+  CUSTOM_ASSERT(model.broadcastTopic("ota"), "broadcastTopic should succeed");
+  CUSTOM_ASSERT(model.broadcastChanges("ota"), "broadcastChanges after full broadcast should succeed");
+  CUSTOM_ASSERT(a->_sent.size() == 2, "Only the full envelope should have been added");
+
+  TEST_END();
+}
+
+void test_standalone_server_is_owned_on_demand() {
+  TEST_START("ModelBase allocates a server only for standalone()");
+
+  TestModelBase model(80, "/ws");
+  AsyncWebServer* server = model.standalone(8080);
+  CUSTOM_ASSERT(server != nullptr, "standalone() should allocate a server");
+  CUSTOM_ASSERT(server->_port() == 8080, "Server should listen on the requested port");
+  CUSTOM_ASSERT(server->_handlers().size() == 1 && server->_handlers()[0] == &model.testWebSocket(),
+                "Model socket should be attached to the standalone server");
+  CUSTOM_ASSERT(model.standalone(9090) == server, "Later calls should return the same server");
+
+  TEST_END();
+}
+#endif
+
 void runAllTests() {
   SUITE_START("MODELBASE WS UPDATE");
+  test_ws_patch_contains_only_changed_fields();
+  test_ws_patch_survives_generation_wrap();
   test_ws_envelope_applies_update_without_prefs();
   test_ws_envelope_persists_when_enabled();
   test_ws_unknown_topic_returns_false();
+#ifdef NATIVE_BUILD
+  test_broadcast_topic_streams_envelope_to_all_clients();
+  test_broadcast_changes_sends_patch();
+  test_standalone_server_is_owned_on_demand();
+#endif
   SUITE_END("MODELBASE WS UPDATE");
 }
 
@@ -325,7 +325,7 @@ void testSettingsStructCallbackIntegration() {
     fj::VarMetaPrefsRw<StringBuffer<64>> password;
     fj::VarWsRo<int> count;
 
-    void setSaveCallback(std::function<void()> cb) {
+    void setSaveCallback(fj::Callback cb) {
       name.setOnChange(cb);
       password.setOnChange(cb);
       count.setOnChange(cb);
@@ -0,0 +1,179 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <ArduinoJson.h>
+
+#include "../../src/model/ModelBase.h"
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/types/ModelTypePrimitive.h"
+
+namespace TopicIndexTest {
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+struct CounterTopic {
+  fj::VarWsPrefsRw<int> counter;
+
+  typedef fj::Schema<CounterTopic, fj::Field<CounterTopic, decltype(counter)>> SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<CounterTopic>(
+        fj::Field<CounterTopic, decltype(counter)>{"counter", &CounterTopic::counter});
+    return s;
+  }
+
+  void setSaveCallback(fj::Callback cb) { counter.setOnChange(cb); }
+};
+
+static_assert(ModelBase::nameHash("") == 2166136261u, "Empty name hashes to the FNV offset basis");
+static_assert(ModelBase::nameHash("a") == 0xe40c292cu, "FNV-1a reference value");
+static_assert(ModelBase::nameHash("b", ModelBase::nameHash("a")) == ModelBase::nameHash("ab"), "Hashes chain");
+
+static const char* const NAMES[] = {"wifi", "ota", "admin", "mdns", "time", "build", "ws_clients", "sensor_0",
+                                    "sensor_1", "sensor_2", "sensor_3", "sensor_4", "sensor_5", "sensor_6",
+                                    "sensor_7", "sensor_8"};
+static const size_t NAME_COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+void test_lookup_by_name_and_id() {
+  TEST_START("ModelBase topic index resolves names and ids");
+
+  TestModelBase model(80, "/ws");
+  static CounterTopic topics[NAME_COUNT];
+  for (size_t i = 0; i < NAME_COUNT; ++i) model.registerTopic(NAMES[i], topics[i], false, false);
+
+  bool allFound = true;
+  for (size_t i = 0; i < NAME_COUNT; ++i) allFound = allFound && model.topicId(NAMES[i]) == (int)i;
+  CUSTOM_ASSERT(allFound, "Every registered topic should resolve to its registration index");
+  CUSTOM_ASSERT(model.topicId("sensor_9") == -1, "Unregistered topic should not resolve");
+  CUSTOM_ASSERT(model.topicId("") == -1, "Empty name should not resolve");
+  CUSTOM_ASSERT(model.topicId(nullptr) == -1, "nullptr should not resolve");
+
+  // Full arena: the next registration grows the registry and rebuilds the index.
+  CUSTOM_ASSERT(model.topicCapacity() == MODEL_TOPIC_RESERVE, "Registry should start at MODEL_TOPIC_RESERVE");
+  CounterTopic extra;
+  CUSTOM_ASSERT(model.registerTopic("extra", extra, false, false), "Registration beyond the reserve should succeed");
+  CUSTOM_ASSERT(model.topicId("extra") == 16, "Topic beyond the reserve is registered");
+  CUSTOM_ASSERT(model.topicCapacity() == 2 * MODEL_TOPIC_RESERVE, "Registry should double");
+  CUSTOM_ASSERT(model.topicId("sensor_8") == 15, "Existing topics still resolve");
+  CUSTOM_ASSERT(model.topicRegistrationErrors() == 0, "No registration should have failed");
+
+  TEST_END();
+}
+
+void test_duplicate_name_keeps_first() {
+  TEST_START("ModelBase topic index keeps the first registration of a name");
+
+  TestModelBase model(80, "/ws");
+  CounterTopic a;
+  CounterTopic b;
+  model.registerTopic("dup", a, false, false);
+  model.registerTopic("dup", b, false, false);
+
+  const char* msg = R"({"topic":"dup","data":{"counter":5}})";
+  CUSTOM_ASSERT(model.testHandleWsMessage(msg, strlen(msg)), "Update should succeed");
+  CUSTOM_ASSERT(model.topicId("dup") == 0, "Name should resolve to the first registration");
+  CUSTOM_ASSERT(a.counter.get() == 5 && b.counter.get() == 0, "Update should go to the first registration");
+
+  TEST_END();
+}
+
+void test_update_by_tid() {
+  TEST_START("ModelBase accepts updates addressed by tid");
+
+  TestModelBase model(80, "/ws");
+  CounterTopic first;
+  CounterTopic second;
+  model.registerTopic("first", first, false, true);
+  model.registerTopic("second", second, false, true);
+
+  String env = model.testMakeEnvelope("second");
+  CUSTOM_ASSERT(env.indexOf("\"tid\":1") >= 0, "Envelope should carry the topic id");
+
+  const char* scanned = R"({"tid":1,"data":{"counter":7}})";
+  CUSTOM_ASSERT(model.testHandleWsMessage(scanned, strlen(scanned)), "tid update should succeed");
+  CUSTOM_ASSERT(second.counter.get() == 7 && first.counter.get() == 0, "tid should select the second topic");
+
+  model.setWsScan(false);
+  const char* parsed = R"({"tid":0,"data":{"counter":3}})";
+  CUSTOM_ASSERT(model.testHandleWsMessage(parsed, strlen(parsed)), "tid update should succeed without scanner");
+  CUSTOM_ASSERT(first.counter.get() == 3, "JsonDocument path should resolve tid as well");
+
+  const char* unknown = R"({"tid":9,"data":{"counter":1}})";
+  CUSTOM_ASSERT(!model.testHandleWsMessage(unknown, strlen(unknown)), "Unknown tid should fail");
+  model.setWsScan(true);
+  CUSTOM_ASSERT(!model.testHandleWsMessage(unknown, strlen(unknown)), "Unknown tid should fail with scanner");
+  const char* negative = R"({"tid":-1,"data":{"counter":1}})";
+  CUSTOM_ASSERT(!model.testHandleWsMessage(negative, strlen(negative)), "Negative tid should fail");
+
+  TEST_END();
+}
+
+void test_reserve_and_limit() {
+  TEST_START("ModelBase topic registry reserve and MODEL_MAX_TOPICS");
+
+  TestModelBase model(80, "/ws");
+  CUSTOM_ASSERT(model.topicCapacity() == 0, "Nothing is allocated before the first registration");
+  CUSTOM_ASSERT(model.reserveTopics(40), "Reserve should succeed");
+  CUSTOM_ASSERT(model.topicCapacity() == 64, "Capacity is rounded up to a power of two");
+  CUSTOM_ASSERT(!model.reserveTopics(MODEL_MAX_TOPICS + 1), "Reserve beyond MODEL_MAX_TOPICS should fail");
+  CUSTOM_ASSERT(model.topicCapacity() == 64, "Failed reserve keeps the registry");
+
+  static CounterTopic topics[MODEL_MAX_TOPICS + 1];
+  static char names[MODEL_MAX_TOPICS + 1][12];
+  bool allRegistered = true;
+  for (size_t i = 0; i < MODEL_MAX_TOPICS; ++i) {
+    snprintf(names[i], sizeof(names[i]), "t%u", (unsigned)i);
+    allRegistered = model.registerTopic(names[i], topics[i], false, false) && allRegistered;
+  }
+  CUSTOM_ASSERT(allRegistered, "Registrations up to MODEL_MAX_TOPICS should succeed");
+  CUSTOM_ASSERT(model.topicCount() == MODEL_MAX_TOPICS, "Every topic should be counted");
+
+  bool allFound = true;
+  for (size_t i = 0; i < MODEL_MAX_TOPICS; ++i) allFound = allFound && model.topicId(names[i]) == (int)i;
+  CUSTOM_ASSERT(allFound, "Every topic should resolve after repeated growth");
+
+  snprintf(names[MODEL_MAX_TOPICS], sizeof(names[MODEL_MAX_TOPICS]), "overflow");
+  CUSTOM_ASSERT(!model.registerTopic(names[MODEL_MAX_TOPICS], topics[MODEL_MAX_TOPICS], false, false),
+                "Registration beyond MODEL_MAX_TOPICS should fail");
+  CUSTOM_ASSERT(model.topicRegistrationErrors() == 1, "Overflow should be counted");
+  CUSTOM_ASSERT(model.topicId("overflow") == -1, "Rejected topic should not resolve");
+  CUSTOM_ASSERT(model.topicCount() == MODEL_MAX_TOPICS, "Rejected topic should not be counted");
+
+  TEST_END();
+}
+
+void test_save_callback_after_growth() {
+  TEST_START("ModelBase change callbacks survive registry growth");
+
+  TestModelBase model(80, "/ws");
+  static CounterTopic topics[NAME_COUNT + 1];
+  for (size_t i = 0; i < NAME_COUNT; ++i) model.registerTopic(NAMES[i], topics[i], false, true);
+  // Moves every entry registered so far into a new arena.
+  model.registerTopic("extra", topics[NAME_COUNT], false, true);
+
+  AsyncWebSocketClient* client = model.testWebSocket()._connect();
+  const size_t before = client->_sent.size();
+  topics[1].counter.set(42);
+  CUSTOM_ASSERT(client->_sent.size() == before + 1, "Change should broadcast its topic");
+  CUSTOM_ASSERT(client->_sent.back().payload.find("\"topic\":\"ota\"") != std::string::npos,
+                "Callback should still address the topic it was registered for");
+  CUSTOM_ASSERT(client->_sent.back().payload.find("\"tid\":1") != std::string::npos, "Broadcast should carry the topic id");
+
+  TEST_END();
+}
+
+void runAllTests() {
+  SUITE_START("TOPIC INDEX");
+  test_lookup_by_name_and_id();
+  test_duplicate_name_keeps_first();
+  test_update_by_tid();
+  test_reserve_and_limit();
+  test_save_callback_after_growth();
+  SUITE_END("TOPIC INDEX");
+}
+
+} // namespace TopicIndexTest
@@ -253,6 +253,59 @@ void testVarOnChange() {
   TEST_END();
 }
 
+typedef fj::OnChange<fj::VarWsRo<int>> OnChangeInt;
+static_assert(std::is_same<OnChangeInt,
+                           fj::Var<int, fj::WsMode::Value, fj::PrefsMode::Off, fj::WriteMode::Off,
+                                   fj::NotifyMode::OnChange>>::value,
+              "OnChange<> keeps the other policies");
+
+void testVarNotifyOnChange() {
+  TEST_START("Var NotifyMode::OnChange skips unchanged values");
+
+  int changeCount = 0;
+  fj::OnChange<fj::VarWsPrefsRw<int>> num;
+  num.setOnChange([&changeCount]() { changeCount++; });
+  num.set(5);
+  const uint32_t gen = num.generation();
+  num.set(5);
+  num = 5;
+  CUSTOM_ASSERT(changeCount == 1, "Same int should not notify");
+  CUSTOM_ASSERT(num.generation() == gen, "Same int should not advance the change clock");
+  num.set(6);
+  CUSTOM_ASSERT(changeCount == 2 && num.generation() > gen, "Different int should notify");
+  num.touch();
+  CUSTOM_ASSERT(changeCount == 3, "touch() should always notify");
+
+  int strCount = 0;
+  fj::OnChange<fj::VarWsRo<StringBuffer<16>>> str;
+  str.setOnChange([&strCount]() { strCount++; });
+  str.set("12:00:01");
+  str.set("12:00:01");
+  const String same("12:00:01");
+  str.set(same);
+  str.set(StringBuffer<16>("12:00:01"));
+  CUSTOM_ASSERT(strCount == 1, "Same string should not notify (const char*, String, StringBuffer)");
+  str.set("12:00:02");
+  CUSTOM_ASSERT(strCount == 2, "Different string should notify");
+
+  int flagCount = 0;
+  fj::OnChange<fj::VarWsRo<bool>> flag;
+  flag.setOnChange([&flagCount]() { flagCount++; });
+  flag.set(false);
+  flag.set(true);
+  flag.set(true);
+  CUSTOM_ASSERT(flagCount == 1, "Only the false -> true transition should notify");
+
+  int alwaysCount = 0;
+  fj::VarWsRo<int> always;
+  always.setOnChange([&alwaysCount]() { alwaysCount++; });
+  always.set(0);
+  always.set(0);
+  CUSTOM_ASSERT(alwaysCount == 2, "Default NotifyMode::Always should notify every set()");
+
+  TEST_END();
+}
+
 // Test struct for VarMetaPrefsRw roundtrip test (must be outside function)
 struct PasswordSettings {
   static const int PASS_LEN = 64;
@@ -287,7 +340,7 @@ void testVarMetaPrefsRwRoundtrip() {
   
   // CRITICAL: Verify the password VALUE is in the saved JSON
   CUSTOM_ASSERT(jsonSaved.indexOf("MySecretPassword123") > 0, 
-              "BUG: Password value MUST be in Prefs JSON! Found: " + jsonSaved);
+              ("BUG: Password value MUST be in Prefs JSON! Found: " + jsonSaved).c_str());
   
   // Deserialize from Prefs JSON (simulating load)
   PasswordSettings settings2;
@@ -329,6 +382,7 @@ void runAllTests() {
   testPrefsFiltering();
   testReadOnlyRejection();
   testVarOnChange();
+  testVarNotifyOnChange();
   testVarMetaPrefsRwRoundtrip();  // NEW: Would have caught the bug!
   
   SUITE_END("VAR MODES");
@@ -0,0 +1,156 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <ArduinoJson.h>
+
+#include "../../src/model/ModelBase.h"
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/types/ModelTypePrimitive.h"
+
+namespace VarThrottleTest {
+
+static_assert(std::is_empty<fj::NoThrottle::State<float>>::value, "Ungated Vars carry no gate state");
+typedef fj::Gated<fj::VarWsRo<float>, fj::Throttle<100, 100>> GatedFloat;
+static_assert(std::is_same<GatedFloat, fj::Var<float, fj::WsMode::Value, fj::PrefsMode::Off, fj::WriteMode::Off,
+                                               fj::NotifyMode::Always, fj::Throttle<100, 100>>>::value,
+              "Gated<> keeps the other policies");
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+struct SensorTopic {
+  fj::Gated<fj::VarWsRo<float>, fj::Throttle<100>> temp;
+  fj::VarWsRo<int> plain;
+
+  typedef fj::Schema<SensorTopic, fj::Field<SensorTopic, decltype(temp)>, fj::Field<SensorTopic, decltype(plain)>>
+      SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<SensorTopic>(fj::Field<SensorTopic, decltype(temp)>{"temp", &SensorTopic::temp},
+                                                            fj::Field<SensorTopic, decltype(plain)>{"plain", &SensorTopic::plain});
+    return s;
+  }
+
+  void setSaveCallback(fj::Callback cb) {
+    temp.setOnChange(cb);
+    plain.setOnChange(cb);
+  }
+};
+
+struct PlainTopic {
+  fj::VarWsRo<int> plain;
+
+  typedef fj::Schema<PlainTopic, fj::Field<PlainTopic, decltype(plain)>> SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<PlainTopic>(fj::Field<PlainTopic, decltype(plain)>{"plain", &PlainTopic::plain});
+    return s;
+  }
+};
+
+static_assert(fj::Throttled<SensorTopic>::value, "Topic with a gated field needs polling");
+static_assert(!fj::Throttled<PlainTopic>::value, "Topic without gated fields is not polled");
+
+void test_rate_limit_trailing_edge() {
+  TEST_START("Throttle<> rate limit delivers the last value on the trailing edge");
+
+  int changes = 0;
+  fj::Gated<fj::VarWsRo<float>, fj::Throttle<100>> var;
+  var.setOnChange([&changes]() { changes++; });
+
+  var.set(1.0f);
+  CUSTOM_ASSERT(changes == 1, "First set should notify");
+  var.set(2.0f);
+  var.set(3.0f);
+  CUSTOM_ASSERT(changes == 1, "Sets within the interval should be held back");
+  CUSTOM_ASSERT(!var.poll(), "Nothing is due before the interval has passed");
+
+  delay(100);
+  CUSTOM_ASSERT(var.poll(), "Held-back change should be delivered after the interval");
+  CUSTOM_ASSERT(changes == 2 && var.get() == 3.0f, "Trailing notification carries the last value");
+  CUSTOM_ASSERT(!var.poll(), "Trailing edge fires once");
+
+  var.touch();
+  CUSTOM_ASSERT(changes == 3, "touch() should bypass the rate limit");
+
+  int dropped = 0;
+  fj::Gated<fj::VarWsRo<float>, fj::Throttle<100, 0, 0, false>> leading;
+  leading.setOnChange([&dropped]() { dropped++; });
+  leading.set(1.0f);
+  leading.set(2.0f);
+  delay(100);
+  CUSTOM_ASSERT(!leading.poll() && dropped == 1, "Without Trailing the held-back change is dropped");
+
+  TEST_END();
+}
+
+void test_deadband() {
+  TEST_START("Deadband<> drops changes below the threshold");
+
+  int absChanges = 0;
+  fj::Gated<fj::VarWsRo<float>, fj::Deadband<100>> absVar;  // 0.1
+  absVar.setOnChange([&absChanges]() { absChanges++; });
+  absVar.set(20.0f);
+  absVar.set(20.05f);
+  absVar.set(19.95f);
+  CUSTOM_ASSERT(absChanges == 1, "Changes below 0.1 should be dropped");
+  absVar.set(20.2f);
+  CUSTOM_ASSERT(absChanges == 2, "Change of 0.2 should notify");
+  CUSTOM_ASSERT(absVar.get() == 20.2f, "The value itself is always stored");
+
+  int relChanges = 0;
+  fj::Gated<fj::VarWsRo<int>, fj::Deadband<0, 10>> relVar;  // 1 %
+  relVar.setOnChange([&relChanges]() { relChanges++; });
+  relVar.set(1000);
+  relVar.set(1009);
+  CUSTOM_ASSERT(relChanges == 1, "Change below 1 % should be dropped");
+  relVar.set(1011);
+  CUSTOM_ASSERT(relChanges == 2, "Change above 1 % should notify");
+
+  TEST_END();
+}
+
+#ifdef NATIVE_BUILD
+// Host only: counts the frames the stub socket records.
+
+void test_model_loop_polls_throttled_topics() {
+  TEST_START("ModelBase::loop() delivers throttled changes");
+
+  TestModelBase model(80, "/ws");
+  SensorTopic sensor;
+  model.registerTopic("sensor", sensor, false, true);
+
+  AsyncWebSocketClient* c = model.testWebSocket()._connect();
+  const size_t before = c->_sent.size();
+  sensor.temp.set(21.0f);
+  for (int i = 1; i <= 50; ++i) sensor.temp.set(21.0f + (float)i * 0.5f);
+  CUSTOM_ASSERT(c->_sent.size() == before + 1, "A burst should broadcast once");
+
+  model.loop();
+  CUSTOM_ASSERT(c->_sent.size() == before + 1, "loop() within the interval should not broadcast");
+  delay(100);
+  model.loop();
+  CUSTOM_ASSERT(c->_sent.size() == before + 2, "loop() after the interval should broadcast the trailing change");
+  CUSTOM_ASSERT(c->_sent.back().payload.find("\"value\":46") != std::string::npos, "Trailing broadcast carries the last value");
+
+  sensor.plain.set(7);
+  CUSTOM_ASSERT(c->_sent.size() == before + 3, "Ungated fields of the same topic are not throttled");
+
+  TEST_END();
+}
+#endif
+
+void runAllTests() {
+  SUITE_START("VAR THROTTLE");
+  test_rate_limit_trailing_edge();
+  test_deadband();
+#ifdef NATIVE_BUILD
+  test_model_loop_polls_throttled_topics();
+#endif
+  SUITE_END("VAR THROTTLE");
+}
+
+} // namespace VarThrottleTest
@@ -5,7 +5,11 @@
 #include "../../src/model/types/ModelTypePrimitive.h"
 #include "../../src/model/types/ModelTypeList.h"
 
-// Forward declare WifiSettings (without including full Model.h which needs AsyncWebServer)
+namespace WiFiIntegrationTest {
+
+// Forward declare WifiSettings (without including full Model.h which needs AsyncWebServer).
+// Kept inside the test namespace: AdminModel.h defines its own ::WifiSettings and both
+// end up in the same test binary.
 struct WifiSettingsMinimal
 {
   static const int PASS_LEN = 64;
@@ -56,14 +60,12 @@ struct WifiSettings
     return s;
   }
 
-  void setSaveCallback(std::function<void()> cb) {
+  void setSaveCallback(fj::Callback cb) {
     ssid.setOnChange(cb);
     pass.setOnChange(cb);
   }
 };
 
-namespace WiFiIntegrationTest {
-
 // Mock WiFi scan results
 void simulateWiFiScan() {
   TEST_START("WiFi Scan Simulation");
@@ -0,0 +1,256 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <ArduinoJson.h>
+
+#include "../../src/model/ModelBase.h"
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/types/ModelTypePrimitive.h"
+#include "../../src/model/types/ModelTypeWsClients.h"
+
+namespace WsBackpressureTest {
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+struct CounterTopic {
+  fj::VarWsRo<int> counter;
+
+  typedef fj::Schema<CounterTopic,
+                     fj::Field<CounterTopic, decltype(counter)>>
+      SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<CounterTopic>(
+        fj::Field<CounterTopic, decltype(counter)>{"counter", &CounterTopic::counter});
+    return s;
+  }
+};
+
+#ifdef NATIVE_BUILD
+// Host only: stub clients can hold frames in their queue (_autoDrain = false) like a slow peer.
+
+static AsyncWebSocketClient* connectSlow(TestModelBase& model) {
+  AsyncWebSocketClient* c = model.testWebSocket()._connect();  // begin() registered the handler
+  model.loop();                                                // initial state
+  c->_sent.clear();
+  c->_autoDrain = false;
+  return c;
+}
+
+void test_coalesce_holds_back_and_catches_up() {
+  TEST_START("Coalesce policy holds topic frames for a congested client");
+
+  TestModelBase model(80, "/ws");
+  CounterTopic t;
+  model.registerTopic("counter", t, false, true);
+  model.setClientQueueLimit(2);
+  model.begin();
+
+  AsyncWebSocketClient* fast = model.testWebSocket()._connect();
+  AsyncWebSocketClient* slow = connectSlow(model);
+  fast->_sent.clear();
+
+  for (int i = 1; i <= 4; ++i) {
+    t.counter = i;
+    model.broadcastTopic("counter");
+  }
+  model.sendGraphPointXY("temp", "inside", 1, 1.0f, true);
+
+  CUSTOM_ASSERT(fast->_sent.size() == 4 + 2, "Fast client should get every topic frame and the graph point");
+  // Two topic frames fill the queue; the graph_series announcement (control frame) still goes out.
+  CUSTOM_ASSERT(slow->_sent.size() == 3, "Slow client should stop at the queue limit");
+
+  const ModelBase::ClientStats& st = model.clientStats(1);
+  CUSTOM_ASSERT(st.active && st.id == slow->id(), "Slow client should own the second slot");
+  CUSTOM_ASSERT(st.coalesced == 2, "Two topic frames should be held back");
+  CUSTOM_ASSERT(st.droppedGraph == 1, "Graph point should be dropped");
+  CUSTOM_ASSERT(model.clientStats(0).coalesced == 0, "Fast client should not be affected");
+
+  model.loop();
+  CUSTOM_ASSERT(slow->_sent.size() == 3, "Nothing should be sent while the client is congested");
+
+  slow->_drain();
+  model.loop();
+  CUSTOM_ASSERT(slow->_sent.size() == 4, "loop() should send one catch-up frame after draining");
+  const String latest = model.testMakeEnvelope("counter");
+  CUSTOM_ASSERT(slow->_sent.back().payload == latest.c_str(), "Catch-up frame should carry the latest state");
+
+  model.loop();
+  CUSTOM_ASSERT(slow->_sent.size() == 4, "Caught-up client should not get the state again");
+
+  TEST_END();
+}
+
+void test_drop_graphs_policy_keeps_topics() {
+  TEST_START("DropGraphs policy still queues topic frames");
+
+  TestModelBase model(80, "/ws");
+  CounterTopic t;
+  model.registerTopic("counter", t, false, true);
+  model.setSlowClientPolicy(ModelBase::SlowClientPolicy::DropGraphs);
+  model.setClientQueueLimit(1);
+  model.begin();
+
+  AsyncWebSocketClient* slow = connectSlow(model);
+  t.counter = 1;
+  model.broadcastTopic("counter");
+  t.counter = 2;
+  model.broadcastTopic("counter");
+  model.setGraphBinary(false);
+  model.sendGraphPointXY("temp", "inside", 1, 1.0f, true);
+
+  CUSTOM_ASSERT(slow->_sent.size() == 2, "Both topic frames should be queued");
+  CUSTOM_ASSERT(model.clientStats(0).droppedGraph == 1, "Graph point should be dropped");
+  CUSTOM_ASSERT(model.clientStats(0).coalesced == 0, "Nothing should be coalesced");
+
+  TEST_END();
+}
+
+void test_refused_topic_frame_is_resent_as_full_state() {
+  TEST_START("A topic frame AsyncTCP refuses is replaced by the full state");
+
+  TestModelBase model(80, "/ws");
+  CounterTopic t;
+  model.registerTopic("counter", t, false, true);
+  model.setSlowClientPolicy(ModelBase::SlowClientPolicy::DropGraphs);
+  model.begin();
+
+  AsyncWebSocketClient* slow = connectSlow(model);
+  slow->_queueCapacity = 1;
+  t.counter = 1;
+  model.broadcastTopic("counter");
+  t.counter = 2;
+  model.broadcastTopic("counter");  // queue full: refused
+  CUSTOM_ASSERT(slow->_sent.size() == 1 && model.clientStats(0).failed == 1, "Second frame should be refused");
+
+  slow->_drain();
+  model.loop();
+  CUSTOM_ASSERT(slow->_sent.size() == 2, "loop() should resend the topic");
+  const String latest = model.testMakeEnvelope("counter");
+  CUSTOM_ASSERT(slow->_sent.back().payload == latest.c_str(), "Resent frame should carry the full latest state");
+
+  TEST_END();
+}
+
+void test_clients_beyond_limit_are_refused() {
+  TEST_START("Clients beyond MODEL_MAX_CLIENTS are closed");
+
+  TestModelBase model(80, "/ws");
+  CounterTopic t;
+  model.registerTopic("counter", t, false, true);
+  model.begin();
+
+  AsyncWebSocketClient* clients[MODEL_MAX_CLIENTS + 1];
+  for (size_t i = 0; i <= MODEL_MAX_CLIENTS; ++i) clients[i] = model.testWebSocket()._connect();
+  CUSTOM_ASSERT(clients[0]->status() == WS_CONNECTED, "Clients within the limit stay connected");
+  CUSTOM_ASSERT(clients[MODEL_MAX_CLIENTS]->status() != WS_CONNECTED, "The extra client should be closed");
+
+  TEST_END();
+}
+
+void test_disconnect_policy_closes_stuck_client() {
+  TEST_START("Disconnect policy closes a client that stays congested");
+
+  TestModelBase model(80, "/ws");
+  CounterTopic t;
+  model.registerTopic("counter", t, false, true);
+  model.setSlowClientPolicy(ModelBase::SlowClientPolicy::Disconnect);
+  model.setClientQueueLimit(1);
+  model.begin();
+
+  AsyncWebSocketClient* slow = connectSlow(model);
+  t.counter = 1;
+  model.broadcastTopic("counter");
+  model.loop();
+  CUSTOM_ASSERT(slow->status() == WS_CONNECTED, "Client should stay connected before the timeout");
+
+  delay(MODEL_WS_DISCONNECT_AFTER_MS);
+  model.loop();
+  CUSTOM_ASSERT(slow->status() != WS_CONNECTED, "Client should be closed after the timeout");
+  CUSTOM_ASSERT(model.slowClientDisconnects() == 1, "Disconnect should be counted");
+  CUSTOM_ASSERT(!model.clientStats(0).active, "Slot should be released");
+
+  TEST_END();
+}
+
+void test_connect_snapshot_only_to_new_client() {
+  TEST_START("loop() sends the snapshot to the new client only, paced by its queue");
+
+  TestModelBase model(80, "/ws");
+  CounterTopic t1, t2, t3;
+  model.registerTopic("one", t1, false, true);
+  model.registerTopic("two", t2, false, true);
+  model.registerTopic("three", t3, false, true);
+  model.setClientQueueLimit(2);
+  model.begin();
+
+  AsyncWebSocketClient* a = model.testWebSocket()._connect();
+  CUSTOM_ASSERT(a->_sent.empty(), "The connect event should not serialize anything");
+  t1.counter = 1;
+  model.broadcastTopic("one");
+  CUSTOM_ASSERT(a->_sent.empty(), "Broadcasts should skip the client until its snapshot is out");
+  model.loop();
+  CUSTOM_ASSERT(a->_sent.size() == 3, "First client should get every topic");
+
+  AsyncWebSocketClient* b = model.testWebSocket()._connect(false);
+  model.loop();
+  CUSTOM_ASSERT(a->_sent.size() == 3, "Existing client should not get the snapshot again");
+  CUSTOM_ASSERT(b->_sent.size() == 2, "Snapshot should stop at the queue limit");
+
+  model.loop();
+  CUSTOM_ASSERT(b->_sent.size() == 2, "Rest of the snapshot should wait while the client is congested");
+
+  b->_drain();
+  model.loop();
+  CUSTOM_ASSERT(b->_sent.size() == 3, "loop() should continue the snapshot after draining");
+  CUSTOM_ASSERT(b->_sent[2].payload.find("\"topic\":\"three\"") != std::string::npos,
+                "Snapshot should follow registration order");
+
+  TEST_END();
+}
+
+void test_client_stats_topic() {
+  TEST_START("WsClientStatsTopic publishes per-client counters");
+
+  TestModelBase model(80, "/ws");
+  WsClientStatsTopic stats;
+  stats.model = &model;
+  model.registerTopic("ws_clients", stats, false, true);
+  model.begin();
+
+  AsyncWebSocketClient* a = model.testWebSocket()._connect();
+  (void)a;
+  model.loop();
+  model.broadcastTopic("ws_clients");
+
+  StaticJsonDocument<512> doc;
+  CUSTOM_ASSERT(!deserializeJson(doc, model.testMakeEnvelope("ws_clients")), "Envelope should parse");
+  JsonObject data = doc["data"];
+  const bool policyOk = strcmp(data["policy"] | "", "coalesce") == 0;
+  CUSTOM_ASSERT(policyOk, "Default policy should be coalesce");
+  CUSTOM_ASSERT(data["clients"].as<JsonArray>().size() == 1, "One client row expected");
+  CUSTOM_ASSERT(data["sent"].as<int>() >= 1, "Sent frames should be counted");
+
+  TEST_END();
+}
+#endif
+
+void runAllTests() {
+  SUITE_START("WS BACKPRESSURE");
+#ifdef NATIVE_BUILD
+  test_coalesce_holds_back_and_catches_up();
+  test_drop_graphs_policy_keeps_topics();
+  test_refused_topic_frame_is_resent_as_full_state();
+  test_clients_beyond_limit_are_refused();
+  test_disconnect_policy_closes_stuck_client();
+  test_connect_snapshot_only_to_new_client();
+  test_client_stats_topic();
+#endif
+  SUITE_END("WS BACKPRESSURE");
+}
+
+} // namespace WsBackpressureTest
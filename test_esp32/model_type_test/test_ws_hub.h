@@ -0,0 +1,278 @@
+#pragma once
+#include "../test_helpers.h"
+
+#include <ArduinoJson.h>
+
+#include "../../src/model/ModelBase.h"
+#include "../../src/model/ModelVar.h"
+#include "../../src/model/WsHub.h"
+#include "../../src/model/types/ModelTypePrimitive.h"
+
+namespace WsHubTest {
+
+class TestModelBase : public ModelBase {
+public:
+  using ModelBase::ModelBase;
+  using ModelBase::registerTopic;
+};
+
+struct CounterTopic {
+  fj::VarWsPrefsRw<int> counter;
+
+  typedef fj::Schema<CounterTopic, fj::Field<CounterTopic, decltype(counter)>> SchemaType;
+
+  static const SchemaType& schema() {
+    static const SchemaType s = fj::makeSchema<CounterTopic>(
+        fj::Field<CounterTopic, decltype(counter)>{"counter", &CounterTopic::counter});
+    return s;
+  }
+};
+
+void test_add_rules() {
+  TEST_START("WsHub add() rules");
+
+  WsHub hub("/hub");
+  TestModelBase admin(80, "/ws");
+  TestModelBase user(80, "/ws2", "model2");
+  TestModelBase other(80, "/ws3", "model3");
+
+  CUSTOM_ASSERT(hub.add(admin, nullptr), "Default model should be added");
+  CUSTOM_ASSERT(hub.add(user, "user"), "Namespaced model should be added");
+  CUSTOM_ASSERT(!hub.add(other, nullptr), "Second default model should be rejected");
+  CUSTOM_ASSERT(!hub.add(other, "user"), "Taken namespace should be rejected");
+  CUSTOM_ASSERT(!hub.add(other, ""), "Empty namespace should be rejected");
+  CUSTOM_ASSERT(!hub.add(user, "again"), "Model already on a hub should be rejected");
+  CUSTOM_ASSERT(hub.modelCount() == 2, "Rejected models should not be counted");
+
+  CUSTOM_ASSERT(strcmp(user.wsPath(), "/hub") == 0, "Model on a hub reports the hub path");
+  CUSTOM_ASSERT(strcmp(other.wsPath(), "/ws3") == 0, "Model on its own socket keeps its path");
+  CUSTOM_ASSERT(user.onHub() && !other.onHub(), "onHub() should reflect add()");
+  CUSTOM_ASSERT(admin.wsNamespace() == nullptr && strcmp(user.wsNamespace(), "user") == 0,
+                "wsNamespace() should be the namespace passed to add()");
+
+  TEST_END();
+}
+
+#ifdef NATIVE_BUILD
+// Host only: the stub socket records frames per client and lets tests inject messages.
+
+void test_snapshot_per_namespace() {
+  TEST_START("WsHub sends every model's snapshot on one connection");
+
+  WsHub hub("/ws");
+  TestModelBase admin(80, "/ws");
+  TestModelBase user(80, "/ws2", "model2");
+  CounterTopic a;
+  CounterTopic u;
+  a.counter = 1;
+  u.counter = 2;
+  admin.registerTopic("cfg", a, false, true);
+  user.registerTopic("cfg", u, false, true);
+  hub.add(admin, nullptr);
+  hub.add(user, "user");
+
+  AsyncWebSocketClient* c = hub.socket()._connect();
+  admin.loop();
+  user.loop();
+  CUSTOM_ASSERT(c->_sent.size() == 2, "Client should receive one snapshot per model");
+  CUSTOM_ASSERT(c->_sent[0].payload == R"({"topic":"cfg","tid":0,"data":{"counter":{"value":1}}})",
+                "Default model envelope should not carry a namespace");
+  CUSTOM_ASSERT(c->_sent[1].payload == R"({"ns":"user","topic":"cfg","tid":0,"data":{"counter":{"value":2}}})",
+                "Namespaced envelope should carry ns");
+
+  u.counter = 3;
+  CUSTOM_ASSERT(user.broadcastChanges("cfg"), "Patch broadcast should succeed");
+  CUSTOM_ASSERT(c->_sent.back().payload == R"({"ns":"user","topic":"cfg","tid":0,"patch":{"counter":{"value":3}}})",
+                "Patch envelope should carry ns");
+
+  TEST_END();
+}
+
+void test_routing_by_namespace() {
+  TEST_START("WsHub routes incoming updates by ns");
+
+  WsHub hub("/ws");
+  TestModelBase admin(80, "/ws");
+  TestModelBase user(80, "/ws2", "model2");
+  CounterTopic a;
+  CounterTopic u;
+  admin.registerTopic("cfg", a, false, false);
+  user.registerTopic("cfg", u, false, false);
+  hub.add(admin, nullptr);
+  hub.add(user, "user");
+
+  AsyncWebSocket& ws = hub.socket();
+  AsyncWebSocketClient* c = ws._connect();
+
+  ws._receive(c, R"({"ns":"user","topic":"cfg","data":{"counter":5}})");
+  CUSTOM_ASSERT(u.counter.get() == 5 && a.counter.get() == 0, "ns should select the user model");
+  ws._receive(c, R"({"topic":"cfg","data":{"counter":7}})");
+  CUSTOM_ASSERT(a.counter.get() == 7 && u.counter.get() == 5, "No ns should select the default model");
+  ws._receive(c, R"({"tid":0,"data":{"counter":9},"ns":"user"})");
+  CUSTOM_ASSERT(u.counter.get() == 9, "ns after the data member should route as well");
+
+  c->_sent.clear();
+  ws._receive(c, R"({"ns":"nope","topic":"cfg","data":{"counter":1}})");
+  CUSTOM_ASSERT(c->_sent.size() == 1 && c->_sent[0].payload == R"({"ok":false,"error":"unknown_ns"})",
+                "Unknown ns should be rejected");
+  CUSTOM_ASSERT(hub.stats().unknownNs == 1 && hub.stats().routed == 3, "Routing should be counted");
+
+  TEST_END();
+}
+
+static size_t countFrames(AsyncWebSocketClient* c, const char* needle) {
+  size_t n = 0;
+  for (size_t i = 0; i < c->_sent.size(); ++i) {
+    if (c->_sent[i].payload.find(needle) != std::string::npos) n++;
+  }
+  return n;
+}
+
+void test_clients_pick_their_namespaces() {
+  TEST_START("WsHub serves each client only the models it subscribed to");
+
+  WsHub hub("/ws");
+  TestModelBase admin(80, "/ws");
+  TestModelBase user(80, "/ws", "model2");
+  CounterTopic a;
+  CounterTopic u;
+  admin.registerTopic("cfg", a, false, true);
+  user.registerTopic("cfg", u, false, true);
+  hub.add(admin, nullptr);
+  hub.add(user, "user");
+
+  AsyncWebSocket& ws = hub.socket();
+  AsyncWebServerRequest userPage("/ws");
+  userPage._addParam("ns", "user");
+  AsyncWebServerRequest adminPage("/ws");
+  adminPage._addParam("ns", "");
+  AsyncWebSocketClient* uc = ws._connect(&userPage);
+  AsyncWebSocketClient* ac = ws._connect(&adminPage);
+  AsyncWebSocketClient* both = ws._connect();
+  admin.loop();
+  user.loop();
+
+  CUSTOM_ASSERT(uc->_sent.size() == 1 && countFrames(uc, "\"ns\":\"user\"") == 1, "?ns=user gets the user model only");
+  CUSTOM_ASSERT(ac->_sent.size() == 1 && countFrames(ac, "\"ns\"") == 0, "?ns= gets the default model only");
+  CUSTOM_ASSERT(both->_sent.size() == 2, "Without ?ns= a client gets every model");
+  CUSTOM_ASSERT(admin.clientStats(0).active && admin.clientStats(1).active && !admin.clientStats(2).active,
+                "The admin model tracks its two clients only");
+
+  a.counter = 4;
+  admin.broadcastTopic("cfg");
+  CUSTOM_ASSERT(uc->_sent.size() == 1, "Admin broadcasts skip the user client");
+  CUSTOM_ASSERT(ac->_sent.size() == 2 && both->_sent.size() == 3, "Admin broadcasts reach admin clients");
+
+  ws._receive(uc, R"({"topic":"cfg","data":{"counter":9}})");
+  CUSTOM_ASSERT(uc->_sent.back().payload == R"({"ok":false,"error":"not_subscribed"})" && a.counter.get() == 4,
+                "Updates for a model the client did not subscribe to are rejected");
+  CUSTOM_ASSERT(hub.stats().unsubscribed == 1, "Rejection should be counted");
+
+  ws._receive(uc, R"({"action":"subscribe","ns":",user"})");
+  CUSTOM_ASSERT(uc->_sent.back().payload == R"({"ok":true})", "Subscription should be acknowledged");
+  admin.loop();
+  CUSTOM_ASSERT(uc->_sent.back().payload == R"({"topic":"cfg","tid":0,"data":{"counter":{"value":4}}})",
+                "A newly subscribed model sends its snapshot");
+
+  ws._receive(uc, R"({"action":"subscribe","ns":""})");
+  const size_t before = uc->_sent.size();
+  u.counter = 5;
+  user.broadcastTopic("cfg");
+  CUSTOM_ASSERT(uc->_sent.size() == before, "Unsubscribed models stop sending");
+  CUSTOM_ASSERT(!user.clientStats(0).active, "and release the client's slot");
+
+  TEST_END();
+}
+
+void test_chunked_message() {
+  TEST_START("WsHub reassembles a frame split over several chunks");
+
+  WsHub hub("/ws");
+  TestModelBase user(80, "/ws2", "model2");
+  CounterTopic u;
+  user.registerTopic("cfg", u, false, false);
+  hub.add(user, "user");
+
+  AsyncWebSocket& ws = hub.socket();
+  AsyncWebSocketClient* c = ws._connect();
+  const char* msg = R"({"ns":"user","topic":"cfg","data":{"counter":11}})";
+  const size_t len = strlen(msg);
+  ws._receiveChunk(c, msg, 10, 0, len);
+  CUSTOM_ASSERT(u.counter.get() == 0, "Partial message should not be applied");
+  ws._receiveChunk(c, msg + 10, len - 10, 10, len);
+  CUSTOM_ASSERT(u.counter.get() == 11, "Reassembled message should be applied");
+  CUSTOM_ASSERT(hub.stats().reassembled == 1, "Reassembly should be counted");
+
+  // A chunk out of order drops the message.
+  ws._receiveChunk(c, msg, 10, 0, len);
+  ws._receiveChunk(c, msg + 20, len - 20, 20, len);
+  CUSTOM_ASSERT(hub.stats().reassembled == 1, "Gap should not complete a message");
+
+  TEST_END();
+}
+
+void test_graph_ids_per_model() {
+  TEST_START("WsHub keeps graph series ids unique across models");
+
+  WsHub hub("/ws");
+  TestModelBase admin(80, "/ws");
+  TestModelBase user(80, "/ws2", "model2");
+  hub.add(admin, nullptr);
+  hub.add(user, "user");
+
+  AsyncWebSocketClient* c = hub.socket()._connect();
+  admin.loop();
+  user.loop();
+  user.sendGraphPointXY("temp", "inside", 1000, 21.5f, true);
+  CUSTOM_ASSERT(c->_sent.size() == 2, "First point should send announcement and frame");
+
+  char expected[128];
+  snprintf(expected, sizeof(expected),
+           R"({"ns":"user","topic":"graph_series","data":{"id":%u,"graph":"temp","label":"inside"}})",
+           (unsigned)MODEL_MAX_GRAPH_SERIES);
+  CUSTOM_ASSERT(c->_sent[0].payload == expected, "Announcement should carry ns and the offset id");
+  const std::string& frame = c->_sent[1].payload;
+  const unsigned id = (uint8_t)frame[2] | ((unsigned)(uint8_t)frame[3] << 8);
+  CUSTOM_ASSERT(id == MODEL_MAX_GRAPH_SERIES, "Binary frame should use the offset id");
+
+  admin.sendGraphPointXY("temp", "inside", 1000, 20.0f, true);
+  CUSTOM_ASSERT(c->_sent[2].payload.find("\"id\":0") != std::string::npos, "Default model ids start at 0");
+
+  TEST_END();
+}
+
+void test_keepalive() {
+  TEST_START("WsHub keepalive pings and releases closed clients");
+
+  WsHub hub("/ws");
+  AsyncWebSocket& ws = hub.socket();
+  AsyncWebSocketClient* a = ws._connect();
+  (void)ws._connect();
+  a->close();
+
+  delay(MODEL_HUB_PING_MS);
+  hub.loop();
+  CUSTOM_ASSERT(hub.stats().pings == 1, "First loop after the interval should ping");
+  CUSTOM_ASSERT(ws.getClients().size() == 1, "Closed client should be released");
+  hub.loop();
+  CUSTOM_ASSERT(hub.stats().pings == 1, "No second ping within the interval");
+
+  TEST_END();
+}
+#endif
+
+void runAllTests() {
+  SUITE_START("WS HUB");
+  test_add_rules();
+#ifdef NATIVE_BUILD
+  test_snapshot_per_namespace();
+  test_routing_by_namespace();
+  test_clients_pick_their_namespaces();
+  test_chunked_message();
+  test_graph_ids_per_model();
+  test_keepalive();
+#endif
+  SUITE_END("WS HUB");
+}
+
+} // namespace WsHubTest
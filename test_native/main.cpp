@@ -0,0 +1,14 @@
+// Host-native entry point for the test firmware in test_esp32/.
+// The suites are shared 1:1 with the device build; setup() from
+// test_esp32/main.cpp runs them once and the exit code reports the result.
+
+#include <Arduino.h>
+#include "../test_esp32/test_helpers.h"
+
+void setup();
+
+int main() {
+  setup();
+  Serial.flush();
+  return globalTestStats.failed == 0 ? 0 : 1;
+}
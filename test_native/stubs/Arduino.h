@@ -0,0 +1,226 @@
+#pragma once
+
+// Minimal Arduino core stand-in for the host-native (Linux) build.
+// Only the subset used by src/model/**, AdminModel and the test suites is
+// provided. Not a general-purpose Arduino emulation.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cmath>
+#include <string>
+#include <chrono>
+#include <random>
+
+#ifndef NATIVE_BUILD
+#define NATIVE_BUILD 1
+#endif
+
+// ---------------------------------------------------------------------------
+// String (std::string backed, Arduino WString API subset)
+// ---------------------------------------------------------------------------
+class String {
+public:
+  String() {}
+  String(const char* s) : s_(s ? s : "") {}
+  String(const char* s, size_t n) : s_(s ? std::string(s, n) : std::string()) {}
+  String(const std::string& s) : s_(s) {}
+  String(char c) : s_(1, c) {}
+  explicit String(int v) : s_(std::to_string(v)) {}
+  explicit String(unsigned int v) : s_(std::to_string(v)) {}
+  explicit String(long v) : s_(std::to_string(v)) {}
+  explicit String(unsigned long v) : s_(std::to_string(v)) {}
+  explicit String(long long v) : s_(std::to_string(v)) {}
+  explicit String(unsigned long long v) : s_(std::to_string(v)) {}
+  explicit String(float v, unsigned decimals = 2) { fromDouble_((double)v, decimals); }
+  explicit String(double v, unsigned decimals = 2) { fromDouble_(v, decimals); }
+
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  bool reserve(unsigned int n) { s_.reserve(n); return true; }
+  char charAt(unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+
+  bool concat(const char* s) { if (!s) return false; s_ += s; return true; }
+  bool concat(const char* s, unsigned int n) { if (!s) return false; s_.append(s, n); return true; }
+  bool concat(const String& s) { s_ += s.s_; return true; }
+  bool concat(char c) { s_ += c; return true; }
+  bool concat(int v) { s_ += std::to_string(v); return true; }
+  bool concat(unsigned int v) { s_ += std::to_string(v); return true; }
+  bool concat(long v) { s_ += std::to_string(v); return true; }
+  bool concat(unsigned long v) { s_ += std::to_string(v); return true; }
+
+  template <typename T>
+  String& operator+=(const T& v) { concat(v); return *this; }
+
+  bool equals(const String& o) const { return s_ == o.s_; }
+  bool equals(const char* o) const { return s_ == (o ? o : ""); }
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* o) const { return equals(o); }
+  bool operator!=(const String& o) const { return s_ != o.s_; }
+  bool operator!=(const char* o) const { return !equals(o); }
+  bool operator<(const String& o) const { return s_ < o.s_; }
+
+  bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String& p) const {
+    return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const { return pos_(s_.find(c, from)); }
+  int indexOf(const char* p, unsigned int from = 0) const { return pos_(s_.find(p ? p : "", from)); }
+  int indexOf(const String& p, unsigned int from = 0) const { return pos_(s_.find(p.s_, from)); }
+  int lastIndexOf(char c) const { return pos_(s_.rfind(c)); }
+  String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (to > s_.size()) to = (unsigned int)s_.size();
+    return from < to ? String(s_.substr(from, to - from)) : String();
+  }
+  void replace(const String& find, const String& repl) {
+    if (find.s_.empty()) return;
+    size_t p = 0;
+    while ((p = s_.find(find.s_, p)) != std::string::npos) {
+      s_.replace(p, find.s_.size(), repl.s_);
+      p += repl.s_.size();
+    }
+  }
+  void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+  void trim() {
+    const char* ws = " \t\r\n";
+    size_t b = s_.find_first_not_of(ws);
+    if (b == std::string::npos) { s_.clear(); return; }
+    s_ = s_.substr(b, s_.find_last_not_of(ws) - b + 1);
+  }
+  void toLowerCase() { for (size_t i = 0; i < s_.size(); i++) s_[i] = (char)tolower((unsigned char)s_[i]); }
+  void toUpperCase() { for (size_t i = 0; i < s_.size(); i++) s_[i] = (char)toupper((unsigned char)s_[i]); }
+  long toInt() const { return strtol(s_.c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(s_.c_str(), nullptr); }
+
+  // Used by ArduinoJson's String writer/reader adapters.
+  size_t write(uint8_t c) { s_ += (char)c; return 1; }
+  size_t write(const uint8_t* b, size_t n) { s_.append((const char*)b, n); return n; }
+
+private:
+  static int pos_(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  void fromDouble_(double v, unsigned decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    s_ = buf;
+  }
+
+  std::string s_;
+};
+
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String& s) : String(s) {}
+  StringSumHelper(const char* s) : String(s) {}
+};
+
+inline StringSumHelper operator+(const String& a, const String& b) { String r(a); r.concat(b); return r; }
+inline StringSumHelper operator+(const String& a, const char* b) { String r(a); r.concat(b); return r; }
+inline StringSumHelper operator+(const char* a, const String& b) { String r(a); r.concat(b); return r; }
+inline StringSumHelper operator+(const String& a, char b) { String r(a); r.concat(b); return r; }
+inline StringSumHelper operator+(const String& a, int b) { String r(a); r.concat(b); return r; }
+inline StringSumHelper operator+(const String& a, unsigned int b) { String r(a); r.concat(b); return r; }
+inline StringSumHelper operator+(const String& a, long b) { String r(a); r.concat(b); return r; }
+inline StringSumHelper operator+(const String& a, unsigned long b) { String r(a); r.concat(b); return r; }
+inline bool operator==(const char* a, const String& b) { return b == a; }
+
+// ---------------------------------------------------------------------------
+// Serial -> stdout
+// ---------------------------------------------------------------------------
+class NativeSerial {
+public:
+  // Line-buffered so output survives an abort() in a failing host run.
+  void begin(unsigned long) { setvbuf(stdout, nullptr, _IOLBF, 0); }
+  void flush() { fflush(stdout); }
+  operator bool() const { return true; }
+
+  size_t print(const char* s) { return s ? fputs_(s) : 0; }
+  size_t print(const String& s) { return fputs_(s.c_str()); }
+  size_t print(char c) { fputc(c, stdout); return 1; }
+  size_t print(int v) { return (size_t)printf("%d", v); }
+  size_t print(unsigned int v) { return (size_t)printf("%u", v); }
+  size_t print(long v) { return (size_t)printf("%ld", v); }
+  size_t print(unsigned long v) { return (size_t)printf("%lu", v); }
+  size_t print(double v, int decimals = 2) { return (size_t)printf("%.*f", decimals, v); }
+
+  size_t println() { fputc('\n', stdout); return 1; }
+  template <typename T>
+  size_t println(const T& v) { size_t n = print(v); return n + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vfprintf(stdout, fmt, ap);
+    va_end(ap);
+    return n > 0 ? (size_t)n : 0;
+  }
+
+  size_t write(uint8_t c) { fputc(c, stdout); return 1; }
+  size_t write(const uint8_t* b, size_t n) { return fwrite(b, 1, n, stdout); }
+
+private:
+  static size_t fputs_(const char* s) { fputs(s, stdout); return strlen(s); }
+};
+
+static NativeSerial Serial;
+
+// ---------------------------------------------------------------------------
+// Time
+// ---------------------------------------------------------------------------
+// millis()/micros() follow the host monotonic clock plus a simulated offset.
+// delay() advances the offset instead of sleeping, so time-based logic
+// (Periodic, coalescing windows, ...) can be exercised without wall-clock waits.
+namespace arduino_native {
+  inline uint64_t& delayOffsetUs() {
+    static uint64_t offset = 0;
+    return offset;
+  }
+
+  inline uint64_t nowUs() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() + delayOffsetUs();
+  }
+
+  inline std::mt19937& rng() {
+    static std::mt19937 gen(0x5eed1234u);
+    return gen;
+  }
+}
+
+inline unsigned long millis() { return (unsigned long)(arduino_native::nowUs() / 1000ULL); }
+inline unsigned long micros() { return (unsigned long)arduino_native::nowUs(); }
+inline void delay(unsigned long ms) { arduino_native::delayOffsetUs() += (uint64_t)ms * 1000ULL; }
+inline void delayMicroseconds(unsigned int us) { arduino_native::delayOffsetUs() += us; }
+inline void yield() {}
+
+// ---------------------------------------------------------------------------
+// Random
+// ---------------------------------------------------------------------------
+inline uint32_t esp_random() { return (uint32_t)arduino_native::rng()(); }
+inline void randomSeed(unsigned long seed) { arduino_native::rng().seed((uint32_t)seed); }
+inline long random(long howbig) { return howbig <= 0 ? 0 : (long)(esp_random() % (uint32_t)howbig); }
+inline long random(long howsmall, long howbig) {
+  return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+// ---------------------------------------------------------------------------
+// Misc
+// ---------------------------------------------------------------------------
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+#ifndef ESP_FAIL
+#define ESP_FAIL -1
+#endif
@@ -0,0 +1,408 @@
+#pragma once
+
+// Host stand-in for ESP32Async/ESPAsyncWebServer (3.x API subset).
+// There is no network: AsyncWebSocket keeps an in-process client list and
+// every frame sent to a client is recorded in AsyncWebSocketClient::_sent so
+// host tests can inspect what would have gone over the wire. Helpers prefixed
+// with '_' only exist in this stub (connect/disconnect/receive simulation).
+
+#include <Arduino.h>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef WS_MAX_QUEUED_MESSAGES
+#define WS_MAX_QUEUED_MESSAGES 32
+#endif
+
+#ifndef DEFAULT_MAX_WS_CLIENTS
+#define DEFAULT_MAX_WS_CLIENTS 8
+#endif
+
+class AsyncWebSocket;
+class AsyncWebSocketClient;
+
+// ---------------------------------------------------------------------------
+// HTTP
+// ---------------------------------------------------------------------------
+typedef enum {
+  HTTP_GET = 0b00000001,
+  HTTP_POST = 0b00000010,
+  HTTP_DELETE = 0b00000100,
+  HTTP_PUT = 0b00001000,
+  HTTP_PATCH = 0b00010000,
+  HTTP_HEAD = 0b00100000,
+  HTTP_OPTIONS = 0b01000000,
+  HTTP_ANY = 0b01111111,
+} WebRequestMethod;
+
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String& name, const String& value) : name_(name), value_(value) {}
+  const String& name() const { return name_; }
+  const String& value() const { return value_; }
+
+private:
+  String name_;
+  String value_;
+};
+
+class AsyncWebServerRequest {
+public:
+  explicit AsyncWebServerRequest(const String& url, WebRequestMethodComposite method = HTTP_GET)
+    : url_(url), method_(method) {}
+
+  const String& url() const { return url_; }
+  WebRequestMethodComposite method() const { return method_; }
+
+  void send(int code) { send(code, "text/plain", String()); }
+  void send(int code, const char* contentType, const String& content) {
+    _status = code;
+    _contentType = contentType ? contentType : "";
+    _body = content;
+  }
+  void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+  void send(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+  void redirect(const char* url) { _status = 302; _body = url; }
+
+  // Query parameters (the stub has no parser: tests add them with _addParam()).
+  bool hasParam(const char* name) const { return getParam(name) != nullptr; }
+  const AsyncWebParameter* getParam(const char* name) const {
+    for (size_t i = 0; i < params_.size(); ++i) {
+      if (params_[i].name() == name) return &params_[i];
+    }
+    return nullptr;
+  }
+  void _addParam(const char* name, const char* value) { params_.push_back(AsyncWebParameter(name, value)); }
+
+  // Recorded response (stub only).
+  int _status = 0;
+  String _contentType;
+  String _body;
+
+private:
+  String url_;
+  WebRequestMethodComposite method_;
+  std::vector<AsyncWebParameter> params_;
+};
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+
+class AsyncWebHandler {
+public:
+  virtual ~AsyncWebHandler() {}
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+  String uri;
+  WebRequestMethodComposite method = HTTP_ANY;
+  ArRequestHandlerFunction fn;
+};
+
+class AsyncWebServer {
+public:
+  explicit AsyncWebServer(uint16_t port) : port_(port) {}
+
+  void begin() { running_ = true; }
+  void end() { running_ = false; }
+  uint16_t _port() const { return port_; }
+
+  AsyncWebHandler& addHandler(AsyncWebHandler* handler) {
+    handlers_.push_back(handler);
+    return *handler;
+  }
+  bool removeHandler(AsyncWebHandler* handler) {
+    for (size_t i = 0; i < handlers_.size(); ++i) {
+      if (handlers_[i] != handler) continue;
+      handlers_.erase(handlers_.begin() + (long)i);
+      return true;
+    }
+    return false;
+  }
+
+  AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction fn) {
+    routes_.push_back(std::unique_ptr<AsyncCallbackWebHandler>(new AsyncCallbackWebHandler()));
+    AsyncCallbackWebHandler& h = *routes_.back();
+    h.uri = uri ? uri : "";
+    h.method = method;
+    h.fn = fn;
+    return h;
+  }
+
+  void onNotFound(ArRequestHandlerFunction fn) { notFound_ = fn; }
+
+  // Dispatch a request to the first matching route (stub only).
+  bool _handle(AsyncWebServerRequest& req) {
+    for (size_t i = 0; i < routes_.size(); ++i) {
+      AsyncCallbackWebHandler& h = *routes_[i];
+      if (h.uri == req.url() && (h.method & req.method())) {
+        if (h.fn) h.fn(&req);
+        return true;
+      }
+    }
+    if (notFound_) notFound_(&req);
+    return false;
+  }
+
+  const std::vector<AsyncWebHandler*>& _handlers() const { return handlers_; }
+
+private:
+  uint16_t port_;
+  bool running_ = false;
+  std::vector<AsyncWebHandler*> handlers_;
+  std::vector<std::unique_ptr<AsyncCallbackWebHandler>> routes_;
+  ArRequestHandlerFunction notFound_;
+};
+
+// ---------------------------------------------------------------------------
+// WebSocket
+// ---------------------------------------------------------------------------
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PING, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+typedef enum { WS_DISCONNECTED, WS_CONNECTED, WS_DISCONNECTING } AwsClientStatus;
+typedef enum {
+  WS_CONTINUATION = 0,
+  WS_TEXT = 1,
+  WS_BINARY = 2,
+  WS_DISCONNECT = 8,
+  WS_PING = 9,
+  WS_PONG = 10,
+} AwsFrameType;
+
+typedef struct {
+  uint8_t message_opcode;
+  uint32_t num;
+  uint8_t final;
+  uint8_t masked;
+  uint8_t opcode;
+  uint64_t len;
+  uint8_t mask[4];
+  uint64_t index;
+} AwsFrameInfo;
+
+typedef std::shared_ptr<std::vector<uint8_t>> AsyncWebSocketSharedBuffer;
+
+class AsyncWebSocketMessageBuffer {
+public:
+  explicit AsyncWebSocketMessageBuffer(size_t size) : buffer_(std::make_shared<std::vector<uint8_t>>(size)) {}
+  AsyncWebSocketMessageBuffer(const uint8_t* data, size_t size)
+    : buffer_(std::make_shared<std::vector<uint8_t>>(data, data + size)) {}
+
+  uint8_t* get() { return buffer_->data(); }
+  size_t length() const { return buffer_->size(); }
+  bool reserve(size_t size) { buffer_->resize(size); return true; }
+
+private:
+  friend class AsyncWebSocket;
+  friend class AsyncWebSocketClient;
+  AsyncWebSocketSharedBuffer buffer_;
+};
+
+class AsyncWebSocketClient {
+public:
+  struct Frame {
+    uint8_t opcode;
+    std::string payload;
+  };
+
+  AsyncWebSocketClient(AsyncWebSocket* server, uint32_t id) : server_(server), id_(id) {}
+
+  uint32_t id() const { return id_; }
+  AwsClientStatus status() const { return status_; }
+  AsyncWebSocket* server() { return server_; }
+
+  size_t queueLen() const { return _queued; }
+  bool queueIsFull() const { return _queued >= _queueCapacity || status_ != WS_CONNECTED; }
+  bool canSend() const { return _queued < _queueCapacity; }
+
+  void close(uint16_t code = 0, const char* message = nullptr) {
+    (void)code;
+    (void)message;
+    status_ = WS_DISCONNECTING;
+  }
+  bool ping(const uint8_t* data = nullptr, size_t len = 0) { (void)data; (void)len; return status_ == WS_CONNECTED; }
+  void keepAlivePeriod(uint16_t seconds) { keepAlive_ = seconds; }
+  uint16_t keepAlivePeriod() const { return keepAlive_; }
+
+  bool text(const char* message, size_t len) { return push_(WS_TEXT, (const uint8_t*)message, len); }
+  bool text(const char* message) { return message ? text(message, strlen(message)) : false; }
+  bool text(const String& message) { return text(message.c_str(), message.length()); }
+  bool text(const uint8_t* message, size_t len) { return push_(WS_TEXT, message, len); }
+  bool text(AsyncWebSocketMessageBuffer* buffer) { return sendBuffer_(WS_TEXT, buffer); }
+  bool text(AsyncWebSocketSharedBuffer buffer) { return buffer ? push_(WS_TEXT, buffer->data(), buffer->size()) : false; }
+
+  bool binary(const uint8_t* message, size_t len) { return push_(WS_BINARY, message, len); }
+  bool binary(const char* message, size_t len) { return push_(WS_BINARY, (const uint8_t*)message, len); }
+  bool binary(const String& message) { return binary(message.c_str(), message.length()); }
+  bool binary(AsyncWebSocketMessageBuffer* buffer) { return sendBuffer_(WS_BINARY, buffer); }
+  bool binary(AsyncWebSocketSharedBuffer buffer) { return buffer ? push_(WS_BINARY, buffer->data(), buffer->size()) : false; }
+
+  // --- stub only -----------------------------------------------------------
+  // Frames "sent" to this client, in order.
+  std::vector<Frame> _sent;
+  // Frames still queued. 0 unless the test caps the queue to emulate a slow peer.
+  size_t _queued = 0;
+  size_t _queueCapacity = WS_MAX_QUEUED_MESSAGES;
+  // When false, frames stay queued until _drain() (slow consumer emulation).
+  bool _autoDrain = true;
+
+  void _drain() { _queued = 0; }
+  void _setStatus(AwsClientStatus s) { status_ = s; }
+
+private:
+  bool push_(uint8_t opcode, const uint8_t* data, size_t len) {
+    if (status_ != WS_CONNECTED) return false;
+    if (_queued >= _queueCapacity) return false;
+    Frame f;
+    f.opcode = opcode;
+    f.payload.assign((const char*)data, len);
+    _sent.push_back(f);
+    if (!_autoDrain) _queued++;
+    return true;
+  }
+
+  bool sendBuffer_(uint8_t opcode, AsyncWebSocketMessageBuffer* buffer) {
+    if (!buffer) return false;
+    const bool ok = push_(opcode, buffer->get(), buffer->length());
+    delete buffer;
+    return ok;
+  }
+
+  AsyncWebSocket* server_;
+  uint32_t id_;
+  AwsClientStatus status_ = WS_CONNECTED;
+  uint16_t keepAlive_ = 0;
+};
+
+typedef std::function<void(AsyncWebSocket*, AsyncWebSocketClient*, AwsEventType, void*, uint8_t*, size_t)> AwsEventHandler;
+
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+  explicit AsyncWebSocket(const char* url) : url_(url ? url : "") {}
+  explicit AsyncWebSocket(const String& url) : url_(url) {}
+
+  const char* url() const { return url_.c_str(); }
+  void onEvent(AwsEventHandler handler) { handler_ = handler; }
+  bool enabled() const { return true; }
+
+  size_t count() const {
+    size_t n = 0;
+    for (const AsyncWebSocketClient& c : clients_) {
+      if (c.status() == WS_CONNECTED) n++;
+    }
+    return n;
+  }
+
+  std::list<AsyncWebSocketClient>& getClients() { return clients_; }
+
+  AsyncWebSocketClient* client(uint32_t id) {
+    for (AsyncWebSocketClient& c : clients_) {
+      if (c.id() == id && c.status() == WS_CONNECTED) return &c;
+    }
+    return nullptr;
+  }
+  bool hasClient(uint32_t id) { return client(id) != nullptr; }
+
+  void cleanupClients(uint16_t maxClients = DEFAULT_MAX_WS_CLIENTS) {
+    clients_.remove_if([](const AsyncWebSocketClient& c) { return c.status() != WS_CONNECTED; });
+    while (count() > maxClients) clients_.front().close();
+    clients_.remove_if([](const AsyncWebSocketClient& c) { return c.status() != WS_CONNECTED; });
+  }
+
+  void pingAll(const uint8_t* data = nullptr, size_t len = 0) {
+    for (AsyncWebSocketClient& c : clients_) c.ping(data, len);
+  }
+  void closeAll(uint16_t code = 0, const char* message = nullptr) {
+    for (AsyncWebSocketClient& c : clients_) c.close(code, message);
+  }
+
+  AsyncWebSocketMessageBuffer* makeBuffer(size_t size = 0) { return new AsyncWebSocketMessageBuffer(size); }
+  AsyncWebSocketMessageBuffer* makeBuffer(const uint8_t* data, size_t size) {
+    return new AsyncWebSocketMessageBuffer(data, size);
+  }
+
+  void text(uint32_t id, const char* message, size_t len) {
+    AsyncWebSocketClient* c = client(id);
+    if (c) c->text(message, len);
+  }
+
+  void textAll(const char* message, size_t len) {
+    for (AsyncWebSocketClient& c : clients_) c.text(message, len);
+  }
+  void textAll(const char* message) { if (message) textAll(message, strlen(message)); }
+  void textAll(const String& message) { textAll(message.c_str(), message.length()); }
+  void textAll(AsyncWebSocketMessageBuffer* buffer) {
+    if (!buffer) return;
+    textAll((const char*)buffer->get(), buffer->length());
+    delete buffer;
+  }
+  void textAll(AsyncWebSocketSharedBuffer buffer) {
+    if (buffer) textAll((const char*)buffer->data(), buffer->size());
+  }
+
+  void binaryAll(const uint8_t* message, size_t len) {
+    for (AsyncWebSocketClient& c : clients_) c.binary(message, len);
+  }
+  void binaryAll(const char* message, size_t len) { binaryAll((const uint8_t*)message, len); }
+  void binaryAll(AsyncWebSocketMessageBuffer* buffer) {
+    if (!buffer) return;
+    binaryAll(buffer->get(), buffer->length());
+    delete buffer;
+  }
+  void binaryAll(AsyncWebSocketSharedBuffer buffer) {
+    if (buffer) binaryAll(buffer->data(), buffer->size());
+  }
+
+  // --- stub only -----------------------------------------------------------
+  // autoDrain = false: the client is slow from the first frame on (see AsyncWebSocketClient::_autoDrain).
+  AsyncWebSocketClient* _connect(bool autoDrain = true) { return _connect(nullptr, autoDrain); }
+
+  // Like the real server, WS_EVT_CONNECT carries the upgrade request (query parameters) as arg.
+  AsyncWebSocketClient* _connect(AsyncWebServerRequest* request, bool autoDrain = true) {
+    clients_.push_back(AsyncWebSocketClient(this, nextId_++));
+    AsyncWebSocketClient* c = &clients_.back();
+    c->_autoDrain = autoDrain;
+    if (handler_) handler_(this, c, WS_EVT_CONNECT, request, nullptr, 0);
+    return c;
+  }
+
+  void _disconnect(AsyncWebSocketClient* c) {
+    if (!c) return;
+    c->_setStatus(WS_DISCONNECTED);
+    if (handler_) handler_(this, c, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+  }
+
+  void _receive(AsyncWebSocketClient* c, const char* msg, size_t len, uint8_t opcode = WS_TEXT) {
+    AwsFrameInfo info;
+    memset(&info, 0, sizeof(info));
+    info.message_opcode = opcode;
+    info.opcode = opcode;
+    info.final = 1;
+    info.len = len;
+    info.index = 0;
+    if (handler_) handler_(this, c, WS_EVT_DATA, &info, (uint8_t*)msg, len);
+  }
+  void _receive(AsyncWebSocketClient* c, const char* msg) { _receive(c, msg, strlen(msg)); }
+
+  // One chunk of a single text frame of `total` bytes that arrives in several TCP segments.
+  void _receiveChunk(AsyncWebSocketClient* c, const char* chunk, size_t len, uint64_t index, uint64_t total) {
+    AwsFrameInfo info;
+    memset(&info, 0, sizeof(info));
+    info.message_opcode = WS_TEXT;
+    info.opcode = WS_TEXT;
+    info.final = 1;
+    info.len = total;
+    info.index = index;
+    if (handler_) handler_(this, c, WS_EVT_DATA, &info, (uint8_t*)chunk, len);
+  }
+
+private:
+  String url_;
+  AwsEventHandler handler_;
+  std::list<AsyncWebSocketClient> clients_;
+  uint32_t nextId_ = 1;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+// In-memory stand-in for the arduino-esp32 Preferences (NVS) API.
+// All instances opened on the same namespace share one store, like NVS.
+// nvs_flash_erase() (see nvs_flash.h) wipes every namespace.
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef enum {
+  PT_I8, PT_U8, PT_I16, PT_U16, PT_I32, PT_U32, PT_I64, PT_U64, PT_STR, PT_BLOB, PT_INVALID
+} PreferenceType;
+
+namespace arduino_native {
+  struct PrefsValue {
+    PreferenceType type;
+    std::vector<uint8_t> bytes;
+  };
+
+  typedef std::map<std::string, PrefsValue> PrefsNamespace;
+
+  inline std::map<std::string, PrefsNamespace>& prefsStore() {
+    static std::map<std::string, PrefsNamespace> store;
+    return store;
+  }
+
+  // Write counters, handy to observe flash wear in host tests.
+  struct PrefsCounters {
+    uint32_t writes = 0;
+    uint32_t removes = 0;
+  };
+
+  inline PrefsCounters& prefsCounters() {
+    static PrefsCounters counters;
+    return counters;
+  }
+}
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false, const char* partition_label = nullptr) {
+    (void)partition_label;
+    if (!name || !*name || strlen(name) > 15) return false;
+    ns_ = &arduino_native::prefsStore()[name];
+    readOnly_ = readOnly;
+    return true;
+  }
+
+  void end() { ns_ = nullptr; }
+
+  bool clear() {
+    if (!writable_()) return false;
+    ns_->clear();
+    return true;
+  }
+
+  bool remove(const char* key) {
+    if (!writable_() || !key) return false;
+    arduino_native::prefsCounters().removes++;
+    return ns_->erase(key) > 0;
+  }
+
+  bool isKey(const char* key) {
+    return ns_ && key && ns_->find(key) != ns_->end();
+  }
+
+  PreferenceType getType(const char* key) {
+    const arduino_native::PrefsValue* v = find_(key);
+    return v ? v->type : PT_INVALID;
+  }
+
+  size_t freeEntries() { return 1000; }
+
+  size_t putString(const char* key, const char* value) {
+    if (!value) return 0;
+    // NVS stores the terminator; the return value excludes it (like arduino-esp32).
+    if (!put_(key, PT_STR, value, strlen(value) + 1)) return 0;
+    return strlen(value);
+  }
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+
+  String getString(const char* key, const String defaultValue = String()) {
+    const arduino_native::PrefsValue* v = find_(key);
+    if (!v || v->type != PT_STR) return defaultValue;
+    return String((const char*)v->bytes.data());
+  }
+
+  size_t getString(const char* key, char* value, size_t maxLen) {
+    const arduino_native::PrefsValue* v = find_(key);
+    if (!v || v->type != PT_STR || !value || v->bytes.size() > maxLen) return 0;
+    memcpy(value, v->bytes.data(), v->bytes.size());
+    return v->bytes.size();
+  }
+
+  size_t putBytes(const char* key, const void* value, size_t len) {
+    if (!value || !len) return 0;
+    return put_(key, PT_BLOB, value, len) ? len : 0;
+  }
+
+  size_t getBytesLength(const char* key) {
+    const arduino_native::PrefsValue* v = find_(key);
+    return (v && v->type == PT_BLOB) ? v->bytes.size() : 0;
+  }
+
+  size_t getBytes(const char* key, void* buf, size_t maxLen) {
+    const arduino_native::PrefsValue* v = find_(key);
+    if (!v || v->type != PT_BLOB || !buf || v->bytes.size() > maxLen) return 0;
+    memcpy(buf, v->bytes.data(), v->bytes.size());
+    return v->bytes.size();
+  }
+
+  size_t putUInt(const char* key, uint32_t value) { return put_(key, PT_U32, &value, sizeof(value)) ? 4 : 0; }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getPod_(key, PT_U32, defaultValue); }
+  size_t putInt(const char* key, int32_t value) { return put_(key, PT_I32, &value, sizeof(value)) ? 4 : 0; }
+  int32_t getInt(const char* key, int32_t defaultValue = 0) { return getPod_(key, PT_I32, defaultValue); }
+  size_t putBool(const char* key, bool value) { uint8_t b = value ? 1 : 0; return put_(key, PT_U8, &b, 1) ? 1 : 0; }
+  bool getBool(const char* key, bool defaultValue = false) { return getPod_<uint8_t>(key, PT_U8, defaultValue ? 1 : 0) != 0; }
+
+private:
+  bool writable_() const { return ns_ && !readOnly_; }
+
+  const arduino_native::PrefsValue* find_(const char* key) const {
+    if (!ns_ || !key) return nullptr;
+    arduino_native::PrefsNamespace::const_iterator it = ns_->find(key);
+    return it == ns_->end() ? nullptr : &it->second;
+  }
+
+  bool put_(const char* key, PreferenceType type, const void* data, size_t len) {
+    // NVS keys are limited to 15 characters.
+    if (!writable_() || !key || !*key || strlen(key) > 15) return false;
+    arduino_native::PrefsValue& v = (*ns_)[key];
+    v.type = type;
+    v.bytes.assign((const uint8_t*)data, (const uint8_t*)data + len);
+    arduino_native::prefsCounters().writes++;
+    return true;
+  }
+
+  template <typename T>
+  T getPod_(const char* key, PreferenceType type, T defaultValue) const {
+    const arduino_native::PrefsValue* v = find_(key);
+    if (!v || v->type != type || v->bytes.size() != sizeof(T)) return defaultValue;
+    T out;
+    memcpy(&out, v->bytes.data(), sizeof(T));
+    return out;
+  }
+
+  arduino_native::PrefsNamespace* ns_ = nullptr;
+  bool readOnly_ = false;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+// Host stand-in for ESP-IDF nvs_flash: operates on the in-memory Preferences store.
+
+#include <Preferences.h>
+
+inline esp_err_t nvs_flash_init() { return ESP_OK; }
+
+inline esp_err_t nvs_flash_erase() {
+  // Keep the namespace nodes alive: open Preferences handles point into them.
+  for (auto& ns : arduino_native::prefsStore()) ns.second.clear();
+  return ESP_OK;
+}
@@ -46,6 +46,7 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
 (function () {
   const topicState = {};
   let ws = null;
+  let wsNamespace = ''; // model namespace on a shared WsHub socket ('' = default model)
   let wsDebugEnabled = false;
   let graphMode = 'inline'; // 'inline' (default) or 'global'
 
@@ -54,6 +55,8 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
   const fieldElements = {}; // { "topic\u0000field": element } - cache for stable DOM updates
 
   const graphCharts = {}; // { graph_name: { chart, datasets: { label: dataset }, maxCount } }
+  const graphSeries = {}; // { id: { graph, label } } from "graph_series" announcements (binary graph frames)
+  const topicIds = {}; // { topic: tid } from envelopes; updates address topics by id once known
   const sharedGraphs = new Set(); // Set of graph names used in multiple fields
   
   function updateSharedGraphs() {
@@ -547,7 +550,8 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
       toast('WebSocket nicht verbunden', 'red');
       return;
     }
-    const msg = { topic, data };
+    const msg = topic in topicIds ? { tid: topicIds[topic], data } : { topic, data };
+    if (wsNamespace) msg.ns = wsNamespace;
     const payload = JSON.stringify(msg);
     logWsLine(payload, 'out');
     ws.send(payload);
@@ -560,6 +564,7 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
       return;
     }
     const msg = { action: 'button_trigger', topic, button };
+    if (wsNamespace) msg.ns = wsNamespace;
     const payload = JSON.stringify(msg);
     logWsLine(payload, 'out');
     ws.send(payload);
@@ -589,12 +594,125 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
     debugLog.scrollTop = debugLog.scrollHeight;
   }
 
+  // Live device log (LogStream): pages with a #deviceLog element subscribe on connect and get
+  // {"topic":"log","data":{"seq","skipped","more","lines":[[level, ms, text],..]}} batches.
+  const LOG_LEVEL_NAMES = ['TRACE', 'DEBUG', 'INFO', 'WARN', 'ERROR'];
+  const DEVICE_LOG_MAX_LINES = 500;
+  let deviceLogBacklog = true; // full history on the first subscription of a connection
+
+  function subscribeDeviceLog() {
+    if (!byId('deviceLog') || !ws || ws.readyState !== WebSocket.OPEN) return;
+    const levelEl = byId('deviceLogLevel');
+    const level = levelEl ? parseInt(levelEl.value, 10) : 2;
+    const msg = { action: 'log_subscribe', level: isNaN(level) ? 2 : level, backlog: deviceLogBacklog };
+    if (deviceLogBacklog) byId('deviceLog').textContent = ''; // the history replaces what is shown
+    deviceLogBacklog = false;
+    const payload = JSON.stringify(msg);
+    logWsLine(payload, 'out');
+    ws.send(payload);
+  }
+
+  function handleDeviceLog(data) {
+    const el = byId('deviceLog');
+    if (!el || !data || !Array.isArray(data.lines)) return;
+    const atBottom = el.scrollTop + el.clientHeight >= el.scrollHeight - 4;
+    const frag = document.createDocumentFragment();
+    if (data.skipped > 0) {
+      const gap = document.createElement('div');
+      gap.className = 'log-gap';
+      gap.textContent = `… ${data.skipped} Zeilen verpasst`;
+      frag.appendChild(gap);
+    }
+    for (const line of data.lines) {
+      const level = line[0];
+      const row = document.createElement('div');
+      row.className = `log-line log-${(LOG_LEVEL_NAMES[level] || 'NONE').toLowerCase()}`;
+      const seconds = (line[1] / 1000).toFixed(3);
+      row.textContent = `${seconds.padStart(10)} ${(LOG_LEVEL_NAMES[level] || '?').padEnd(5)} ${line[2]}`;
+      frag.appendChild(row);
+    }
+    el.appendChild(frag);
+    while (el.childElementCount > DEVICE_LOG_MAX_LINES) el.removeChild(el.firstChild);
+    if (atBottom) el.scrollTop = el.scrollHeight;
+  }
+
+  function setupDeviceLog() {
+    const levelEl = byId('deviceLogLevel');
+    if (levelEl) levelEl.addEventListener('change', subscribeDeviceLog);
+    const clearEl = byId('deviceLogClear');
+    if (clearEl) {
+      clearEl.addEventListener('click', () => {
+        const el = byId('deviceLog');
+        if (el) el.textContent = '';
+      });
+    }
+  }
+
+  // Binary graph frames (little endian), see ModelBase::GRAPH_FRAME_V1 / GRAPH_BATCH_V1:
+  //   single: u8 0x47, u8 flags (bit0 = synced), u16 series id, u64 x, f32 y
+  //   batch:  u8 0x42, u8 flags, u16 series id, u16 count, u16 0, count x (u64 x, f32 y)
+  const GRAPH_FRAME_V1 = 0x47;
+  const GRAPH_FRAME_SIZE = 16;
+  const GRAPH_BATCH_V1 = 0x42;
+  const GRAPH_BATCH_HEADER = 8;
+  const GRAPH_BATCH_POINT = 12;
+
+  function readU64(view, offset) {
+    return view.getUint32(offset + 4, true) * 4294967296 + view.getUint32(offset, true);
+  }
+
+  function handleWsMessageBinary(buf) {
+    const view = new DataView(buf);
+    const version = view.byteLength > 0 ? view.getUint8(0) : -1;
+    const isPoint = version === GRAPH_FRAME_V1 && view.byteLength >= GRAPH_FRAME_SIZE;
+    const isBatch = version === GRAPH_BATCH_V1 && view.byteLength >= GRAPH_BATCH_HEADER;
+    if (!isPoint && !isBatch) {
+      logWsLine(`<binary ${view.byteLength} bytes>`, 'in');
+      return;
+    }
+    const series = graphSeries[view.getUint16(2, true)];
+    if (!series) return; // announcement not seen yet
+    const synced = (view.getUint8(1) & 0x01) !== 0;
+
+    if (isPoint) {
+      const point = { graph: series.graph, label: series.label, x: readU64(view, 4), y: view.getFloat32(12, true), synced };
+      if (wsDebugEnabled) logWsLine(JSON.stringify({ topic: 'graph_point', data: point }), 'in');
+      handleGraphPoint(point);
+      return;
+    }
+
+    const count = Math.min(view.getUint16(4, true), Math.floor((view.byteLength - GRAPH_BATCH_HEADER) / GRAPH_BATCH_POINT));
+    const points = [];
+    for (let i = 0, off = GRAPH_BATCH_HEADER; i < count; i++, off += GRAPH_BATCH_POINT) {
+      points.push({ x: readU64(view, off), y: view.getFloat32(off + 8, true) });
+    }
+    handleGraphPoints({ graph: series.graph, label: series.label, synced, points });
+  }
+
+  function handleGraphPoints(data) {
+    if (!data || !Array.isArray(data.points)) return;
+    if (wsDebugEnabled) logWsLine(JSON.stringify({ topic: 'graph_points', data }), 'in');
+    for (const p of data.points) {
+      handleGraphPoint({ graph: data.graph, label: data.label, x: p.x, y: p.y, synced: data.synced }, true);
+    }
+    const graphInfo = graphCharts[data.graph];
+    if (graphInfo && graphInfo.chart) graphInfo.chart.update();
+  }
+
   function handleWsMessageText(text) {
     logWsLine(text, 'in');
 
     try {
       const msg = JSON.parse(text);
 
+      if (msg.topic === 'log' && msg.data) {
+        handleDeviceLog(msg.data);
+        return;
+      }
+
+      // Shared socket: frames of the other models carry a different "ns".
+      if (msg.topic && (msg.ns || '') !== wsNamespace) return;
+
       if (msg.topic === 'graph_point' && msg.data) {
         if (wsDebugEnabled) {
           try {
@@ -605,8 +723,24 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
         return;
       }
 
+      if (msg.topic === 'graph_points' && msg.data) {
+        handleGraphPoints(msg.data);
+        return;
+      }
+
+      if (msg.topic === 'graph_series' && msg.data) {
+        graphSeries[msg.data.id] = { graph: msg.data.graph, label: msg.data.label };
+        return;
+      }
+
       if (!msg.topic) return;
-      topicState[msg.topic] = msg.data || {};
+      if (typeof msg.tid === 'number') topicIds[msg.topic] = msg.tid;
+      if (msg.patch && typeof msg.patch === 'object') {
+        // Delta envelope: only the fields that changed since the last broadcast.
+        topicState[msg.topic] = Object.assign({}, topicState[msg.topic] || {}, msg.patch);
+      } else {
+        topicState[msg.topic] = msg.data || {};
+      }
       scheduleRender();
     } catch (e) {
       console.error('WS parse error', e);
@@ -615,9 +749,13 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
 
   function connectWs(wsPath) {
     const protocol = window.location.protocol === 'https:' ? 'wss:' : 'ws:';
-    const url = `${protocol}//${window.location.host}${wsPath}`;
+    // On a shared WsHub socket only this page's model is subscribed ('' = default model);
+    // a model on its own socket ignores the parameter.
+    const sep = wsPath.includes('?') ? '&' : '?';
+    const url = `${protocol}//${window.location.host}${wsPath}${sep}ns=${encodeURIComponent(wsNamespace)}`;
 
     ws = new WebSocket(url);
+    ws.binaryType = 'arraybuffer';
 
     ws.onopen = () => {
       const badge = byId('wsBadge');
@@ -625,6 +763,8 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
         badge.textContent = 'WS: verbunden';
         badge.className = 'chip connected';
       }
+      deviceLogBacklog = true;
+      subscribeDeviceLog();
     };
 
     ws.onclose = () => {
@@ -659,14 +799,14 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
         return;
       }
 
-      // Some browsers deliver WS messages as Blob/ArrayBuffer.
+      // Binary frames (graph points); some browsers deliver them as Blob despite binaryType.
       try {
-        if (data instanceof Blob && typeof data.text === 'function') {
-          data.text().then(handleWsMessageText).catch((e) => console.error('WS blob decode error', e));
+        if (data instanceof ArrayBuffer) {
+          handleWsMessageBinary(data);
           return;
         }
-        if (data instanceof ArrayBuffer && typeof TextDecoder !== 'undefined') {
-          handleWsMessageText(new TextDecoder().decode(data));
+        if (data instanceof Blob && typeof data.arrayBuffer === 'function') {
+          data.arrayBuffer().then(handleWsMessageBinary).catch((e) => console.error('WS blob decode error', e));
           return;
         }
       } catch (e) {
@@ -962,7 +1102,8 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
     }
   }
 
-  function handleGraphPoint(data) {
+  // deferUpdate: caller redraws the chart once after a batch of points.
+  function handleGraphPoint(data, deferUpdate) {
     if (!data || !data.graph || !data.label) return;
     const graphName = data.graph;
     const label = data.label;
@@ -1019,6 +1160,7 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
     }
 
     graphInfo.chart.data.datasets = Object.values(graphInfo.datasets);
+    if (deferUpdate) return;
     graphInfo.chart.update();
     if (wsDebugEnabled) {
       console.log(`[handleGraphPoint] chart updated, ${graphName}.${label} now has ${graphInfo.datasets[label].data.length} points`);
@@ -1027,6 +1169,7 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
 
   function init(config) {
     const wsPath = (config && config.wsPath) || '/ws';
+    wsNamespace = (config && config.ns) || '';
     let debugFromConfig = (config && config.debug) || window.__ESPWEBUTILS_DEBUG_WS__;
     
     // Fallback: read debug from URL if not in config
@@ -1039,7 +1182,7 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
     
     wsDebugEnabled = !!debugFromConfig;
     graphMode = (config && config.graphMode) || (config && config.graphsMode) || graphMode;
-    console.log('[ModelGeneric] init called', { wsPath, graphMode, debug: wsDebugEnabled, debugFromConfig, config });
+    console.log('[ModelGeneric] init called', { wsPath, ns: wsNamespace, graphMode, debug: wsDebugEnabled, debugFromConfig, config });
     
     // Show debug button if debug mode is enabled
     if (wsDebugEnabled) {
@@ -1047,6 +1190,7 @@ if (typeof window.copyConsoleLogsToClipboard === 'undefined') {
       if (debugBtn) debugBtn.style.display = 'inline-block';
       logWsLine(`debug_enabled wsPath=${wsPath}`, 'in');
     }
+    setupDeviceLog();
     connectWs(wsPath);
   }
 
@@ -8,6 +8,7 @@
       const cfg = {};
 
       if (qs.has('ws')) cfg.wsPath = qs.get('ws') || undefined;
+      if (qs.has('ns')) cfg.ns = qs.get('ns') || undefined;
       if (qs.has('title')) cfg.title = qs.get('title') || undefined;
       if (qs.has('alias')) cfg.alias = qs.get('alias') || undefined;
       if (qs.has('graphMode') || qs.has('graph')) cfg.graphMode = (qs.get('graphMode') || qs.get('graph')) || undefined;
@@ -64,6 +65,7 @@
     if (window.ModelGeneric) {
       window.ModelGeneric.init({
         wsPath: cfg.wsPath || '/ws',
+        ns: cfg.ns,
         debug: !!cfg.debug,
         graphMode: cfg.graphMode
       });